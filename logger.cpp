@@ -2,29 +2,73 @@
 
 #include <QTime>
 #include <QFileInfo>
-#include <QSettings>
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-#include <QTextCodec>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 //! Namespace for Graphical Workstation of the 6G_DIRA_3D project
 namespace DIRA_3D_GW {
 
+namespace {
+
+    /**
+     * @brief Генератор псевдослучайных чисел потока (xorshift64*) для выборочной
+     * записи сообщений. Не требует синхронизации между потоками.
+     */
+    std::uint64_t thread_random() {
+        thread_local std::uint64_t state = 0;
+        if (state == 0) {
+            state = reinterpret_cast<std::uintptr_t>(&state) ^ 0x9E3779B97F4A7C15ULL
+                    ^ static_cast<std::uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+            if (state == 0) {
+                state = 1;
+            }
+        }
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+}
+
     Logger::Logger(): m_rootFolder("")
                     , m_fileName("")
                     , m_level(LoggerLevel::Warning)
                     , m_maxFilesSizeInBytes(-1)
                     , m_maxFilesCount(-1)
-    {}
+    {
+        for (int i = 0; i < LoggerLevelsCount; ++i) {
+            m_sample_rate[i] = 1;
+            m_sample_written[i].store(0, std::memory_order_relaxed);
+            m_sample_skipped[i].store(0, std::memory_order_relaxed);
+        }
+    }
 
     Logger::~Logger() {
-        m_awake_to_exit = true;
+        // Перечитывание конфигурации прекращается до остановки потока записи
+        m_config_watcher.stop();
         m_is_writing = false;
-        m_cv.notify_one();
+        m_awake_to_exit = true;
+        m_signal.notify();
 
         if (m_writerThread.joinable()) {
             m_writerThread.join();
         }
+
+        m_arena.release(m_queue_head);
+        m_arena.release(m_recycled);
+        if (m_last_record) {
+            m_last_record->next = nullptr;
+            m_arena.release(m_last_record);
+        }
     }
 
     bool Logger::init(const QString &dir,
@@ -33,7 +77,7 @@ namespace DIRA_3D_GW {
                       std::int64_t maxFileSize,
                       std::int32_t maxFilesCount) {
 
-        if (dir.isEmpty()) {
+        if (dir.isEmpty() && m_shm_name.isEmpty() && !m_syslog.isEnabled()) {
             return false;
         }
 
@@ -43,218 +87,1091 @@ namespace DIRA_3D_GW {
         m_maxFilesSizeInBytes = maxFileSize;
         m_maxFilesCount = maxFilesCount;
 
-        m_is_writing = !this->m_fileName.isEmpty();
-        if (m_is_writing) {
-            m_writerThread = std::thread(&Logger::write_action, this);
+        return start_writer();
+    }
+
+    bool Logger::start_writer() {
+        if (this->m_fileName.isEmpty() && m_shm_name.isEmpty() && !m_syslog.isEnabled()) {
+            m_is_writing = false;
+            m_open_promise.set_value(false);
+            return true;
         }
-        return true;
+        // Пул выделяется до публикации m_is_writing: потоки-источники, увидевшие
+        // флаг, обращаются к уже инициализированному пулу
+        m_arena.init(m_arena_size);
+        m_is_writing = true;
+        m_writerThread = std::thread(&Logger::write_action, this);
+        return m_open_mode == LoggerOpenMode::OpenSync ? m_open_future.get() : true;
     }
 
     void Logger::write_action() {
+        // Параметры применяются до выделения буферов потока записи, чтобы при
+        // привязке к узлу NUMA они размещались в его локальной памяти
+        applyThreadOptions(m_thread_options);
+
+        // Строки передаются сборщику через разделяемую память; если буфер недоступен,
+        // используется файл журнала (если он задан)
+        if (!m_shm_name.isEmpty() && !m_shm.open(m_shm_name, m_shm_capacity, true)) {
+            qWarning("Cannot open the shared memory log ring %s", qPrintable(m_shm_name));
+        }
+        bool opened = m_shm.isOpen() || m_fileName.isEmpty();
+        if (!m_shm.isOpen() && !m_fileName.isEmpty()) {
+            if (m_async_io && !m_uring.init()) {
+                qWarning("io_uring is not available, synchronous file writes will be used");
+            }
+            m_file_wanted = true;
+            opened = open_active_file();
+            if (!opened) {
+                qWarning("Cannot create the file %s, log lines are kept in memory until it is available",
+                         qPrintable(m_cur_file.fileName()));
+                m_open_retry_at = std::chrono::steady_clock::now() + m_open_retry_delay;
+            }
+        }
+        m_open_promise.set_value(opened);
+        if (!m_tail_socket.isEmpty()) {
+            m_tail_server.start(m_tail_socket, &m_tail, m_thread_options);
+        }
+        if (m_syslog.isEnabled() && !m_syslog.open()) {
+            qWarning("Cannot connect to the syslog socket, messages will be dropped until it is available");
+        }
+
+        m_clock.calibrate();
+
+        // Буфер переиспользуется между пачками сообщений, поэтому форматирование
+        // строк не требует выделения памяти в установившемся режиме
+        static const int bufferLimit = 64 * 1024;
+        m_out_buf.reserve(2 * bufferLimit);
+
+        // Максимальное время сна потока записи. Ограничивает задержку записи
+        // сообщений даже в случае потери уведомления.
+        static const std::chrono::milliseconds maxPark(100);
+
+        // Интервал вывода строки о повторах при непрерывной серии одинаковых сообщений
+        static const std::chrono::seconds repeatsInterval(1);
+
+        for (;;) {
+            // Значение счётчика запоминается до проверки очереди: любое сообщение,
+            // добавленное после проверки, изменит счётчик и прервёт ожидание
+            const std::uint32_t seen = m_signal.value();
+
+            // Перечитанные настройки применяются между пачками: предыдущая пачка
+            // полностью записана, следующая ещё не извлечена из очереди
+            if (m_reload_pending.load(std::memory_order_acquire)) {
+                apply_reload();
+            }
+            retry_open_file();
+            LoggerRecord *cur = dequeueItems();
+            if (!cur) {
+                // Завершение работы только после записи всех сообщений очереди
+                if (m_awake_to_exit.load(std::memory_order_acquire)) {
+                    break;
+                }
+                if (m_repeat_count != 0 && std::chrono::steady_clock::now() - m_repeat_since >= repeatsInterval) {
+                    flush_repeats();
+                }
+                // Несинхронизированные данные сохраняются по истечении интервала
+                // и при отсутствии новых сообщений
+                sync_file(false);
+                const std::chrono::microseconds park = m_unsynced && m_sync_interval < maxPark
+                        ? std::chrono::microseconds(m_sync_interval)
+                        : std::chrono::microseconds(maxPark);
+
+                // После сна поток записи выжидает окно накопления сообщений, чтобы
+                // просыпаться один раз на пачку строк, а не на каждую строку
+                if (m_signal.wait(seen, park) && m_batch_window.count() > 0) {
+                    std::this_thread::sleep_for(m_batch_window);
+                }
+                continue;
+            }
+
+            m_clock.calibrate();
+            while (cur)
+            {
+                LoggerRecord *next = cur->next;
+                if (isFileMaxSize()) {
+                    write_buffer();
+                    sync_file(true);
+                    m_uring.drain();
+                    trim_file();
+                    backupActiveFile();
+                    attach_active_file();
+                }
+                write_record(cur);
+                if (m_out_buf.size() >= bufferLimit) {
+                    write_buffer();
+                }
+                cur = next;
+            }
+            // Строка о повторах выводится при появлении другого сообщения и не чаще
+            // раза в repeatsInterval: пачка в серии повторов может состоять из одного
+            // сообщения
+            if (m_repeat_count != 0 && std::chrono::steady_clock::now() - m_repeat_since >= repeatsInterval) {
+                write_repeats();
+            }
+            write_buffer();
+            m_tail.publish();
+            m_shm.wake();
+            m_syslog.flush();
+            sync_file(m_durability == LoggerDurability::FullSync
+                      || (m_durability == LoggerDurability::CriticalSync && m_batch_critical));
+            m_batch_critical = false;
+            m_formatted_written.fetch_add(m_batch_formatted, std::memory_order_release);
+            m_batch_formatted = 0;
+
+            // Обработанные записи возвращаются в пул одной операцией на пачку
+            m_arena.release(m_recycled);
+            m_recycled = nullptr;
+        }
+
+        flush_repeats();
+        // Файл закрывается только после завершения всех асинхронных операций
+        sync_file(true);
+        m_uring.drain();
+        trim_file();
+        m_syncer.stop();
+        m_index.close();
+        m_tail_server.stop();
+        m_shm.close();
+        m_syslog.close();
+        m_archiver.stop();
+    }
+
+    void Logger::write_buffer() {
+        if (m_out_buf.isEmpty()) {
+            return;
+        }
+        if (!m_cur_file.isOpen()) {
+            // Строки недоступного файла накапливаются до его открытия; без файла журнала
+            // (сообщения передаются только в syslog) строки не сохраняются
+            if (m_file_wanted) {
+                const qint64 room = m_fallback_limit - m_fallback_buf.size();
+                if (m_out_buf.size() <= room) {
+                    m_fallback_buf.append(m_out_buf);
+                } else {
+                    m_fallback_dropped += m_out_buf.size();
+                }
+            }
+            m_out_buf.resize(0);
+            m_index.flush();
+            return;
+        }
+        const QByteArray *data = &m_out_buf;
+        if (m_batch_checksum && !m_compressor.isActive()) {
+            // Кадры сжатого файла содержат собственные контрольные суммы
+            LoggerFraming::appendTrailer(m_out_buf, 0);
+        }
+        if (m_compressor.isActive()) {
+            // Буфер записывается одним кадром: файл остаётся читаемым до последнего
+            // полностью записанного кадра
+            m_compressed_buf.resize(0);
+            if (!m_compressor.compress(m_out_buf.constData(), m_out_buf.size(), m_compressed_buf)) {
+                qWarning("Cannot compress the log lines of the file %s", qPrintable(m_cur_file.fileName()));
+                m_out_buf.resize(0);
+                return;
+            }
+            data = &m_compressed_buf;
+        }
+        // Пачки, требующие сохранности, отправляются в io_uring вместе со связанным
+        // fdatasync: он выполняется ядром сразу после записи, без отдельного вызова
+        const bool syncLinked = m_uring.isActive()
+                && (m_durability == LoggerDurability::FullSync
+                    || (m_durability == LoggerDurability::CriticalSync && m_batch_critical));
+        bool written;
+        if (!m_uring.isActive()) {
+            written = m_cur_file.write(data->constData(), data->size()) == data->size()
+                    && m_cur_file.flush();
+        } else {
+            written = m_uring.write(data->constData(), static_cast<std::size_t>(data->size()), syncLinked);
+        }
+        m_out_buf.resize(0);
+        if (!written) {
+            // Часть данных могла не попасть в файл: следующая запись продолжается с
+            // фактического конца файла, а записи индекса для потерянных строк
+            // отбрасываются. Размер берётся из файловой системы: QFile::size() после
+            // неудачной записи повторяет сброс буфера и при ошибке возвращает 0
+            qWarning("Cannot write the file %s", qPrintable(m_cur_file.fileName()));
+            m_uring.drain();
+            m_file_offset = QFileInfo(m_cur_file.fileName()).size();
+            m_uring.attach(m_cur_file.handle(), m_file_offset);
+            m_index.discard(m_file_offset);
+            m_unsynced = true;
+            return;
+        }
+        m_file_offset += data->size();
+        m_unsynced = m_durability != LoggerDurability::Flush && !syncLinked;
+        // Индекс записывается после строк, на которые он ссылается
+        m_index.flush();
+        preallocate_file();
+    }
+
+    void Logger::format_record(const LoggerRecord &rec) {
+        const int offset = m_out_buf.size();
+        // Сжатый файл читается с начала кадра, в который попадёт строка
+        m_index.add(rec.time, m_file_offset + (m_compressor.isActive() ? 0 : offset));
+        m_formatter.format(rec, m_out_buf);
+        if (m_syslog.isEnabled()) {
+            m_syslog.add(rec, m_formatter);
+        }
+        if (m_tail.isEnabled()) {
+            m_tail.append(m_out_buf.constData() + offset, m_out_buf.size() - offset, rec.level);
+        }
+        if (m_shm.isOpen()) {
+            // Каждая строка передаётся отдельным кадром со временем и уровнем для
+            // индекса и фильтров сборщика
+            m_shm.push(rec.time, rec.level, m_out_buf.constData() + offset, m_out_buf.size() - offset);
+            m_out_buf.resize(offset);
+        }
+    }
+
+    qint64 Logger::active_file_size() const {
+        return m_file_offset;
+    }
+
+    QString Logger::active_file_name() const {
+        return m_fileName + QString::fromLatin1(m_compressor.suffix());
+    }
+
+    bool Logger::open_active_file() {
         m_cur_dir = QDir(m_rootFolder);
         if (!m_cur_dir.exists()) {
             qWarning("Cannot find the %s. Directory will be created", qPrintable(m_rootFolder));
             m_cur_dir.mkpath(".");
         }
 
-        m_cur_file.setFileName(m_cur_dir.filePath(m_fileName));
-        if (!m_cur_file.open(QIODevice::ReadWrite | QIODevice::Append)) {
-            qWarning("Cannot create the file %s", qPrintable(m_cur_file.fileName()));
+        // Асинхронная запись выполняется по явным смещениям, поэтому файл
+        // открывается без O_APPEND: иначе порядок одновременных записей не гарантирован
+        m_cur_file.setFileName(m_cur_dir.filePath(active_file_name()));
+        const qint64 recovered = m_batch_checksum ? recover_active_file() : 0;
+        const QIODevice::OpenMode mode = m_uring.isActive()
+                ? QIODevice::ReadWrite
+                : QIODevice::ReadWrite | QIODevice::Append;
+        if (!m_cur_file.open(mode)) {
+            return false;
+        }
+        // Синхронизация через io_uring выполняется ядром асинхронно, в остальных
+        // случаях - отдельным потоком
+        if (m_durability != LoggerDurability::Flush && !m_uring.isActive()) {
+            m_syncer.start(m_durability == LoggerDurability::FullSync
+                           ? std::chrono::milliseconds(0) : m_sync_interval,
+                           m_thread_options);
+        }
+        attach_active_file();
+        if (recovered > 0) {
+            system(QString("Log file recovered after an unclean shutdown: %1 bytes of incomplete data removed")
+                   .arg(recovered));
         }
 
-        while (m_is_writing) {
-            std::unique_lock<std::mutex> lock(m_mutex);
-            if (!m_ready) {
-                m_cv.wait(lock);
-                if (m_awake_to_exit) {
-                    return;
-                }
+        if (m_archiver.isEnabled() && !m_compressor.isActive()) {
+            // Сжатие не должно отнимать процессор у приложения и потока записи
+            LoggerThreadOptions archiveOptions = m_thread_options;
+            archiveOptions.policy = LoggerSchedPolicy::SchedIdle;
+            m_archiver.start(archiveOptions);
+            if (m_archived_file != m_cur_file.fileName()) {
+                m_archived_file = m_cur_file.fileName();
+                archive_rotated_files();
             }
+        }
+        return true;
+    }
 
-            QString cur;
-            while (dequeueItem(cur))
-            {
-                if (isFileMaxSize()) {
-                    backupActiveFile();
+    void Logger::retry_open_file() {
+        if (!m_file_wanted || m_cur_file.isOpen()) {
+            return;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now < m_open_retry_at) {
+            return;
+        }
+        if (!open_active_file()) {
+            m_open_retry_delay = std::min(m_open_retry_delay * 2, std::chrono::milliseconds(30000));
+            m_open_retry_at = now + m_open_retry_delay;
+            return;
+        }
+        replay_fallback();
+    }
+
+    void Logger::replay_fallback() {
+        // Накопленные строки записываются раньше строк текущей пачки
+        const qint64 buffered = m_fallback_buf.size();
+        m_out_buf.swap(m_fallback_buf);
+        write_buffer();
+        m_fallback_buf = QByteArray();
+        system(QString("Log file is available: %1 bytes of buffered log lines written, %2 bytes dropped")
+               .arg(buffered).arg(m_fallback_dropped));
+        m_fallback_dropped = 0;
+    }
+
+    qint64 Logger::recover_active_file() {
+        QFile file(m_cur_file.fileName());
+        if (!file.exists() || !file.open(QIODevice::ReadWrite)) {
+            return 0;
+        }
+        const qint64 size = file.size();
+        qint64 end = size;
+        if (m_compressor.isActive()) {
+            // Файл просматривается по заголовкам кадров до первого неполного
+            const char *data = size > 0 ? (const char *) file.map(0, size) : nullptr;
+            qint64 pos = 0;
+            while (data && pos < size) {
+                const qint64 frame = LoggerCompressor::frameSize(data + pos, size - pos);
+                if (frame == 0) {
+                    break;
                 }
-                m_cur_file.write(cur.toStdString().c_str());
-                m_cur_file.flush();
+                pos += frame;
             }
+            end = data ? pos : size;
+        } else {
+            // Пачка строк не больше буфера записи, поэтому последняя целая пачка
+            // находится в конце файла
+            static const qint64 window = 16 * 1024 * 1024;
+            const qint64 start = std::max<qint64>(0, size - window);
+            const char *data = size > 0 ? (const char *) file.map(start, size - start) : nullptr;
+            if (data) {
+                const qint64 valid = LoggerFraming::validEnd(data, size - start, start);
+                // Файл без трейлеров записан без контрольных сумм и не изменяется
+                end = valid >= 0 ? start + valid : size;
+            }
+        }
+        if (end >= size) {
+            return 0;
+        }
+        if (!file.resize(end)) {
+            qWarning("Cannot truncate the file %s", qPrintable(file.fileName()));
+            return 0;
+        }
+        return size - end;
+    }
 
-            m_ready = false;
+    void Logger::archive_rotated_files() {
+        const QString baseName = QFileInfo(m_cur_file).baseName();
+        const QStringList parts = m_cur_dir.entryList(
+                    QStringList() << QString("%1_*.log*").arg(baseName) + LoggerArchiver::PartSuffix,
+                    QDir::Files | QDir::NoDotAndDotDot);
+        for (const QString &part : parts) {
+            m_cur_dir.remove(part);
+        }
+        const QFileInfoList files = m_cur_dir.entryInfoList(QStringList() << QString("%1_*.log").arg(baseName),
+                                                            QDir::Files | QDir::NoDotAndDotDot,
+                                                            QDir::Time | QDir::Reversed);
+        for (const QFileInfo &info : files) {
+            m_archiver.enqueue(info.absoluteFilePath());
         }
     }
 
-    void Logger::addQueueItem(const QString& item) {
-        // Блокировка асинхронного доступа к очереди вынесена на уровень
-        // выше, так как получение текущего времени потоко не безопасно
-        this->m_queue.push_back(item);
-        m_ready = true;
-        m_cv.notify_one();
+    void Logger::preallocate_file() {
+#if defined(Q_OS_LINUX)
+        if (m_prealloc_extent <= 0 || m_maxFilesSizeInBytes == -1 || !m_cur_file.isOpen()) {
+            return;
+        }
+        // Следующий экстент выделяется, когда записана половина предыдущего,
+        // поэтому запись не упирается в выделение блоков файловой системой
+        const qint64 size = active_file_size();
+        if (size + m_prealloc_extent / 2 < m_prealloc_end) {
+            return;
+        }
+        const qint64 start = m_prealloc_end > size ? m_prealloc_end : size;
+        const qint64 end = std::min<qint64>(start + m_prealloc_extent, m_maxFilesSizeInBytes);
+        if (end <= start) {
+            return;
+        }
+        // FALLOC_FL_KEEP_SIZE не меняет размер файла: читающие файл программы не
+        // видят выделенный хвост
+        if (fallocate(m_cur_file.handle(), FALLOC_FL_KEEP_SIZE, start, end - start) != 0) {
+            // Файловая система не поддерживает выделение - больше не пытаемся
+            m_prealloc_extent = 0;
+            return;
+        }
+        m_prealloc_end = end;
+#endif
     }
 
-    bool Logger::dequeueItem(QString& dst) {
-        if (!m_queue.isEmpty()) {
-            std::lock_guard<std::mutex> lock(m_queue_mutex);
-            dst = m_queue.takeFirst();
-            return true;
+    void Logger::trim_file() {
+#if defined(Q_OS_LINUX)
+        const qint64 size = active_file_size();
+        if (m_prealloc_end > size && m_cur_file.isOpen()) {
+            // Усечение до текущего размера освобождает выделенные, но не записанные
+            // блоки за концом файла
+            if (ftruncate(m_cur_file.handle(), size) != 0) {
+                qWarning("Cannot trim the file %s", qPrintable(m_cur_file.fileName()));
+            }
+        }
+#endif
+        m_prealloc_end = 0;
+    }
+
+    void Logger::sync_file(bool urgent) {
+        if (m_durability == LoggerDurability::Flush || !m_unsynced) {
+            return;
+        }
+        if (!m_uring.isActive()) {
+            m_syncer.written(urgent || m_sync_interval.count() == 0);
+            m_unsynced = false;
+            return;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (urgent || m_durability == LoggerDurability::FullSync || now - m_last_sync >= m_sync_interval) {
+            if (!m_uring.sync()) {
+                qWarning("Cannot sync the file %s", qPrintable(m_cur_file.fileName()));
+            }
+            m_last_sync = now;
+            m_unsynced = false;
+        }
+    }
+
+    void Logger::attach_active_file() {
+        const int fd = m_cur_file.isOpen() ? m_cur_file.handle() : -1;
+        m_file_offset = m_cur_file.isOpen() ? m_cur_file.size() : 0;
+        // Индекс закрытого файла не открывается: с нулевым размером журнала он
+        // был бы создан заново и потерял записи
+        if (m_index.isEnabled() && m_cur_file.isOpen()) {
+            m_index.open(m_cur_file.fileName(), m_file_offset);
+        } else {
+            m_index.close();
+        }
+        if (m_uring.isActive()) {
+            m_uring.attach(fd, m_file_offset);
+        } else if (m_durability != LoggerDurability::Flush) {
+            m_syncer.attach(fd);
         }
-        return false;
     }
 
-    QString Logger::format_msg(const QString &strLevel,
-                               const QString &message,
-                               const QString &sourceFile,
-                               std::int32_t sourceLine) {
-        if (!sourceFile.isEmpty()) {
-            if (sourceLine != -1)
-                return QString("%1 [%2]: %3 [%4 (%5)]\n")
-                        .arg(QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss"))
-                        .arg(strLevel).arg(message).arg(sourceFile).arg(sourceLine);
+    void Logger::write_record(LoggerRecord *rec) {
+        if (!rec->preformatted) {
+            rec->time = m_clock.toWall(rec->time);
+        } else {
+            ++m_batch_formatted;
+        }
+        if (rec->level <= LoggerLevel::Critical) {
+            m_batch_critical = true;
+        }
+        if (m_suppress_duplicates) {
+            if (m_last_record && rec->sameMessage(*m_last_record)) {
+                if (m_repeat_count++ == 0) {
+                    m_repeat_since = std::chrono::steady_clock::now();
+                }
+                m_last_record->time = rec->time;
+                recycle(rec);
+                return;
+            }
+            write_repeats();
+            format_record(*rec);
+            // Последнее сообщение хранится до появления отличающегося от него
+            if (m_last_record) {
+                recycle(m_last_record);
+            }
+            m_last_record = rec;
+            return;
+        }
+        format_record(*rec);
+        recycle(rec);
+    }
 
-            return QString("%1 [%2]: %3 [%4]\n")
-                        .arg(QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss"))
-                        .arg(strLevel).arg(message).arg(sourceFile);
+    void Logger::write_repeats() {
+        if (m_repeat_count == 0) {
+            return;
         }
+        // Последнее сообщение остаётся образцом для сравнения, поэтому длинная
+        // серия повторов выводится одной строкой на каждый repeatsInterval
+        const QString message = QString("Last message repeated %1 times").arg(m_repeat_count);
+        LoggerRecord *rep = m_arena.allocate(LoggerRecord::payloadBound(message, QString(), {}));
+        rep->level = m_last_record->level;
+        rep->time = m_last_record->time;
+        rep->assign(message, QString());
+        m_repeat_count = 0;
+        format_record(*rep);
+        recycle(rep);
+    }
 
-        if (sourceLine != -1)
-            return QString("%1 [%2]: %3 (%4)\n")
-                        .arg(QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss"))
-                        .arg(strLevel).arg(message).arg(sourceLine);
+    void Logger::flush_repeats() {
+        if (m_repeat_count == 0) {
+            return;
+        }
+        write_repeats();
+        write_buffer();
+        m_tail.publish();
+        m_shm.wake();
+        m_syslog.flush();
+    }
 
-        return QString("%1 [%2]: %3\n")
-                        .arg(QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss"))
-                        .arg(strLevel).arg(message);
+    void Logger::recycle(LoggerRecord *rec) {
+        rec->next = m_recycled;
+        m_recycled = rec;
     }
 
-    LoggerLevel Logger::LoggerLevel_form_str(const QString& level) {
-        std::map<QString, LoggerLevel> logMap = {{"SYSTEM", System}, {"CRITICAL", Critical},
-                                                 {"ERROR", Error}, {"WARNING", Warning},
-                                                 {"INFO", Info}, {"DEBUG", Debug},
-                                                 {"DEVELOPER", Developer}};
-        QString upperLevel = level.toUpper();
-        if (logMap.find(upperLevel) != logMap.end()) {
-            return logMap[upperLevel];
+    bool Logger::addQueueItem(LoggerRecord *item) {
+        // Блокировка асинхронного доступа к очереди вынесена на уровень
+        // выше, так как получение текущего времени потоко не безопасно
+        item->next = nullptr;
+        if (m_queue_tail) {
+            m_queue_tail->next = item;
+            m_queue_tail = item;
+            return false;
         }
-        return Warning;
+        m_queue_head = item;
+        m_queue_tail = item;
+        return true;
     }
 
-    int64_t Logger::MaxLogFileSize_to_int(const QString& size){
-        if (size.isEmpty()) {
-            return -1;
-        }
-
-        std::map<QString, int64_t> m_size = {{"Kb", 1024ULL},
-                                             {"Mb", 1024ULL*1024ULL},
-                                             {"Gb", 1024ULL*1024ULL*1024ULL},
-                                             {"Tb", 1024ULL*1024ULL*1024ULL*1024ULL},
-                                             {"kb", 1024ULL},
-                                             {"mb", 1024ULL*1024ULL},
-                                             {"gb", 1024ULL*1024ULL*1024ULL},
-                                             {"tb", 1024ULL*1024ULL*1024ULL*1024ULL},
-                                             {"KB", 1024ULL},
-                                             {"MB", 1024ULL*1024ULL},
-                                             {"GB", 1024ULL*1024ULL*1024ULL},
-                                             {"TB", 1024ULL*1024ULL*1024ULL*1024ULL}};
-
-        for (const auto& s : m_size) {
-            const auto& pos = size.indexOf(s.first);
-            if (pos != -1) {
-                const int64_t num = size.left(pos).toInt() * s.second;
-                return num;
+    LoggerRecord *Logger::dequeueItems() {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        LoggerRecord *head = m_queue_head;
+        m_queue_head = nullptr;
+        m_queue_tail = nullptr;
+        return head;
+    }
+
+    void Logger::format_msg(LoggerLevel level,
+                            const QString &message,
+                            const QString &sourceFile,
+                            std::int32_t sourceLine,
+                            std::initializer_list<LoggerField> fields,
+                            const LoggerSourceLocation *location) {
+        const std::uint32_t rate = m_sample_rate[level - LoggerLevel::System];
+        if (rate > 1) {
+            // Сообщение записывается с вероятностью 1/rate
+            const std::uint64_t r = thread_random() >> 32;
+            if (((r * rate) >> 32) != 0) {
+                m_sample_skipped[level - LoggerLevel::System].fetch_add(1, std::memory_order_relaxed);
+                return;
             }
+            m_sample_written[level - LoggerLevel::System].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::uint64_t suppressed = 0;
+        if (level != LoggerLevel::System
+                && !(location ? m_rate_limiter.allow(location->id(), suppressed)
+                              : m_rate_limiter.allow(sourceFile, sourceLine, suppressed))) {
+            return;
         }
 
-        for (const auto& c : size) {
-            if (c.isLetter()) {
-                return -1;
+        // Ссылка на пустую строку вместо временной копии sourceFile
+        static const QString noFile;
+        const QString &file = location ? noFile : sourceFile;
+        LoggerRecord *rec = m_arena.allocate(LoggerRecord::payloadBound(message, file, fields, 2));
+        rec->level = level;
+        rec->assign(message, file);
+        if (location) {
+            rec->sourceId = location->id();
+            rec->sourceLine = location->line();
+        } else {
+            rec->sourceLine = sourceLine;
+        }
+        if (m_thread_fields) {
+            const LoggerThreadInfo &thread = currentThreadInfo();
+            rec->threadId = thread.id;
+            rec->threadName = thread.name;
+        }
+        rec->appendFields(fields);
+        if (suppressed != 0) {
+            rec->appendField(LoggerField("suppressed", static_cast<std::int64_t>(suppressed)));
+        }
+        if (rate > 1) {
+            rec->appendField(LoggerField("sample_rate", static_cast<std::int64_t>(rate)));
+        }
+
+        // Показания монотонных источников времени снимаются вне мьютекса очереди и
+        // переводятся в системное время потоком записи. Системное время читается под
+        // мьютексом, чтобы время сообщений в очереди не убывало.
+        const bool monotonic = m_clock.source() != LoggerClockSource::ClockRealtime;
+        if (monotonic) {
+            rec->time = m_clock.now();
+        }
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            if (!monotonic) {
+                rec->time = LoggerClock::wallNow();
             }
+            wasEmpty = this->addQueueItem(rec);
         }
+        // Уведомление нужно только при переходе очереди из пустого состояния в
+        // непустое: если очередь не пуста, поток записи ещё не забрал её и увидит
+        // это сообщение. Уведомление выполняется после освобождения мьютекса
+        // очереди, чтобы проснувшийся поток записи не блокировался на нём.
+        if (wasEmpty) {
+            m_signal.notify();
+        }
+    }
 
-        return size.toInt();
+    LoggerLevel Logger::LoggerLevel_form_str(const QString& level) {
+        LoggerLevel value = Warning;
+        LoggerConfig::parseLevel(level, value);
+        return value;
+    }
+
+    LoggerFormat Logger::LoggerFormat_from_str(const QString& format) {
+        LoggerFormat value = LoggerFormat::Text;
+        LoggerConfig::parseFormat(format, value);
+        return value;
+    }
+
+    LoggerDurability Logger::LoggerDurability_from_str(const QString& mode) {
+        LoggerDurability value = LoggerDurability::Flush;
+        LoggerConfig::parseDurability(mode, value);
+        return value;
+    }
+
+    LoggerCompression Logger::LoggerCompression_from_str(const QString& method) {
+        LoggerCompression value = LoggerCompression::CompressionNone;
+        LoggerConfig::parseCompression(method, value);
+        return value;
+    }
+
+    int64_t Logger::MaxLogFileSize_to_int(const QString& size){
+        std::int64_t bytes = -1;
+        LoggerConfig::parseSize(size, bytes);
+        return bytes;
     }
 
     bool Logger::initFromConfig(const QString &file, const QString &section) {
-        if (!QFile::exists(file)) {
+        LoggerConfig config;
+        const bool loaded = config.load(file, section);
+        {
+            std::lock_guard<std::mutex> lock(m_reload_mutex);
+            m_config_errors = config.errors();
+        }
+        for (const QString &error : config.errors()) {
+            qWarning("Logger configuration %s: %s", qPrintable(file), qPrintable(error));
+        }
+        if (!loaded) {
             return false;
         }
+        m_config_file = file;
+        m_config_section = section;
+        apply_settings(config.settings());
+        const bool started = start_writer();
+        if (m_config_watch && m_writerThread.joinable()) {
+            LoggerThreadOptions watchOptions = m_thread_options;
+            watchOptions.policy = LoggerSchedPolicy::SchedIdle;
+            m_config_watcher.start(file, [this]() { reloadConfig(); }, watchOptions);
+        }
+        return started;
+    }
 
-        QSettings sett(file, QSettings::IniFormat);
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-        QTextCodec *codec = QTextCodec::codecForName("UTF-8");
-        sett.setIniCodec(codec);
-#endif
-        sett.beginGroup(section);
-        this->m_rootFolder = sett.value("LogFolder", "").toString();
-        this->m_fileName = sett.value("LogFileName", "").toString();
+    QStringList Logger::configErrors() const {
+        std::lock_guard<std::mutex> lock(m_reload_mutex);
+        return m_config_errors;
+    }
 
-        if (this->m_rootFolder.isEmpty()) {
+    bool Logger::reloadConfig() {
+        return reloadConfig(m_config_file, m_config_section);
+    }
+
+    bool Logger::reloadConfig(const QString &file, const QString &section) {
+        if (!m_writerThread.joinable()) {
             return false;
         }
+        LoggerConfig config;
+        const bool loaded = config.load(file, section);
+        for (const QString &error : config.errors()) {
+            qWarning("Logger configuration %s: %s", qPrintable(file), qPrintable(error));
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_reload_mutex);
+            m_config_errors = config.errors();
+            if (!loaded) {
+                return false;
+            }
+            // Настройки, ещё не применённые потоком записи, заменяются новыми
+            m_reload_settings.reset(new LoggerSettings(config.settings()));
+            m_reload_pending.store(true, std::memory_order_release);
+        }
+        m_signal.notify();
+        return true;
+    }
 
-        const QString log_l = sett.value("LogLevel", "System").toString();
-        this->m_level = LoggerLevel_form_str(log_l);
+    void Logger::setConfigWatch(bool enable) {
+        m_config_watch = enable;
+    }
 
-        const QString size = sett.value("MaxLogFileSize", "").toString();
-        this->m_maxFilesSizeInBytes = MaxLogFileSize_to_int(size);
+    void Logger::apply_reload() {
+        std::unique_ptr<LoggerSettings> s;
+        {
+            std::lock_guard<std::mutex> lock(m_reload_mutex);
+            s.swap(m_reload_settings);
+            m_reload_pending.store(false, std::memory_order_relaxed);
+        }
+        if (!s) {
+            return;
+        }
+        // Повторы выводятся в прежнем формате и прежний файл
+        write_repeats();
+        m_level = s->level;
+        m_formatter.setFormat(s->format);
+        m_formatter.setSourceFullPath(s->sourceFullPath);
+        apply_pattern(s->pattern);
+        if (!s->suppressDuplicates && m_last_record) {
+            // Повторы последнего сообщения уже выведены
+            recycle(m_last_record);
+            m_last_record = nullptr;
+        }
+        m_suppress_duplicates = s->suppressDuplicates;
+        m_maxFilesSizeInBytes = s->maxFileSize;
+        m_maxFilesCount = s->maxFilesCount;
+        if (s->folder != m_rootFolder || s->fileName != m_fileName) {
+            switch_file(s->folder, s->fileName);
+        }
+        system("Log configuration reloaded");
+    }
 
-        this->m_maxFilesCount =  sett.value("MaxFilesCount", -1).toInt();
+    void Logger::switch_file(const QString &folder, const QString &fileName) {
+        if (m_cur_file.isOpen()) {
+            // Все строки прежнего файла сохраняются до его закрытия
+            write_buffer();
+            sync_file(true);
+            m_uring.drain();
+            trim_file();
+            m_index.close();
+            m_cur_file.close();
+            if (m_uring.isActive()) {
+                m_uring.attach(-1, 0);
+            } else if (m_durability != LoggerDurability::Flush) {
+                m_syncer.attach(-1);
+            }
+        }
+        m_rootFolder = folder;
+        m_fileName = fileName;
+        // Пока открыт буфер в разделяемой памяти, файл журнала не используется
+        m_file_wanted = !m_fileName.isEmpty() && !m_shm.isOpen();
+        if (!m_file_wanted) {
+            return;
+        }
+        if (m_async_io && !m_uring.isActive() && !m_uring.init()) {
+            qWarning("io_uring is not available, synchronous file writes will be used");
+        }
+        m_open_retry_delay = std::chrono::milliseconds(1000);
+        if (!open_active_file()) {
+            qWarning("Cannot create the file %s, log lines are kept in memory until it is available",
+                     qPrintable(m_cur_file.fileName()));
+            m_open_retry_at = std::chrono::steady_clock::now() + m_open_retry_delay;
+            return;
+        }
+        if (!m_fallback_buf.isEmpty() || m_fallback_dropped > 0) {
+            replay_fallback();
+        }
+    }
 
-        m_is_writing = !this->m_fileName.isEmpty();
-        if (m_is_writing) {
-            m_writerThread = std::thread(&Logger::write_action, this);
+    void Logger::apply_settings(const LoggerSettings &s) {
+        this->m_rootFolder = s.folder;
+        this->m_fileName = s.fileName;
+        this->m_level = s.level;
+        this->m_maxFilesSizeInBytes = s.maxFileSize;
+        this->m_maxFilesCount = s.maxFilesCount;
+
+        setSharedMemorySink(s.shmName, s.shmSize);
+        setSyslog(s.syslogSocket, s.syslogAppName, s.syslogFacility);
+
+        m_formatter.setFormat(s.format);
+        m_formatter.setSourceFullPath(s.sourceFullPath);
+        apply_pattern(s.pattern);
+        m_rate_limiter.setLimit(s.rateLimit, s.rateLimitBurst);
+        m_suppress_duplicates = s.suppressDuplicates;
+        for (int l = LoggerLevel::Critical; l <= LoggerLevel::Developer; ++l) {
+            setSampleRate(static_cast<LoggerLevel>(l), s.sampleRate[l - LoggerLevel::System]);
         }
 
-        return true;
+        m_batch_window = s.batchWindow;
+        if (s.arenaSize >= 0) {
+            m_arena_size = static_cast<std::uint32_t>(std::min<std::int64_t>(s.arenaSize, std::numeric_limits<std::uint32_t>::max()));
+        }
+        m_async_io = s.asyncIo;
+        if (s.tailBuffer >= 0) {
+            setTailBuffer(s.tailBuffer);
+        }
+        setTailSocket(s.tailSocket);
+        m_thread_fields = s.threadFields;
+        setClockSource(s.clockSource);
+        setWriterThreadOptions(s.writer);
+        if (s.indexInterval >= 0) {
+            setIndexInterval(s.indexInterval);
+        }
+        if (s.preallocateExtent >= 0) {
+            setPreallocateExtent(s.preallocateExtent);
+        }
+
+        setDurability(s.durability, s.syncInterval);
+        setCompression(s.compression, s.compressionLevel);
+        setArchiveCompression(s.archiveCompression, s.archiveCompressionLevel, s.archiveWorkers);
+        setBatchChecksum(s.batchChecksum);
+        setOpenMode(s.openMode);
+        if (s.fallbackBuffer >= 0) {
+            setFallbackBuffer(s.fallbackBuffer);
+        }
+        setConfigWatch(s.watchConfig);
     }
 
     void Logger::system(const QString &message, const QString &sourceFile, std::int32_t sourceLine) {
         if (this->m_level >= LoggerLevel::System && m_is_writing) {
-            std::lock_guard<std::mutex> lock(m_queue_mutex);
-            this->addQueueItem(format_msg("System", message, sourceFile, sourceLine));
+            format_msg(LoggerLevel::System, message, sourceFile, sourceLine);
         }
     }
 
     void Logger::critical(const QString &message, const QString &sourceFile, std::int32_t sourceLine) {
         if (this->m_level >= LoggerLevel::Critical && m_is_writing) {
-            std::lock_guard<std::mutex> lock(m_queue_mutex);
-            this->addQueueItem(format_msg("Critical", message, sourceFile, sourceLine));
+            format_msg(LoggerLevel::Critical, message, sourceFile, sourceLine);
         }
     }
 
     void Logger::error(const QString &message, const QString &sourceFile, std::int32_t sourceLine) {
         if (this->m_level >= LoggerLevel::Error && m_is_writing) {
-            std::lock_guard<std::mutex> lock(m_queue_mutex);
-            this->addQueueItem(format_msg("Error", message, sourceFile, sourceLine));
+            format_msg(LoggerLevel::Error, message, sourceFile, sourceLine);
         }
     }
 
     void Logger::warning(const QString &message, const QString &sourceFile, std::int32_t sourceLine) {
         if (this->m_level >= LoggerLevel::Warning && m_is_writing) {
-            std::lock_guard<std::mutex> lock(m_queue_mutex);
-            this->addQueueItem(format_msg("Warning", message, sourceFile, sourceLine));
+            format_msg(LoggerLevel::Warning, message, sourceFile, sourceLine);
         }
     }
 
     void Logger::info(const QString &message, const QString &sourceFile, std::int32_t sourceLine) {
         if (this->m_level >= LoggerLevel::Info && m_is_writing) {
-            std::lock_guard<std::mutex> lock(m_queue_mutex);
-            this->addQueueItem(format_msg("Info", message, sourceFile, sourceLine));
+            format_msg(LoggerLevel::Info, message, sourceFile, sourceLine);
         }
     }
 
     void Logger::debug(const QString &message, const QString &sourceFile, std::int32_t sourceLine) {
         if (this->m_level >= LoggerLevel::Debug && m_is_writing) {
-            std::lock_guard<std::mutex> lock(m_queue_mutex);
-            this->addQueueItem(format_msg("Debug", message, sourceFile, sourceLine));
+            format_msg(LoggerLevel::Debug, message, sourceFile, sourceLine);
         }
     }
 
     void Logger::dev(const QString &message, const QString &sourceFile, std::int32_t sourceLine) {
         if (this->m_level >= LoggerLevel::Developer && m_is_writing) {
+            format_msg(LoggerLevel::Developer, message, sourceFile, sourceLine);
+        }
+    }
+
+    void Logger::system(const QString &message, const LoggerSourceLocation &location) {
+        if (this->m_level >= LoggerLevel::System && m_is_writing) {
+            format_msg(LoggerLevel::System, message, QString(), -1, {}, &location);
+        }
+    }
+
+    void Logger::critical(const QString &message, const LoggerSourceLocation &location) {
+        if (this->m_level >= LoggerLevel::Critical && m_is_writing) {
+            format_msg(LoggerLevel::Critical, message, QString(), -1, {}, &location);
+        }
+    }
+
+    void Logger::error(const QString &message, const LoggerSourceLocation &location) {
+        if (this->m_level >= LoggerLevel::Error && m_is_writing) {
+            format_msg(LoggerLevel::Error, message, QString(), -1, {}, &location);
+        }
+    }
+
+    void Logger::warning(const QString &message, const LoggerSourceLocation &location) {
+        if (this->m_level >= LoggerLevel::Warning && m_is_writing) {
+            format_msg(LoggerLevel::Warning, message, QString(), -1, {}, &location);
+        }
+    }
+
+    void Logger::info(const QString &message, const LoggerSourceLocation &location) {
+        if (this->m_level >= LoggerLevel::Info && m_is_writing) {
+            format_msg(LoggerLevel::Info, message, QString(), -1, {}, &location);
+        }
+    }
+
+    void Logger::debug(const QString &message, const LoggerSourceLocation &location) {
+        if (this->m_level >= LoggerLevel::Debug && m_is_writing) {
+            format_msg(LoggerLevel::Debug, message, QString(), -1, {}, &location);
+        }
+    }
+
+    void Logger::dev(const QString &message, const LoggerSourceLocation &location) {
+        if (this->m_level >= LoggerLevel::Developer && m_is_writing) {
+            format_msg(LoggerLevel::Developer, message, QString(), -1, {}, &location);
+        }
+    }
+
+    void Logger::log(LoggerLevel level,
+                     const QString &message,
+                     std::initializer_list<LoggerField> fields,
+                     const QString &sourceFile,
+                     std::int32_t sourceLine) {
+        if (this->m_level >= level && m_is_writing) {
+            format_msg(level, message, sourceFile, sourceLine, fields);
+        }
+    }
+
+    void Logger::log(LoggerLevel level,
+                     const QString &message,
+                     std::initializer_list<LoggerField> fields,
+                     const LoggerSourceLocation &location) {
+        if (this->m_level >= level && m_is_writing) {
+            format_msg(level, message, QString(), -1, fields, &location);
+        }
+    }
+
+    bool Logger::writeFormatted(LoggerLevel level, std::int64_t time, const char *line, int size) {
+        if (!m_is_writing || size <= 0) {
+            return false;
+        }
+        LoggerRecord *rec = m_arena.allocate(static_cast<std::size_t>(size));
+        rec->level = level;
+        rec->time = time;
+        rec->preformatted = true;
+        std::memcpy(rec->data(), line, static_cast<std::size_t>(size));
+        rec->messageSize = static_cast<std::uint32_t>(size);
+
+        bool wasEmpty;
+        {
             std::lock_guard<std::mutex> lock(m_queue_mutex);
-            this->addQueueItem(format_msg("Developer", message, sourceFile, sourceLine));
+            wasEmpty = this->addQueueItem(rec);
+        }
+        if (wasEmpty) {
+            m_signal.notify();
+        }
+        return true;
+    }
+
+    std::uint64_t Logger::formattedWritten() const {
+        return m_formatted_written.load(std::memory_order_acquire);
+    }
+
+    void Logger::setFormat(LoggerFormat format) {
+        m_formatter.setFormat(format);
+    }
+
+    void Logger::setSourceFullPath(bool full) {
+        m_formatter.setSourceFullPath(full);
+    }
+
+    void Logger::setPattern(const QString &pattern) {
+        // Поток записи обходит шаги шаблона без блокировки: после запуска шаблон
+        // меняется только через reloadConfig() в самом потоке записи
+        if (m_is_writing) {
+            qWarning("The log line pattern cannot be changed after init, use reloadConfig()");
+            return;
+        }
+        apply_pattern(pattern);
+    }
+
+    void Logger::apply_pattern(const QString &pattern) {
+        if (!m_formatter.setPattern(pattern)) {
+            qWarning("Invalid log line pattern \"%s\", the pattern is not changed", qPrintable(pattern));
+        }
+    }
+
+    void Logger::setRateLimit(double perSecond, std::int32_t burst) {
+        m_rate_limiter.setLimit(perSecond, burst);
+    }
+
+    void Logger::setSuppressDuplicates(bool enable) {
+        m_suppress_duplicates = enable;
+    }
+
+    void Logger::setBatchWindow(std::chrono::microseconds window) {
+        m_batch_window = window;
+    }
+
+    void Logger::setArenaSize(std::uint32_t records) {
+        m_arena_size = records;
+    }
+
+    void Logger::setDurability(LoggerDurability mode, std::chrono::milliseconds syncInterval) {
+        m_durability = mode;
+        m_sync_interval = syncInterval.count() > 0 ? syncInterval : std::chrono::milliseconds(0);
+    }
+
+    void Logger::setPreallocateExtent(std::int64_t bytes) {
+        m_prealloc_extent = bytes > 0 ? bytes : 0;
+    }
+
+    void Logger::setThreadName(const QString &name) {
+        setCurrentThreadName(name);
+    }
+
+    void Logger::setThreadFields(bool enable) {
+        m_thread_fields = enable;
+    }
+
+    void Logger::setClockSource(LoggerClockSource source) {
+        if (!m_clock.setSource(source)) {
+            qWarning("Invariant TSC is not available, CLOCK_MONOTONIC_RAW will be used");
+        }
+    }
+
+    void Logger::setWriterThreadOptions(const LoggerThreadOptions &options) {
+        m_thread_options = options;
+    }
+
+    void Logger::setIndexInterval(std::int64_t bytes) {
+        m_index.setInterval(bytes);
+    }
+
+    void Logger::setAsyncIo(bool enable) {
+        m_async_io = enable;
+    }
+
+    void Logger::setTailBuffer(std::int64_t bytes) {
+        m_tail.setCapacity(bytes);
+    }
+
+    void Logger::setSharedMemorySink(const QString &name, std::int64_t capacity) {
+        m_shm_name = name;
+        m_shm_capacity = capacity > 0 ? capacity : LoggerShmRing::DefaultCapacity;
+    }
+
+    void Logger::setTailSocket(const QString &path) {
+        m_tail_socket = path;
+        if (!path.isEmpty() && !m_tail.isEnabled()) {
+            m_tail.setCapacity(1024 * 1024);
+        }
+    }
+
+    void Logger::setCompression(LoggerCompression method, int level) {
+        if (!m_compressor.setMethod(method, level)) {
+            qWarning("Log compression method %d is not supported by this build, log files will not be compressed",
+                     static_cast<int>(method));
+        }
+    }
+
+    void Logger::setArchiveCompression(LoggerCompression method, int level, int workers) {
+        if (!m_archiver.setCompression(method, level, workers)) {
+            qWarning("Log compression method %d is not supported by this build, rotated log files will not be compressed",
+                     static_cast<int>(method));
+        }
+    }
+
+    void Logger::setBatchChecksum(bool enable) {
+        m_batch_checksum = enable;
+    }
+
+    void Logger::setOpenMode(LoggerOpenMode mode) {
+        m_open_mode = mode;
+    }
+
+    void Logger::setFallbackBuffer(std::int64_t bytes) {
+        m_fallback_limit = bytes > 0 ? bytes : 0;
+    }
+
+    void Logger::setSyslog(const QString &socketPath, const QString &appName, int facility) {
+        m_syslog.setTarget(socketPath, appName, facility);
+    }
+
+    LoggerSyslogStats Logger::syslogStats() const {
+        return m_syslog.stats();
+    }
+
+    LoggerArenaStats Logger::arenaStats() const {
+        return m_arena.stats();
+    }
+
+    void Logger::setSampleRate(LoggerLevel level, std::uint32_t oneIn) {
+        if (level == LoggerLevel::System) {
+            return;
         }
+        m_sample_rate[level - LoggerLevel::System] = oneIn > 1 ? oneIn : 1;
+    }
+
+    LoggerSamplingStats Logger::samplingStats(LoggerLevel level) const {
+        const int idx = level - LoggerLevel::System;
+        LoggerSamplingStats stats;
+        stats.rate = m_sample_rate[idx];
+        stats.written = m_sample_written[idx].load(std::memory_order_relaxed);
+        stats.skipped = m_sample_skipped[idx].load(std::memory_order_relaxed);
+        return stats;
     }
 
     bool Logger::isDeveloper() const    {   return m_level == LoggerLevel::Developer;   }
@@ -264,7 +1181,12 @@ namespace DIRA_3D_GW {
 
     bool Logger::isFileMaxSize() const {
         static const qint64 diff = 80;
-        return m_maxFilesSizeInBytes != -1 && m_cur_file.size() - diff >= m_maxFilesSizeInBytes;
+        // При асинхронной записи размер файла учитывает ещё не завершённые операции
+        const qint64 fileSize = active_file_size();
+        // Размер сжатого файла известен только после записи кадра
+        const qint64 pending = m_compressor.isActive() ? 0 : m_out_buf.size();
+        return m_maxFilesSizeInBytes != -1 && m_cur_file.isOpen()
+                && fileSize + pending - diff >= m_maxFilesSizeInBytes;
     }
 
     void Logger::backupActiveFile() {
@@ -274,6 +1196,11 @@ namespace DIRA_3D_GW {
             if (backup.exists())
                 backup.remove();
 
+            // Активный файл закрывается до копирования: после копирования он
+            // открывается заново с усечением, а повторное открытие уже открытого
+            // файла завершается ошибкой и сохраняемый хвост дописывался бы в конец
+            m_cur_file.close();
+
             // copy from backup to m_cur_file
             if(m_cur_file.copy(backup.fileName())) {
                 backup.setPermissions(backup.permissions() |
@@ -283,22 +1210,51 @@ namespace DIRA_3D_GW {
                                     QFileDevice::WriteOther);
 
                 if (!backup.open(QIODevice::ReadOnly|QIODevice::Unbuffered|QIODevice::Text)) {
-                    qWarning("Cannot create the file %s", (const char *) backup.fileName().data());
+                    // Активный файл не изменяется и открывается повторно потоком записи
+                    qWarning("Cannot create the file %s", qPrintable(backup.fileName()));
+                    backup.remove();
+                    return;
                 }
                 const auto size = (qint64)backup.size() / 4;
-                backup.seek(size);
+                if (m_compressor.isActive()) {
+                    // Сжатый файл сохраняется с начала первого кадра после четверти файла
+                    const char *data = (const char *) backup.map(0, backup.size());
+                    qint64 pos = 0;
+                    while (data && pos < size) {
+                        const qint64 frame = LoggerCompressor::frameSize(data + pos, backup.size() - pos);
+                        if (frame == 0) {
+                            break;
+                        }
+                        pos += frame;
+                    }
+                    backup.seek(pos);
+                } else {
+                    backup.seek(size);
 
-                const auto str = backup.readLine();
-                const int pos = (int)str.indexOf("\n");
-                backup.seek(size + pos + 1);
+                    const auto str = backup.readLine();
+                    const int pos = (int)str.indexOf("\n");
+                    backup.seek(size + pos + 1);
+                }
 
-                if (!m_cur_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
-                    qWarning("Cannot create the file %s", (const char *) m_cur_file.fileName().data());
+                const QIODevice::OpenMode mode = m_uring.isActive()
+                        ? QIODevice::ReadWrite
+                        : QIODevice::ReadWrite | QIODevice::Append;
+                if (m_cur_file.open(mode | QIODevice::Truncate)) {
+                    // write current size to m_cur_file
+                    const auto size_to_write = backup.size() - backup.pos();
+                    const char *tail = size_to_write > 0
+                            ? (const char *) backup.map(backup.pos(), size_to_write) : nullptr;
+                    if (tail) {
+                        m_cur_file.write(tail, size_to_write);
+                    }
+                    m_cur_file.flush();
+                    // Смещения строк уменьшились на размер удалённого начала журнала
+                    m_index.truncateFront(tail ? backup.pos() : backup.size());
+                } else {
+                    // Файл не усечён, индекс остаётся верным. Строки накапливаются в
+                    // памяти до повторного открытия файла потоком записи
+                    qWarning("Cannot create the file %s", qPrintable(m_cur_file.fileName()));
                 }
-                // write current size to m_cur_file
-                const auto size_to_write = backup.size() - backup.pos();
-                m_cur_file.write((const char*) backup.map(backup.pos(), size_to_write), size_to_write);
-                m_cur_file.flush();
                 backup.close();
                 std::thread remover = std::thread([&](QString fn)
                                         {
@@ -311,33 +1267,46 @@ namespace DIRA_3D_GW {
                     remover.detach();
             }
             else {
-                qWarning("Cannot create the file %s", (const char *) backup.fileName().data());
+                qWarning("Cannot create the file %s", qPrintable(backup.fileName()));
             }
         } else {
             // check m_maxFilesCount
             QStringList nameFilter;
             nameFilter << QString("%1_*.log").arg(QFileInfo(m_cur_file).baseName());
+            if (m_compressor.isActive()) {
+                nameFilter << QString("%1_*.log").arg(QFileInfo(m_cur_file).baseName()) + m_compressor.suffix();
+            }
+            if (m_archiver.isEnabled() && !m_compressor.isActive()) {
+                nameFilter << QString("%1_*.log").arg(QFileInfo(m_cur_file).baseName()) + m_archiver.suffix();
+            }
             QFileInfoList files = m_cur_dir.entryInfoList(nameFilter,QDir::Files | QDir::NoDotAndDotDot,QDir::Time | QDir::Reversed);
             while (m_maxFilesCount - 1 < files.size()) {
                 // clean last files
                 const QFileInfo &info = files.takeFirst();
                 QFile::remove(info.absoluteFilePath());
+                QFile::remove(LoggerIndex::pathFor(info.absoluteFilePath()));
                 files.pop_front();
             }
 
             // rename m_cur_file
             QString new_file_name = QFileInfo(m_cur_file).baseName()
-                                     + QDateTime::currentDateTime().toString("_ddMMyyyy_hhmmss_zzz.log");
+                                     + QDateTime::currentDateTime().toString("_ddMMyyyy_hhmmss_zzz.log")
+                                     + m_compressor.suffix();
             while (m_cur_dir.exists(m_cur_dir.filePath(new_file_name))) {
                 new_file_name = QFileInfo(m_cur_file).baseName()
-                                 + QDateTime::currentDateTime().toString("_ddMMyyyy_hhmmss_zzz.log");
+                                 + QDateTime::currentDateTime().toString("_ddMMyyyy_hhmmss_zzz.log")
+                                 + m_compressor.suffix();
             }
 
             m_cur_file.close();
             m_cur_file.rename(m_cur_dir.filePath(new_file_name));
+            m_index.rename(m_cur_file.fileName());
+            if (!m_compressor.isActive()) {
+                m_archiver.enqueue(m_cur_file.fileName());
+            }
 
             // create new file m_fileName
-            m_cur_file.setFileName(m_cur_dir.filePath(m_fileName));
+            m_cur_file.setFileName(m_cur_dir.filePath(active_file_name()));
             if (!m_cur_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
                 qWarning("Cannot create the file %s", (const char *) m_cur_file.fileName().data());
             }
@@ -10,15 +10,39 @@
 #endif
 
 #include <QString>
-#include <QQueue>
 #include <QDir>
 #include <QFile>
+#include <QByteArray>
+#include <QStringList>
 
+#include <atomic>
+#include <chrono>
 #include <thread>
+#include <future>
 #include <memory>
-#include <condition_variable>
+#include <mutex>
+#include <initializer_list>
 
 #include "loggertypes.h"
+#include "loggerrecord.h"
+#include "loggerarena.h"
+#include "loggerformatter.h"
+#include "loggerratelimiter.h"
+#include "loggersourcelocation.h"
+#include "loggersignal.h"
+#include "loggeruring.h"
+#include "loggersync.h"
+#include "loggerthread.h"
+#include "loggerclock.h"
+#include "loggerindex.h"
+#include "loggertail.h"
+#include "loggershm.h"
+#include "loggersyslog.h"
+#include "loggercompress.h"
+#include "loggerarchive.h"
+#include "loggerframing.h"
+#include "loggerconfig.h"
+#include "loggerwatch.h"
 
 //! Namespace for Graphical Workstation of the 6G_DIRA_3D project
 namespace DIRA_3D_GW {
@@ -54,7 +78,9 @@ namespace DIRA_3D_GW {
          * свойства значения которых не указаны - инициализируются значениями по
          * умолчанию.
          *     При необходимости создаётся каталог хранения файлов журнала и сам
-         * файл журнала. Запускается поток записи файла.
+         * файл журнала. Запускается поток записи файла. Каталог и файл создаются
+         * потоком записи; в режиме OpenDeferred (по умолчанию) инициализация этого не
+         * ожидает, результат открытия файла возвращает opened().
          *
          * @param dir Каталог хранения файлов журнала
          * @param fileName Имя файла журнала
@@ -62,8 +88,10 @@ namespace DIRA_3D_GW {
          * @param maxFileSize Максимальный размер файла журнала
          * @param maxFilesCount Количество хранимых (предыдущих) файлов журнала
          * @return true - если все параметры установлены корректно и объект готов к
-         * записи журнала или false - в случае ошибок
+         * записи журнала (в режиме OpenSync - и файл журнала открыт) или false - в
+         * случае ошибок
          * @see LoggerLevel
+         * @see setOpenMode
          */
         bool init(const QString &dir,
                   const QString &fileName,
@@ -85,6 +113,54 @@ namespace DIRA_3D_GW {
          */
         bool initFromConfig(const QString &file, const QString &section);
 
+        /**
+         * @brief Ошибки последнего чтения файла конфигурации
+         * @remark Ошибочные значения и неизвестные ключи не прерывают инициализацию
+         * (параметр сохраняет значение по умолчанию), но каждая ошибка выводится
+         * qWarning и сохраняется в виде "Ключ: описание".
+         *
+         * @return Список ошибок (пустой, если файл прочитан без ошибок)
+         * @see LoggerConfig
+         */
+        QStringList configErrors() const;
+
+        /**
+         * @brief Повторное чтение файла конфигурации
+         * @remarks Читает файл и секцию, переданные initFromConfig(). Новые значения
+         * LogFolder, LogFileName, LogLevel, MaxLogFileSize, MaxFilesCount, LogFormat,
+         * LogPattern, SourceFullPath и SuppressDuplicates применяются потоком записи одновременно,
+         * на границе пачки сообщений: все сообщения, зарегистрированные до применения,
+         * записываются в прежний файл, все последующие - в новый. Остальные параметры
+         * применяются только при следующем запуске.
+         *     Метод можно вызывать из любого потока; потоки, регистрирующие сообщения,
+         * не блокируются. Если файл не удалось прочитать, действующие настройки не
+         * изменяются.
+         *
+         * @return true если настройки переданы потоку записи или false в случае
+         * ошибок (см. configErrors())
+         */
+        bool reloadConfig();
+
+        /**
+         * @brief Повторное чтение указанного файла конфигурации
+         * @see reloadConfig()
+         *
+         * @param file Имя (полный путь) файла конфигурации
+         * @param section Название секции в файле
+         */
+        bool reloadConfig(const QString &file, const QString &section);
+
+        /**
+         * @brief Включение отслеживания изменений файла конфигурации
+         * @remark После каждого изменения файла, переданного initFromConfig(), он
+         * перечитывается (см. reloadConfig()). На Linux изменения отслеживаются через
+         * inotify, на других Unix-платформах - опросом раз в секунду. Метод должен
+         * вызываться до initFromConfig(). В файле конфигурации - ключ WatchConfig.
+         *
+         * @param enable true - отслеживать изменения
+         */
+        void setConfigWatch(bool enable);
+
         /**
          * @brief Регистрация системного сообщения для записи в журнал
          * @remarks Системные сообщения пишутся в журнал всегда (вне зависимости от
@@ -193,6 +269,504 @@ namespace DIRA_3D_GW {
                  const QString &sourceFile = QString(""),
                  std::int32_t sourceLine = -1);
 
+        /**
+         * @brief Регистрация сообщений с местом вызова LoggerSourceLocation
+         * @remarks Аналоги методов system(), critical(), error(), warning(), info(),
+         * debug() и dev(), принимающие зарегистрированное место вызова вместо имени
+         * файла и номера строки. В очереди сообщений хранится только идентификатор
+         * места вызова, а имя файла (полное или без каталога, см. setSourceFullPath)
+         * выводится потоком записи. Например:
+         *  logger.error("Device disconnected", LOGGER_HERE());
+         *
+         * @param message Текст сообщения
+         * @param location Место вызова
+         * @see LOGGER_HERE
+         */
+        void system(const QString &message, const LoggerSourceLocation &location);
+        void critical(const QString &message, const LoggerSourceLocation &location);
+        void error(const QString &message, const LoggerSourceLocation &location);
+        void warning(const QString &message, const LoggerSourceLocation &location);
+        void info(const QString &message, const LoggerSourceLocation &location);
+        void debug(const QString &message, const LoggerSourceLocation &location);
+        void dev(const QString &message, const LoggerSourceLocation &location);
+
+        /**
+         * @brief Регистрация структурированного сообщения для записи в журнал
+         * @remarks Сообщение дополняется набором типизированных полей (целые и
+         * вещественные числа, строки, длительности). Поля хранятся в записи очереди в
+         * компактном двоичном виде и преобразуются в текст только в потоке записи в
+         * соответствии с форматом журнала (см. setFormat).
+         *     Например:
+         *  logger.log(LoggerLevel::Info, "frame received",
+         *             {{"frame", frameNo}, {"size", 1024}, {"elapsed", duration}});
+         *
+         * @param level Уровень сообщения
+         * @param message Текст сообщения
+         * @param fields Поля сообщения. Имена полей должны быть строковыми литералами
+         * @param sourceFile Имя файла исходного кода откуда иницирована запись сообщения
+         * @param sourceLine Номер строки кода.
+         * @see LoggerField
+         */
+        void log(LoggerLevel level,
+                 const QString &message,
+                 std::initializer_list<LoggerField> fields,
+                 const QString &sourceFile = QString(""),
+                 std::int32_t sourceLine = -1);
+
+        /**
+         * @brief Регистрация структурированного сообщения с местом вызова
+         * LoggerSourceLocation
+         *
+         * @param level Уровень сообщения
+         * @param message Текст сообщения
+         * @param fields Поля сообщения. Имена полей должны быть строковыми литералами
+         * @param location Место вызова
+         * @see LOGGER_HERE
+         */
+        void log(LoggerLevel level,
+                 const QString &message,
+                 std::initializer_list<LoggerField> fields,
+                 const LoggerSourceLocation &location);
+
+        /**
+         * @brief Запись готовой строки файла журнала
+         * @remark Строка записывается без форматирования, ограничения частоты и выборки
+         * (но с ротацией, индексом и синхронизацией). Используется сборщиком строк
+         * других процессов (qt-logger-collector).
+         *
+         * @param level Уровень сообщения
+         * @param time Время сообщения, нс от начала эпохи
+         * @param line Строка, включая перевод строки
+         * @param size Размер строки, байт
+         * @return true если строка поставлена в очередь записи или false если журнал
+         * не инициализирован
+         * @see formattedWritten
+         */
+        bool writeFormatted(LoggerLevel level, std::int64_t time, const char *line, int size);
+
+        /**
+         * @brief Количество строк writeFormatted(), обработанных потоком записи
+         * @remark Строки учитываются после записи пачки, в которую они попали, в файл
+         * журнала (и синхронизации с диском, если её требует режим сохранности). Строки
+         * недоступного файла учитываются после помещения в буфер строк.
+         *     Строки обрабатываются в порядке вызовов writeFormatted(), поэтому
+         * вызывающий может освобождать источник строк по мере роста значения.
+         */
+        std::uint64_t formattedWritten() const;
+
+        /**
+         * @brief Установка формата записи журнала
+         * @remark Должна вызываться до инициализации объекта. При инициализации из
+         * файла конфигурации формат задаётся параметром LogFormat (Text, Json, Logfmt).
+         *
+         * @param format Формат записи журнала
+         * @see LoggerFormat
+         */
+        void setFormat(LoggerFormat format);
+
+        /**
+         * @brief Установка способа вывода имени файла исходного кода
+         * @remark Применяется к сообщениям с местом вызова LoggerSourceLocation. В файле
+         * конфигурации задаётся параметром SourceFullPath.
+         *
+         * @param full true - полный путь к файлу, false - только имя файла (по умолчанию)
+         */
+        void setSourceFullPath(bool full);
+
+        /**
+         * @brief Установка шаблона строки текстового формата
+         * @remark Должна вызываться до инициализации объекта: после запуска потока
+         * записи вызов игнорируется, а шаблон меняется через reloadConfig().
+         * Шаблон, например "%d{iso8601.us} %l %t %m%( [%f:%n]%)", разбирается
+         * один раз и применяется к формату Text (см. LoggerFormatter::setPattern()).
+         * Пустой шаблон - стандартная строка Text. В файле конфигурации задаётся
+         * параметром LogPattern.
+         *
+         * @param pattern Шаблон строки
+         */
+        void setPattern(const QString &pattern);
+
+        /**
+         * @brief Установка ограничения частоты сообщений для каждого места вызова
+         * @remark Должна вызываться до инициализации объекта. Место вызова определяется
+         * именем файла исходного кода и номером строки; сообщения без них, а так же
+         * системные сообщения не ограничиваются. Первое сообщение после периода
+         * ограничения содержит поле suppressed с количеством отброшенных сообщений.
+         *     В файле конфигурации задаётся параметрами RateLimit и RateLimitBurst.
+         *
+         * @param perSecond Количество сообщений в секунду для одного места вызова.
+         * Значение <= 0 отключает ограничение.
+         * @param burst Количество сообщений, которое может быть записано подряд.
+         * Значение <= 0 соответствует perSecond.
+         */
+        void setRateLimit(double perSecond, std::int32_t burst = 0);
+
+        /**
+         * @brief Включение схлопывания повторяющихся сообщений
+         * @remark Одинаковые подряд идущие сообщения (без учёта времени) записываются
+         * один раз, после чего в журнал добавляется строка "Last message repeated N times".
+         * Строка о повторах выводится при появлении другого сообщения, не реже раза в
+         * секунду при непрерывной серии повторов, при перечитывании конфигурации и при
+         * завершении работы.
+         *     В файле конфигурации задаётся параметром SuppressDuplicates.
+         *
+         * @param enable true - схлопывать повторяющиеся сообщения
+         */
+        void setSuppressDuplicates(bool enable);
+
+        /**
+         * @brief Установка окна накопления сообщений потока записи
+         * @remark После пробуждения поток записи ожидает указанное время перед записью
+         * сообщений, поэтому при частых одиночных сообщениях он просыпается один раз на
+         * пачку сообщений. Увеличивает задержку записи на величину окна.
+         *     В файле конфигурации задаётся параметром WriterBatchWindowUs.
+         *
+         * @param window Длительность окна накопления. 0 (по умолчанию) - без ожидания
+         */
+        void setBatchWindow(std::chrono::microseconds window);
+
+        /**
+         * @brief Установка размера пула записей очереди сообщений
+         * @remark Пул выделяется при инициализации объекта, поэтому метод должен
+         * вызываться до неё. Записи, не поместившиеся в ячейку пула (длинные сообщения)
+         * или не нашедшие свободной ячейки, выделяются в куче. Значение 0 отключает пул.
+         *     В файле конфигурации задаётся параметром ArenaSize.
+         *
+         * @param records Количество ячеек наименьшего класса (LoggerArena::SlotSize байт)
+         * в пуле; ячеек по 1 и 4 Кб выделяется в 8 и в 32 раза меньше. По умолчанию 4096
+         * (2 Мб памяти).
+         */
+        void setArenaSize(std::uint32_t records);
+
+        /**
+         * @brief Установка режима сохранности записанных сообщений
+         * @remark По умолчанию строки только передаются ядру, поэтому при отключении
+         * питания последние секунды журнала теряются. В режимах с синхронизацией
+         * fdatasync выполняется отдельным потоком (или асинхронно через io_uring),
+         * поток записи на нём не блокируется:
+         *  - GroupCommit - не чаще одного раза в syncInterval;
+         *  - CriticalSync - как GroupCommit, но пачка с Critical/System сообщениями
+         *    синхронизируется сразу;
+         *  - FullSync - после каждой пачки сообщений.
+         *     Метод должен вызываться до инициализации объекта. В файле конфигурации
+         * задаётся параметрами Durability и SyncIntervalMs.
+         *
+         * @param mode Режим сохранности
+         * @param syncInterval Интервал синхронизации. 0 - синхронизация после каждой пачки
+         */
+        void setDurability(LoggerDurability mode,
+                           std::chrono::milliseconds syncInterval = std::chrono::milliseconds(1000));
+
+        /**
+         * @brief Установка размера экстента предварительного выделения файла журнала
+         * @remark Если задан максимальный размер файла журнала, место под файл
+         * выделяется заранее экстентами указанного размера (fallocate с
+         * FALLOC_FL_KEEP_SIZE), что снижает фрагментацию и задержки выделения блоков
+         * при одновременном росте нескольких файлов. Размер файла при этом не меняется,
+         * поэтому читающие программы не видят невыделенный хвост. При ротации и
+         * завершении работы невостребованные блоки освобождаются. Только Linux.
+         *     В файле конфигурации задаётся параметром PreallocateExtent
+         * (в формате MaxLogFileSize).
+         *
+         * @param bytes Размер экстента, байт. 0 - без предварительного выделения.
+         * По умолчанию 4 Мб.
+         */
+        void setPreallocateExtent(std::int64_t bytes);
+
+        /**
+         * @brief Установка сжатия текущего файла журнала
+         * @remark Строки каждой пачки (и каждых 64 Кб строк) сжимаются в отдельный
+         * кадр, который распаковывается независимо от остальных, поэтому после
+         * аварийного завершения файл читается до последнего записанного кадра. Файлы
+         * журнала получают расширение метода (".gz", ".zst") и читаются zcat/zstdcat.
+         * Максимальный размер файла журнала учитывает сжатые байты, смещения индекса
+         * указывают на начало кадра. Если метод не поддерживается сборкой, файлы
+         * журнала не сжимаются. Метод должен вызываться до инициализации объекта.
+         *     В файле конфигурации задаётся параметрами Compression (None, Gzip, Zstd)
+         * и CompressionLevel.
+         *
+         * @param method Метод сжатия. По умолчанию - без сжатия
+         * @param level Уровень сжатия. 0 - уровень метода по умолчанию
+         */
+        void setCompression(LoggerCompression method, int level = 0);
+
+        /**
+         * @brief Установка сжатия файлов журнала после ротации
+         * @remark Файлы, созданные при ротации, сжимаются в фоне: файл делится на
+         * блоки, которые сжимаются параллельно пулом из workers потоков с политикой
+         * SchedIdle и записываются независимыми кадрами (как при setCompression) в
+         * файл с расширением метода; индекс файла пересчитывается на смещения кадров,
+         * исходный файл удаляется. Несжатые файлы, оставшиеся после предыдущего
+         * запуска, сжимаются при старте. Не используется, если сжимается текущий файл
+         * журнала. Метод должен вызываться до инициализации объекта.
+         *     В файле конфигурации задаётся параметрами ArchiveCompression (None, Gzip,
+         * Zstd), ArchiveCompressionLevel и ArchiveWorkers.
+         *
+         * @param method Метод сжатия. По умолчанию - без сжатия
+         * @param level Уровень сжатия. 0 - уровень метода по умолчанию
+         * @param workers Количество потоков сжатия
+         * @see LoggerArchiver
+         */
+        void setArchiveCompression(LoggerCompression method, int level = 0, int workers = 2);
+
+        /**
+         * @brief Включение контрольных сумм пачек строк файла журнала
+         * @remark После каждой записанной пачки строк в файл добавляется строка-трейлер
+         * с длиной и CRC32C пачки (см. LoggerFraming). При запуске конец текущего файла
+         * журнала проверяется: данные после последней целой пачки (строки, недописанные
+         * при аварийном завершении) удаляются, а в журнал записывается сообщение
+         * System о восстановлении. Для сжатого файла журнала (setCompression) файл
+         * усекается до последнего целого кадра. Метод должен вызываться до
+         * инициализации объекта.
+         *     В файле конфигурации задаётся параметром BatchChecksum.
+         *
+         * @param enable true - контрольные суммы включены. По умолчанию выключены
+         */
+        void setBatchChecksum(bool enable);
+
+        /**
+         * @brief Установка режима открытия файла журнала при инициализации
+         * @remark В режиме OpenDeferred init() и initFromConfig() не ожидают создания
+         * каталога и открытия файла (например в медленном сетевом каталоге), в режиме
+         * OpenSync - ожидают и возвращают false, если файл не открыт. В обоих режимах
+         * сообщения, записанные до открытия файла, не теряются. Метод должен
+         * вызываться до инициализации объекта.
+         *     В файле конфигурации задаётся параметром OpenMode (Deferred, Sync).
+         *
+         * @param mode Режим открытия
+         * @see opened
+         */
+        void setOpenMode(LoggerOpenMode mode);
+
+        /**
+         * @brief Результат открытия журнала потоком записи
+         * @remark Значение становится доступным после первой попытки открыть файл
+         * журнала (или буфер в разделяемой памяти): true - журнал открыт, false -
+         * файл недоступен. Если файл недоступен, строки журнала накапливаются в
+         * памяти (см. setFallbackBuffer), а поток записи повторяет открытие файла с
+         * увеличивающимся интервалом (до 30 с) и записывает в него накопленные строки.
+         *     Для объекта, который не был инициализирован для записи, результат - false.
+         *
+         * @return Результат открытия
+         */
+        std::shared_future<bool> opened() const     {   return m_open_future;   }
+
+        /**
+         * @brief Установка размера буфера строк на время недоступности файла журнала
+         * @remark Строки, не поместившиеся в буфер, отбрасываются; их объём
+         * сообщается в журнал после открытия файла. Метод должен вызываться до
+         * инициализации объекта.
+         *     В файле конфигурации задаётся параметром FallbackBuffer (в формате
+         * MaxLogFileSize).
+         *
+         * @param bytes Размер буфера, байт. 0 - строки не сохраняются. По умолчанию 4 Мб
+         */
+        void setFallbackBuffer(std::int64_t bytes);
+
+        /**
+         * @brief Установка имени текущего потока для записей журнала
+         * @remark Имя хранится в thread local переменной и используется всеми объектами
+         * ведения журнала, в которых включена запись сведений о потоке. Вызывается
+         * один раз при старте потока.
+         *
+         * @param name Имя потока
+         * @see setThreadFields
+         */
+        static void setThreadName(const QString &name);
+
+        /**
+         * @brief Включение записи сведений о потоке-источнике сообщения
+         * @remark В запись добавляются идентификатор потока (tid в Linux) и имя потока,
+         * заданное setThreadName(). Стоимость - одно чтение thread local переменной на
+         * сообщение.
+         *     В файле конфигурации задаётся параметром ThreadFields.
+         *
+         * @param enable true - записывать сведения о потоке (по умолчанию false)
+         */
+        void setThreadFields(bool enable);
+
+        /**
+         * @brief Установка источника времени сообщений
+         * @remark По умолчанию время сообщения - системное время, прочитанное при
+         * добавлении сообщения в очередь. Источники ClockMonotonicRaw и ClockTsc
+         * дешевле: поток-источник сохраняет только показание счётчика (вне мьютекса
+         * очереди), а перевод в системное время выполняет поток записи по
+         * периодически уточняемому соответствию. ClockTsc требует инвариантного TSC;
+         * если он недоступен, используется ClockMonotonicRaw. Метод должен вызываться
+         * до инициализации объекта.
+         *     В файле конфигурации задаётся параметром ClockSource (Realtime,
+         * MonotonicRaw или Tsc).
+         *
+         * @param source Источник времени
+         */
+        void setClockSource(LoggerClockSource source);
+
+        /**
+         * @brief Установка параметров служебных потоков журнала
+         * @remark Позволяет не допустить конкуренции потока записи (и потока
+         * синхронизации) с потоками реального времени: привязать его к выделенным
+         * процессорам, понизить приоритет (nice) или использовать политику
+         * SCHED_BATCH/SCHED_IDLE, задать имя потока для top/perf и выделять буферы
+         * потока на локальном узле NUMA. Метод должен вызываться до инициализации
+         * объекта. Поддерживается в Linux.
+         *     В файле конфигурации задаётся параметрами WriterCpus (список номеров
+         * процессоров через запятую), WriterPolicy (Normal, Batch или Idle), WriterNice,
+         * WriterThreadName и WriterNumaLocal.
+         *
+         * @param options Параметры потоков
+         */
+        void setWriterThreadOptions(const LoggerThreadOptions &options);
+
+        /**
+         * @brief Установка шага индекса файлов журнала
+         * @remark Рядом с каждым файлом журнала ведётся разреженный индекс
+         * ("<файл журнала>.idx") со временем и смещением первой строки после каждых
+         * bytes байт журнала. Индекс переносится вместе с файлом при ротации и
+         * позволяет двоичным поиском переходить к строкам заданного интервала времени.
+         *     В файле конфигурации задаётся параметром IndexInterval (в формате
+         * MaxLogFileSize).
+         *
+         * @param bytes Шаг индекса, байт. 0 (по умолчанию) - индекс не ведётся
+         * @see LoggerIndex
+         */
+        void setIndexInterval(std::int64_t bytes);
+
+        /**
+         * @brief Включение асинхронной записи файла журнала через io_uring
+         * @remark Поток записи не ожидает завершения записи в файл: несколько пачек
+         * строк могут одновременно находиться в обработке ядром. Перед ротацией файла
+         * и при завершении работы поток записи дожидается завершения всех операций.
+         * Доступно только в Linux при сборке с опцией QT_LOGGER_IO_URING; если io_uring
+         * недоступен, используется обычная запись. Метод должен вызываться до
+         * инициализации объекта.
+         *     В файле конфигурации задаётся параметром AsyncIo.
+         *
+         * @param enable true - использовать io_uring (по умолчанию false)
+         */
+        void setAsyncIo(bool enable);
+
+        /**
+         * @brief Установка размера буфера последних строк журнала
+         * @remark Поток записи копирует в буфер каждую строку, записываемую в файл.
+         * Подписчики (например панель журнала) читают строки через tail() без опроса
+         * файла и без блокировки потока записи. Метод должен вызываться до
+         * инициализации объекта.
+         *     В файле конфигурации задаётся параметром TailBuffer (в формате
+         * MaxLogFileSize).
+         *
+         * @param bytes Размер буфера, байт. 0 (по умолчанию) - буфер не ведётся
+         * @see LoggerTail
+         */
+        void setTailBuffer(std::int64_t bytes);
+
+        /**
+         * @brief Трансляция строк журнала через локальный Unix-сокет
+         * @remark Каждый подключившийся клиент получает строки буфера последних строк и
+         * далее новые строки (как tail -f); строка с названием уровня, присланная
+         * клиентом, ограничивает уровень получаемых сообщений. Если буфер последних
+         * строк не задан, используется буфер 1 Мб. Метод должен вызываться до
+         * инициализации объекта.
+         *     В файле конфигурации задаётся параметром TailSocket.
+         *
+         * @param path Путь к файлу сокета. Пустая строка (по умолчанию) - сокет не создаётся
+         * @see LoggerTailServer
+         */
+        void setTailSocket(const QString &path);
+
+        /**
+         * @brief Буфер последних строк журнала для подписчиков
+         * @remark Пример чтения:
+         * @code
+         * LoggerTail::Cursor cursor = logger.tail().subscribe(LoggerLevel::Info, true);
+         * LoggerTail::Line line;
+         * while (logger.tail().wait(cursor, std::chrono::milliseconds(100))) {
+         *     while (logger.tail().next(cursor, line)) {
+         *         const QString text = QString::fromUtf8(line.data, line.size);
+         *         if (logger.tail().commit(cursor)) {
+         *             // line.missed строк пропущено перед text
+         *         }
+         *     }
+         * }
+         * @endcode
+         */
+        LoggerTail &tail()      {   return m_tail;  }
+
+        /**
+         * @brief Передача строк журнала в разделяемую память вместо файла
+         * @remark Поток записи форматирует строки и помещает их в кольцевой буфер в
+         * разделяемой памяти; запись файлов, ротацию и синхронизацию выполняет
+         * отдельный процесс qt-logger-collector. Строки, попавшие в буфер, сохраняются
+         * сборщиком и при аварийном завершении приложения. Каталог и имя файла журнала
+         * в этом режиме не требуются. Метод должен вызываться до инициализации объекта.
+         *     В файле конфигурации задаётся параметрами SharedMemorySink и
+         * SharedMemorySize (в формате MaxLogFileSize).
+         *
+         * @param name Имя объекта разделяемой памяти ("/qt-logger-app"). Пустая строка
+         * (по умолчанию) - строки пишутся в файл
+         * @param capacity Размер буфера, байт
+         * @see LoggerShmRing
+         */
+        void setSharedMemorySink(const QString &name,
+                                 std::int64_t capacity = LoggerShmRing::DefaultCapacity);
+
+        /**
+         * @brief Передача сообщений журнала в локальный syslog
+         * @remark Сообщения передаются в формате RFC 5424 датаграммами в Unix-сокет
+         * syslog (journald принимает их через тот же сокет) дополнительно к файлу журнала.
+         * Если каталог журнала не задан, сообщения передаются только в syslog.
+         * Передача не задерживает поток записи: сообщения, которые syslog не успевает
+         * принять, отбрасываются и учитываются в syslogStats(). Метод должен вызываться
+         * до инициализации объекта.
+         *     В файле конфигурации задаётся параметрами SyslogSocket, SyslogAppName и
+         * SyslogFacility ("user", "daemon", "local0".."local7" или номер).
+         *
+         * @param socketPath Путь к сокету ("/dev/log"). Пустая строка (по умолчанию) -
+         * передача отключена
+         * @param appName Имя приложения в сообщениях. По умолчанию - "qt-logger"
+         * @param facility Facility сообщений
+         * @see LoggerSyslog
+         */
+        void setSyslog(const QString &socketPath,
+                       const QString &appName = QString(),
+                       int facility = LoggerSyslog::FacilityUser);
+
+        /**
+         * @brief Статистика передачи сообщений в syslog
+         */
+        LoggerSyslogStats syslogStats() const;
+
+        /**
+         * @brief Статистика использования пула записей очереди сообщений
+         * @remark Количество записей, выделенных в куче, позволяет проверить, что при
+         * длительной записи журнала выделения памяти не происходит.
+         */
+        LoggerArenaStats arenaStats() const;
+
+        /**
+         * @brief Установка частоты выборочной записи сообщений уровня
+         * @remark Из сообщений указанного уровня в журнал попадает в среднем одно из
+         * oneIn. Выбор выполняется с помощью генератора псевдослучайных чисел потока,
+         * поэтому не требует синхронизации. Записанные сообщения содержат поле
+         * sample_rate, что позволяет оценить исходное количество сообщений.
+         *     Системные сообщения не прореживаются. В файле конфигурации задаётся
+         * параметрами SampleRate<Уровень>, например SampleRateDeveloper=1000.
+         *     Должна вызываться до инициализации объекта.
+         *
+         * @param level Уровень сообщений
+         * @param oneIn Записывается одно сообщение из oneIn. 0 и 1 - записываются все
+         */
+        void setSampleRate(LoggerLevel level, std::uint32_t oneIn);
+
+        /**
+         * @brief Статистика выборочной записи сообщений уровня
+         * @remark Учитываются только сообщения уровней, для которых задана выборочная
+         * запись.
+         *
+         * @param level Уровень сообщений
+         * @return Частота выборки, количество записанных и пропущенных сообщений
+         */
+        LoggerSamplingStats samplingStats(LoggerLevel level) const;
+
         /**
          * @brief Проврека того, что сообщения уровня "Developer" пишутся в файл
          * @remark В случае если процесс формирования сообщения на стороне клиента
@@ -240,7 +814,7 @@ namespace DIRA_3D_GW {
         /**
          * @brief Конвертация строки максимального размера файла в байты
          * @remark Преобразует строку, которая может указывать размер в Mб, Кб и т.п.
-         * в число соответсвующее количеству байт.
+         * в число соответсвующее количеству байт (см. LoggerConfig::parseSize()).
          *
          * @param size Строка с указанным размеров
          * @return Количество байт соответсвующее строке или -1 в случае ошибок
@@ -251,43 +825,191 @@ namespace DIRA_3D_GW {
         /**
          * @brief Функция потока записи файла
          * @remark Подготавливает всё для ведения журнала и засыпает до появления в очереди
-         * сообщений. При пробуждении перебирает всю очередь сообщений и записывает все строки
-         * из очереди в файл журнала.
+         * сообщений (см. LoggerSignal). При пробуждении забирает всю очередь сообщений и
+         * записывает все строки из очереди в файл журнала. При завершении работы перед
+         * выходом записываются все сообщения, оставшиеся в очереди.
          *  На каждой итерации выполняется проверка размера файла журнала и при необходимости
          * все необходимые действия с файлом(-ами) в соответствии с настройками модуля.
          */
         void write_action();
 
         /**
-         * @brief Формирование строки сообщения для записи в файл
-         * @remark По всем указанным параметрам формирует строку файла журнала.
+         * @brief Формирование записи сообщения и добавление её в очередь
+         * @remark Фиксирует время сообщения и сохраняет все параметры в записи очереди.
+         * Преобразование записи в строку файла журнала выполняется в потоке записи.
          *
-         * @param strLevel Уровень логгирования
+         * @param level Уровень логгирования
          * @param message Текст сообщения
          * @param sourceFile Имя файла из которого сгенерировано сообщение
          * @param sourceLine Строка в файле из которой сгенерировано сообщение
-         * @return Строка в формате ведения журнала
+         * @param fields Поля структурированного сообщения
+         * @param location Место вызова (если задано, sourceFile и sourceLine не используются)
          */
-        QString format_msg(const QString &strLevel,
-                           const QString &message,
-                           const QString &sourceFile = QString(""),
-                           std::int32_t sourceLine = -1);
+        void format_msg(LoggerLevel level,
+                        const QString &message,
+                        const QString &sourceFile = QString(""),
+                        std::int32_t sourceLine = -1,
+                        std::initializer_list<LoggerField> fields = {},
+                        const LoggerSourceLocation *location = nullptr);
 
         /**
          * @brief Добавление сообщения в очередь.
          *
-         * @param item Строка с текстом собщения
+         * @param item Запись сообщения
+         * @return true если до добавления очередь была пуста
+         */
+        bool addQueueItem(LoggerRecord *item);
+
+        /**
+         * @brief Извлечение всех сообщений из очереди сообщений
+         *
+         * @return Первая запись списка сообщений, связанных через LoggerRecord::next,
+         * или nullptr если сообщений в очереди нет.
+         */
+        LoggerRecord *dequeueItems();
+
+        /**
+         * @brief Запись накопленного буфера строк в файл журнала
+         * @remark При ошибке записи смещение файла берётся из его фактического размера.
+         */
+        void write_buffer();
+
+        /**
+         * @brief Добавление строки записи в буфер записи и регистрация её в индексе
+         *
+         * @param rec Запись сообщения
+         */
+        void format_record(const LoggerRecord &rec);
+
+        /**
+         * @brief Размер файла журнала с учётом ещё не завершённых асинхронных записей
+         */
+        qint64 active_file_size() const;
+
+        /**
+         * @brief Имя текущего файла журнала с расширением метода сжатия
+         */
+        QString active_file_name() const;
+
+        /**
+         * @brief Постановка в очередь сжатия несжатых файлов, созданных при ротации
+         * @remark Вызывается при первом открытии каждого активного файла; недописанные
+         * сжатые файлы прерванного запуска удаляются. При повторном открытии того же
+         * файла (после ошибки) не вызывается: архиватор уже может дописывать *.part.
+         */
+        void archive_rotated_files();
+
+        /**
+         * @brief Удаление недописанных данных в конце текущего файла журнала
+         * @remark Вызывается до открытия файла потоком записи, если включены
+         * контрольные суммы пачек.
+         *
+         * @return Количество удалённых байт
+         */
+        qint64 recover_active_file();
+
+        /**
+         * @brief Запуск потока записи после чтения параметров
+         * @return Результат инициализации (в режиме OpenSync - результат открытия файла)
+         */
+        bool start_writer();
+
+        /**
+         * @brief Применение настроек, прочитанных из файла конфигурации
+         * @param settings Настройки
+         */
+        void apply_settings(const LoggerSettings &settings);
+
+        /**
+         * @brief Применение перечитанных настроек потоком записи
+         * @remark Вызывается на границе пачки сообщений, когда буфер записи пуст.
+         */
+        void apply_reload();
+
+        /**
+         * @brief Разбор шаблона строки без проверки состояния потока записи
+         * @remark Вызывается до запуска потока записи или самим потоком записи.
+         */
+        void apply_pattern(const QString &pattern);
+
+        /**
+         * @brief Переход к файлу журнала в другом каталоге или с другим именем
+         * @remark Текущий файл сохраняется и закрывается. Если новый файл недоступен,
+         * строки накапливаются в памяти до его открытия (см. setFallbackBuffer()).
+         *
+         * @param folder Каталог файлов журнала
+         * @param fileName Имя файла журнала (пустое - запись в файл прекращается)
+         */
+        void switch_file(const QString &folder, const QString &fileName);
+
+        /**
+         * @brief Запись строк, накопленных без файла журнала, после его открытия
+         */
+        void replay_fallback();
+
+        /**
+         * @brief Создание каталога и открытие текущего файла журнала
+         * @return true если файл открыт или false если каталог или файл недоступны
+         */
+        bool open_active_file();
+
+        /**
+         * @brief Повторное открытие недоступного файла журнала и запись строк,
+         * накопленных в памяти
+         */
+        void retry_open_file();
+
+        /**
+         * @brief Предварительное выделение следующего экстента файла журнала
+         */
+        void preallocate_file();
+
+        /**
+         * @brief Освобождение предварительно выделенных, но не записанных блоков
+         * файла журнала
          */
-        void addQueueItem(const QString& item);
+        void trim_file();
 
         /**
-         * @brief Извлечение очередного сообщения из очереди сообщений
+         * @brief Синхронизация записанных данных файла журнала с диском согласно
+         * режиму сохранности
          *
-         * @param dst Ссылка на строку для возврата текста сообщения
-         * @return true если очередь не пуста и сообещние возвращено или false
-         * если сообщений в очереди нет.
+         * @param urgent true - синхронизировать без ожидания интервала синхронизации
+         */
+        void sync_file(bool urgent);
+
+        /**
+         * @brief Передача открытого файла журнала объектам асинхронной записи и
+         * синхронизации
          */
-        bool dequeueItem(QString& dst);
+        void attach_active_file();
+
+        /**
+         * @brief Преобразование записи в строку и добавление её в буфер записи
+         * @remark При включенном схлопывании повторов одинаковые подряд идущие
+         * сообщения только подсчитываются.
+         *
+         * @param rec Запись сообщения
+         */
+        void write_record(LoggerRecord *rec);
+
+        /**
+         * @brief Добавление в буфер записи строки о количестве повторов последнего
+         * сообщения, если такие повторы были.
+         */
+        void write_repeats();
+
+        /**
+         * @brief Запись строки о повторах последнего сообщения вне пачки сообщений
+         */
+        void flush_repeats();
+
+        /**
+         * @brief Добавление обработанной записи в список возврата в пул
+         *
+         * @param rec Запись сообщения
+         */
+        void recycle(LoggerRecord *rec);
 
         /**
          * @brief Конвертация строки в уровень логгирования
@@ -303,9 +1025,43 @@ namespace DIRA_3D_GW {
          */
         LoggerLevel LoggerLevel_form_str(const QString& level);
 
+        /**
+         * @brief Конвертация строки в формат записи журнала
+         * @remark Поддерживаются значения Text, Json (JsonLines) и Logfmt без учёта
+         * регистра. Для остальных строк возвращается LoggerFormat::Text.
+         *
+         * @param format Строка с названием формата
+         * @return Элемент перечисления LoggerFormat
+         * @see LoggerFormat
+         */
+        static LoggerFormat LoggerFormat_from_str(const QString& format);
+
+        /**
+         * @brief Конвертация строки в режим сохранности записанных сообщений
+         * @remark Поддерживаются значения Flush, GroupCommit, CriticalSync и FullSync
+         * без учёта регистра. Для остальных строк возвращается LoggerDurability::Flush.
+         *
+         * @param mode Строка с названием режима
+         * @return Элемент перечисления LoggerDurability
+         * @see LoggerDurability
+         */
+        static LoggerDurability LoggerDurability_from_str(const QString& mode);
+
+        /**
+         * @brief Конвертация строки в метод сжатия файлов журнала
+         * @remark Поддерживаются значения None, Gzip и Zstd без учёта регистра. Для
+         * остальных строк возвращается LoggerCompression::CompressionNone.
+         *
+         * @param method Строка с названием метода
+         * @return Элемент перечисления LoggerCompression
+         * @see LoggerCompression
+         */
+        static LoggerCompression LoggerCompression_from_str(const QString& method);
+
         /**
          * @brief Проверка размера файла на предмет достижения максимального размера
-         * @remarks Проверяет размер файла журнала и если он близок к максимальному
+         * @remarks Проверяет размер файла журнала (с учётом ещё не записанных строк
+         * буфера) и если он близок к максимальному
          * ((m_maxFilesSizeInBytes +/- 80) байт), тогда выполняется сохранение копии
          * файла журнала, а модуль начинает вести журнал в новый файл.
          *
@@ -331,25 +1087,92 @@ namespace DIRA_3D_GW {
     private:
         QString m_rootFolder;       ///< Каталог в котором хранится файл журнала
         QString m_fileName;         ///< Имя файла журнала
-        LoggerLevel m_level;        ///< Текущий уровень логгирования
+        std::atomic<LoggerLevel> m_level;   ///< Текущий уровень логгирования
 
         std::int64_t m_maxFilesSizeInBytes;   ///< Максимальный размер файла журнала
         std::int32_t m_maxFilesCount;         ///< Количество хранящихся файлов журнала
 
-        std::mutex m_mutex;             ///< Мьютекс для пробуждения потока записи
+        QString m_config_file;                ///< Файл конфигурации initFromConfig()
+        QString m_config_section;             ///< Секция файла конфигурации
+        bool m_config_watch = false;          ///< Отслеживание изменений файла конфигурации
+        LoggerConfigWatcher m_config_watcher; ///< Поток отслеживания изменений
+        mutable std::mutex m_reload_mutex;    ///< Защита m_reload_settings и m_config_errors
+        std::unique_ptr<LoggerSettings> m_reload_settings;  ///< Настройки, ожидающие применения
+        std::atomic<bool> m_reload_pending{false};          ///< Флаг наличия m_reload_settings
+        QStringList m_config_errors;          ///< Ошибки чтения файла конфигурации
+
         std::mutex m_queue_mutex;       ///< Мьютекс для синхронизации доступа к очереди сообщений между потоками
-        QQueue<QString> m_queue;        ///< Очередь сообщений для записи в файл журнала
+        LoggerArena m_arena;                    ///< Пул записей очереди сообщений
+        std::uint32_t m_arena_size = 4096;      ///< Количество записей в пуле
+        LoggerRecord *m_queue_head = nullptr;   ///< Первая запись очереди сообщений для записи в файл журнала
+        LoggerRecord *m_queue_tail = nullptr;   ///< Последняя запись очереди сообщений
+        LoggerRecord *m_recycled = nullptr;     ///< Обработанные записи для возврата в пул
 
-        bool m_ready = false;           ///< Флаг наличия сообщений в очереди
-        bool m_is_writing = false;      ///< Флаг того, что процесс записи - запущен
+        std::atomic<bool> m_is_writing{false};  ///< Флаг того, что процесс записи - запущен
         std::thread m_writerThread;     ///< Поток осуществляющий запись сообщений из очереди в файл
-        std::condition_variable m_cv;   ///< Объект синхронизации для запуска потока записи из режима ожидания
+        LoggerSignal m_signal;          ///< Объект синхронизации для запуска потока записи из режима ожидания
+        std::chrono::microseconds m_batch_window{0};    ///< Окно накопления сообщений после пробуждения
+        LoggerThreadOptions m_thread_options;           ///< Параметры служебных потоков журнала
+        LoggerClock m_clock;                            ///< Источник времени сообщений
+        bool m_thread_fields = false;                   ///< Флаг записи сведений о потоке-источнике
 
 
         QDir m_cur_dir;     ///< Корневой каталог файла журнала
         QFile m_cur_file;   ///< Текущий файл журнала
+        qint64 m_file_offset = 0;       ///< Размер файла журнала с учётом записанных буферов
+        LoggerIndex m_index;            ///< Индекс текущего файла журнала
+        bool m_async_io = false;        ///< Флаг использования асинхронной записи
+        LoggerUringWriter m_uring;      ///< Асинхронная запись файла журнала (используется потоком записи)
+        LoggerTail m_tail;              ///< Буфер последних строк журнала
+        QString m_tail_socket;          ///< Путь к сокету трансляции строк журнала
+        LoggerTailServer m_tail_server; ///< Трансляция строк журнала через сокет
+        QString m_shm_name;             ///< Имя буфера строк в разделяемой памяти
+        std::int64_t m_shm_capacity = LoggerShmRing::DefaultCapacity;  ///< Размер буфера в разделяемой памяти
+        LoggerShmRing m_shm;            ///< Буфер строк в разделяемой памяти (используется потоком записи)
+        LoggerSyslog m_syslog;          ///< Передача сообщений в syslog (используется потоком записи)
+
+        LoggerDurability m_durability = LoggerDurability::Flush;    ///< Режим сохранности сообщений
+        std::chrono::milliseconds m_sync_interval{1000};            ///< Интервал синхронизации файла
+        LoggerSyncer m_syncer;                  ///< Поток синхронизации файла с диском
+        bool m_unsynced = false;                ///< В файл записаны несинхронизированные данные
+        bool m_batch_critical = false;          ///< В текущей пачке есть Critical/System сообщения
+        std::chrono::steady_clock::time_point m_last_sync;  ///< Время последней синхронизации через io_uring
+
+        std::int64_t m_prealloc_extent = 4 * 1024 * 1024;   ///< Размер экстента предварительного выделения
+        qint64 m_prealloc_end = 0;              ///< Конец предварительно выделенной области файла
+
+        LoggerFormatter m_formatter;    ///< Преобразование записей в строки файла журнала
+        QByteArray m_out_buf;           ///< Буфер строк для записи в файл (используется потоком записи)
+        LoggerCompressor m_compressor;  ///< Сжатие файла журнала (используется потоком записи)
+        QByteArray m_compressed_buf;    ///< Буфер сжатых кадров (используется потоком записи)
+        LoggerArchiver m_archiver;      ///< Сжатие файлов журнала после ротации
+        QString m_archived_file;        ///< Активный файл, для которого обработаны файлы прерванного запуска
+        bool m_batch_checksum = false;  ///< Флаг записи контрольных сумм пачек строк
+
+        LoggerOpenMode m_open_mode = LoggerOpenMode::OpenDeferred;  ///< Режим открытия файла журнала
+        std::promise<bool> m_open_promise;                          ///< Результат открытия журнала
+        std::shared_future<bool> m_open_future = m_open_promise.get_future().share();  ///< Результат открытия журнала
+        bool m_file_wanted = false;     ///< Строки записываются в файл журнала (используется потоком записи)
+        std::chrono::steady_clock::time_point m_open_retry_at;     ///< Время следующей попытки открыть файл
+        std::chrono::milliseconds m_open_retry_delay{1000};         ///< Интервал попыток открыть файл
+        std::int64_t m_fallback_limit = 4 * 1024 * 1024;            ///< Размер буфера строк недоступного файла
+        QByteArray m_fallback_buf;      ///< Строки, накопленные до открытия файла журнала
+        qint64 m_fallback_dropped = 0;  ///< Объём строк, не поместившихся в буфер
+
+        LoggerRateLimiter m_rate_limiter;       ///< Ограничение частоты сообщений мест вызова
+        bool m_suppress_duplicates = false;     ///< Флаг схлопывания повторяющихся сообщений
+        LoggerRecord *m_last_record = nullptr;  ///< Последнее записанное сообщение
+        std::uint64_t m_repeat_count = 0;       ///< Количество повторов последнего сообщения
+        std::chrono::steady_clock::time_point m_repeat_since;  ///< Время первого невыведенного повтора
+
+        std::uint64_t m_batch_formatted = 0;    ///< Готовых строк в текущей пачке (используется потоком записи)
+        std::atomic<std::uint64_t> m_formatted_written{0};  ///< Обработано готовых строк writeFormatted()
+
+        std::uint32_t m_sample_rate[LoggerLevelsCount];                 ///< Частота выборки для каждого уровня
+        std::atomic<std::uint64_t> m_sample_written[LoggerLevelsCount]; ///< Записано сообщений при выборке
+        std::atomic<std::uint64_t> m_sample_skipped[LoggerLevelsCount]; ///< Пропущено сообщений при выборке
 
-        bool m_awake_to_exit = false;   ///< Флаг завершения потока записи
+        std::atomic<bool> m_awake_to_exit{false};   ///< Флаг завершения потока записи
     };
 
     typedef std::shared_ptr<Logger> LoggerPtr;
@@ -0,0 +1,258 @@
+#include "loggerarchive.h"
+#include "loggerindex.h"
+#include "loggerthread.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <cstring>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+    const int LoggerArchiver::MaxWorkers;
+    const char LoggerArchiver::PartSuffix[] = ".part";
+
+    LoggerArchiver::LoggerArchiver() {}
+
+    LoggerArchiver::~LoggerArchiver() {
+        stop();
+    }
+
+    bool LoggerArchiver::setCompression(LoggerCompression method, int level, int workers) {
+        const bool available = LoggerCompressor::isAvailable(method);
+        m_method = available ? method : LoggerCompression::CompressionNone;
+        m_level = level;
+        m_workers = std::min(std::max(workers, 1), MaxWorkers);
+        return available;
+    }
+
+    void LoggerArchiver::setBlockSize(std::int64_t bytes) {
+        m_block_size = std::max<std::int64_t>(bytes, 64 * 1024);
+    }
+
+    void LoggerArchiver::start(const LoggerThreadOptions &options) {
+        if (!isEnabled() || m_thread.joinable()) {
+            return;
+        }
+        m_options = options;
+        m_stop = false;
+        m_compressors.clear();
+        for (int i = 0; i < m_workers; ++i) {
+            m_compressors.emplace_back(new LoggerCompressor());
+            m_compressors.back()->setMethod(m_method, m_level);
+        }
+        m_thread = std::thread(&LoggerArchiver::run, this);
+        for (int i = 1; i < m_workers; ++i) {
+            m_pool.emplace_back(&LoggerArchiver::work, this, i);
+        }
+    }
+
+    void LoggerArchiver::stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::lock_guard<std::mutex> roundLock(m_round_mutex);
+            m_stop = true;
+            m_queue.clear();
+        }
+        m_cv.notify_all();
+        m_round_cv.notify_all();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        for (std::thread &t : m_pool) {
+            t.join();
+        }
+        m_pool.clear();
+        m_compressors.clear();
+    }
+
+    void LoggerArchiver::enqueue(const QString &path) {
+        if (!isEnabled()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (std::find(m_queue.begin(), m_queue.end(), path) != m_queue.end()) {
+                return;
+            }
+            m_queue.push_back(path);
+        }
+        m_cv.notify_one();
+    }
+
+    std::size_t LoggerArchiver::pending() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.size() + (m_busy ? 1 : 0);
+    }
+
+    void LoggerArchiver::run() {
+        applyThreadOptions(m_options, "-zip");
+        for (;;) {
+            QString path;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_busy = false;
+                m_cv.wait(lock, [this] { return m_stop.load() || !m_queue.empty(); });
+                if (m_stop) {
+                    break;
+                }
+                path = m_queue.front();
+                m_queue.pop_front();
+                m_busy = true;
+            }
+            if (!archive(path) && !m_stop) {
+                qWarning("Cannot compress the log file %s", qPrintable(path));
+            }
+        }
+    }
+
+    void LoggerArchiver::work(int worker) {
+        applyThreadOptions(m_options, "-zip");
+        std::uint64_t seen = 0;
+        for (;;) {
+            std::vector<Block> *round = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_round_mutex);
+                m_round_cv.wait(lock, [&] { return m_stop.load() || (m_round && m_round_seq != seen); });
+                if (m_stop) {
+                    return;
+                }
+                seen = m_round_seq;
+                round = m_round;
+                ++m_active;
+            }
+            const int n = compressBlocks(*round, *m_compressors[worker]);
+            {
+                std::lock_guard<std::mutex> lock(m_round_mutex);
+                m_done += static_cast<std::size_t>(n);
+                --m_active;
+            }
+            m_done_cv.notify_one();
+        }
+    }
+
+    int LoggerArchiver::compressBlocks(std::vector<Block> &blocks, LoggerCompressor &compressor) {
+        int n = 0;
+        for (std::size_t k = m_next.fetch_add(1); k < blocks.size(); k = m_next.fetch_add(1)) {
+            Block &b = blocks[k];
+            b.frame.resize(0);
+            b.ok = compressor.compress(b.data, b.size, b.frame);
+            ++n;
+        }
+        return n;
+    }
+
+    bool LoggerArchiver::compressRound(std::vector<Block> &blocks) {
+        {
+            std::lock_guard<std::mutex> lock(m_round_mutex);
+            m_round = &blocks;
+            m_next = 0;
+            m_done = 0;
+            ++m_round_seq;
+        }
+        m_round_cv.notify_all();
+
+        // Поток очереди сжимает блоки вместе с пулом, а затем дожидается потоков пула,
+        // ещё работающих с блоками раунда
+        const int n = compressBlocks(blocks, *m_compressors[0]);
+        {
+            std::unique_lock<std::mutex> lock(m_round_mutex);
+            m_done += static_cast<std::size_t>(n);
+            m_done_cv.wait(lock, [&] { return m_done == blocks.size() && m_active == 0; });
+            m_round = nullptr;
+        }
+        return std::all_of(blocks.begin(), blocks.end(), [](const Block &b) { return b.ok; });
+    }
+
+    bool LoggerArchiver::archive(const QString &path) {
+        QFile in(path);
+        if (!in.open(QIODevice::ReadOnly)) {
+            // Файл удалён при ограничении количества файлов журнала
+            return !in.exists();
+        }
+        const qint64 size = in.size();
+        const char *data = size > 0 ? reinterpret_cast<const char *>(in.map(0, size)) : nullptr;
+        if (size > 0 && !data) {
+            return false;
+        }
+
+        const QString target = path + suffix();
+        QFile out(target + PartSuffix);
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        auto abort = [&out]() {
+            out.close();
+            out.remove();
+            return false;
+        };
+
+        // Начала блоков в исходном и сжатом файлах для пересчёта индекса
+        std::vector<std::int64_t> plainStarts;
+        std::vector<std::int64_t> frameStarts;
+        std::vector<Block> blocks;
+        const std::size_t window = static_cast<std::size_t>(m_workers) * 4;
+        qint64 pos = 0;
+        qint64 outPos = 0;
+        while (pos < size) {
+            if (m_stop) {
+                return abort();
+            }
+            blocks.clear();
+            while (blocks.size() < window && pos < size) {
+                // Блок заканчивается на границе строки, если она не дальше ещё одного блока
+                qint64 end = std::min(pos + m_block_size, size);
+                if (end < size) {
+                    const qint64 limit = std::min(end + m_block_size, size);
+                    const void *nl = std::memchr(data + end, '\n', static_cast<std::size_t>(limit - end));
+                    end = nl ? static_cast<const char *>(nl) - data + 1 : limit;
+                }
+                blocks.push_back(Block{data + pos, static_cast<int>(end - pos), QByteArray(), false});
+                plainStarts.push_back(pos);
+                pos = end;
+            }
+            if (!compressRound(blocks)) {
+                return abort();
+            }
+            for (const Block &b : blocks) {
+                frameStarts.push_back(outPos);
+                if (out.write(b.frame) != b.frame.size()) {
+                    return abort();
+                }
+                outPos += b.frame.size();
+            }
+        }
+        if (!out.flush()) {
+            return abort();
+        }
+        out.close();
+        in.close();
+
+        std::vector<LoggerIndex::Entry> entries;
+        if (LoggerIndex::read(LoggerIndex::pathFor(path), entries) && !plainStarts.empty()) {
+            for (LoggerIndex::Entry &e : entries) {
+                const auto it = std::upper_bound(plainStarts.begin(), plainStarts.end(), e.offset);
+                e.offset = it == plainStarts.begin() ? 0 : frameStarts[it - plainStarts.begin() - 1];
+            }
+            LoggerIndex::write(LoggerIndex::pathFor(target), entries);
+        }
+
+        if (!QFile::exists(path)) {
+            // Исходный файл удалён во время сжатия
+            QFile::remove(out.fileName());
+            QFile::remove(LoggerIndex::pathFor(target));
+            return true;
+        }
+        QFile::remove(target);
+        if (!QFile::rename(out.fileName(), target)) {
+            QFile::remove(out.fileName());
+            QFile::remove(LoggerIndex::pathFor(target));
+            return false;
+        }
+        QFile::remove(path);
+        QFile::remove(LoggerIndex::pathFor(path));
+        return true;
+    }
+
+}   // End namespace DIRA_3D_GW
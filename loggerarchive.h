@@ -0,0 +1,146 @@
+#ifndef LOGGERARCHIVE_H
+#define LOGGERARCHIVE_H
+
+#include <QtCore/qglobal.h>
+#include <QString>
+#include <QByteArray>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "loggertypes.h"
+#include "loggercompress.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Фоновое сжатие файлов журнала после ротации
+ *  \brief Файлы, переданные enqueue(), сжимаются по очереди отдельным потоком:
+ * файл делится на блоки по границам строк, блоки сжимаются параллельно
+ * ограниченным пулом потоков и записываются по порядку независимыми кадрами
+ * LoggerCompressor в файл "<файл><расширение метода>". Индекс файла журнала
+ * пересчитывается на смещения кадров, поэтому сжатый файл остаётся доступным для
+ * поиска по времени. Исходный файл удаляется после записи сжатого.
+ *     Потоки сжатия запускаются с параметрами, переданными start() (обычно -
+ * политика SchedIdle), а в каждый момент времени в памяти находится не больше
+ * 4 блоков на поток, поэтому сжатие не отнимает процессор и память у приложения и
+ * потока записи журнала.
+ *     При остановке сжатие текущего файла прерывается, недописанный файл удаляется;
+ * несжатые файлы остаются на месте и могут быть переданы повторно.
+ */
+    class LoggerArchiver {
+    public:
+        static const int MaxWorkers = 16;                               ///< Максимальное количество потоков сжатия
+        static const std::int64_t DefaultBlockSize = 1024 * 1024;       ///< Размер блока по умолчанию, байт
+        static const char PartSuffix[];                                 ///< Расширение недописанного сжатого файла
+
+        LoggerArchiver();
+
+        /**
+         * @brief Деструктор
+         * @remark Прерывает сжатие и завершает потоки.
+         */
+        ~LoggerArchiver();
+
+        LoggerArchiver(const LoggerArchiver &) = delete;
+        LoggerArchiver &operator=(const LoggerArchiver &) = delete;
+
+        /**
+         * @brief Установка параметров сжатия
+         * @remark Вызывается до start().
+         *
+         * @param method Метод сжатия. CompressionNone - сжатие отключено
+         * @param level Уровень сжатия. 0 - уровень метода по умолчанию
+         * @param workers Количество потоков сжатия (1..MaxWorkers)
+         * @return true или false если метод не поддерживается сборкой (сжатие отключено)
+         */
+        bool setCompression(LoggerCompression method, int level, int workers);
+
+        /**
+         * @brief Установка размера блока
+         * @param bytes Размер блока, байт (не меньше 64 Кб)
+         */
+        void setBlockSize(std::int64_t bytes);
+
+        /**
+         * @brief Проверка того, что сжатие включено
+         */
+        bool isEnabled() const      {   return m_method != LoggerCompression::CompressionNone; }
+
+        /**
+         * @brief Расширение сжатых файлов
+         */
+        const char *suffix() const  {   return LoggerCompressor::suffix(m_method);  }
+
+        /**
+         * @brief Запуск потоков сжатия
+         * @param options Параметры потоков сжатия
+         */
+        void start(const LoggerThreadOptions &options);
+
+        /**
+         * @brief Остановка потоков сжатия
+         */
+        void stop();
+
+        /**
+         * @brief Постановка файла в очередь сжатия
+         * @param path Путь к файлу журнала
+         */
+        void enqueue(const QString &path);
+
+        /**
+         * @brief Количество файлов, ожидающих сжатия (включая сжимаемый)
+         */
+        std::size_t pending() const;
+
+    private:
+        //! Блок файла
+        struct Block {
+            const char *data;           ///< Начало блока в отображённом файле
+            int size;                   ///< Размер блока, байт
+            QByteArray frame;           ///< Сжатый кадр
+            bool ok;                    ///< Флаг успешного сжатия
+        };
+
+        void run();
+        void work(int worker);
+        bool archive(const QString &path);
+        bool compressRound(std::vector<Block> &blocks);
+        int compressBlocks(std::vector<Block> &blocks, LoggerCompressor &compressor);
+
+        LoggerCompression m_method = LoggerCompression::CompressionNone;   ///< Метод сжатия
+        int m_level = 0;                                ///< Уровень сжатия
+        int m_workers = 1;                              ///< Количество потоков сжатия
+        std::int64_t m_block_size = DefaultBlockSize;   ///< Размер блока, байт
+        LoggerThreadOptions m_options;                  ///< Параметры потоков сжатия
+
+        std::thread m_thread;                           ///< Поток очереди файлов (сжимает вместе с пулом)
+        std::vector<std::thread> m_pool;                ///< Дополнительные потоки сжатия
+        std::vector<std::unique_ptr<LoggerCompressor>> m_compressors;  ///< Контекст сжатия каждого потока
+
+        mutable std::mutex m_mutex;                     ///< Защита очереди файлов
+        std::condition_variable m_cv;                   ///< Уведомление о новых файлах и остановке
+        std::deque<QString> m_queue;                    ///< Очередь файлов
+        bool m_busy = false;                            ///< Файл сжимается
+        std::atomic<bool> m_stop{false};                ///< Флаг остановки
+
+        std::mutex m_round_mutex;                       ///< Защита состояния раунда сжатия
+        std::condition_variable m_round_cv;             ///< Уведомление пула о новом раунде
+        std::condition_variable m_done_cv;              ///< Уведомление о завершении блоков раунда
+        std::vector<Block> *m_round = nullptr;          ///< Блоки текущего раунда
+        std::uint64_t m_round_seq = 0;                  ///< Номер текущего раунда
+        std::atomic<std::size_t> m_next{0};             ///< Следующий блок раунда
+        std::size_t m_done = 0;                         ///< Сжато блоков раунда
+        int m_active = 0;                               ///< Потоков пула, работающих с раундом
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERARCHIVE_H
@@ -0,0 +1,248 @@
+#include "loggerarena.h"
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    std::atomic<std::uint64_t> g_nextSerial(1);     ///< Номер следующего пула
+
+    std::mutex g_arenasMutex;                       ///< Мьютекс списка существующих пулов
+    std::vector<LoggerArena *> g_arenas;            ///< Существующие пулы
+
+    /**
+     * @brief Магазин ячеек одного пула в потоке
+     */
+    struct Magazine {
+        std::uint64_t serial = 0;                       ///< Номер пула (0 - магазин свободен)
+        LoggerArena *arena = nullptr;                   ///< Пул
+        LoggerRecord *items[LoggerArena::ClassesCount][LoggerArena::MagazineSize]; ///< Свободные ячейки классов
+        int count[LoggerArena::ClassesCount] = {};      ///< Количество свободных ячеек классов
+    };
+
+    /**
+     * @brief Возврат ячеек магазина в пул, если пул ещё существует
+     */
+    void flushMagazine(Magazine &mag) {
+        if (mag.serial != 0) {
+            std::lock_guard<std::mutex> lock(g_arenasMutex);
+            for (LoggerArena *arena : g_arenas) {
+                if (arena == mag.arena && arena->serial() == mag.serial) {
+                    for (int c = 0; c < LoggerArena::ClassesCount; ++c) {
+                        if (mag.count[c] != 0) {
+                            arena->returnSlots(c, mag.items[c], mag.count[c]);
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+        mag.serial = 0;
+        mag.arena = nullptr;
+        for (int &count : mag.count) {
+            count = 0;
+        }
+    }
+
+    /**
+     * @brief Магазины потока. Поток может писать в несколько журналов, поэтому
+     * хранится несколько магазинов; при завершении потока ячейки возвращаются в пулы.
+     */
+    struct ThreadMagazines {
+        static const int Count = 4;
+        Magazine mags[Count];
+        int nextVictim = 0;
+
+        ~ThreadMagazines() {
+            for (auto &mag : mags) {
+                flushMagazine(mag);
+            }
+        }
+
+        Magazine &get(LoggerArena *arena) {
+            for (auto &mag : mags) {
+                if (mag.serial == arena->serial()) {
+                    return mag;
+                }
+            }
+            for (auto &mag : mags) {
+                if (mag.serial == 0) {
+                    mag.serial = arena->serial();
+                    mag.arena = arena;
+                    return mag;
+                }
+            }
+            Magazine &victim = mags[nextVictim];
+            nextVictim = (nextVictim + 1) % Count;
+            flushMagazine(victim);
+            victim.serial = arena->serial();
+            victim.arena = arena;
+            return victim;
+        }
+    };
+
+    thread_local ThreadMagazines t_magazines;
+
+}
+
+    LoggerArena::LoggerArena(): m_slotsCount(0)
+                              , m_serial(g_nextSerial.fetch_add(1, std::memory_order_relaxed))
+                              , m_heapAllocations(0)
+    {
+        for (int c = 0; c < ClassesCount; ++c) {
+            m_free[c] = nullptr;
+            m_freeCount[c] = 0;
+        }
+        std::lock_guard<std::mutex> lock(g_arenasMutex);
+        g_arenas.push_back(this);
+    }
+
+    LoggerArena::~LoggerArena() {
+        std::lock_guard<std::mutex> lock(g_arenasMutex);
+        for (auto it = g_arenas.begin(); it != g_arenas.end(); ++it) {
+            if (*it == this) {
+                g_arenas.erase(it);
+                break;
+            }
+        }
+    }
+
+    bool LoggerArena::init(std::uint32_t slotsCount) {
+        if (m_memory || slotsCount == 0) {
+            return false;
+        }
+
+        // Ячеек больших классов в 8 и в 32 раза меньше, чем ячеек класса 0
+        std::uint32_t counts[ClassesCount];
+        std::size_t bytes = 0;
+        for (int c = 0; c < ClassesCount; ++c) {
+            counts[c] = c == 0 ? slotsCount : std::max<std::uint32_t>(1, slotsCount >> (2 * c + 1));
+            bytes += static_cast<std::size_t>(counts[c]) * slotSize(c);
+        }
+        m_memory.reset(new (std::nothrow) char[bytes]);
+        if (!m_memory) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        char *slot = m_memory.get();
+        m_slotsCount = 0;
+        for (int c = 0; c < ClassesCount; ++c) {
+            for (std::uint32_t i = 0; i < counts[c]; ++i, slot += slotSize(c)) {
+                LoggerRecord *rec = new (slot) LoggerRecord();
+                rec->sizeClass = static_cast<std::uint8_t>(c);
+                rec->next = m_free[c];
+                m_free[c] = rec;
+            }
+            m_freeCount[c] = counts[c];
+            m_slotsCount += counts[c];
+        }
+        return true;
+    }
+
+    LoggerRecord *LoggerArena::allocate(std::size_t payload) {
+        if (m_slotsCount == 0 || payload > slotSize(ClassesCount - 1) - sizeof(LoggerRecord)) {
+            return heapAllocate(payload);
+        }
+        int c = 0;
+        while (payload > slotSize(c) - sizeof(LoggerRecord)) {
+            ++c;
+        }
+
+        Magazine &mag = t_magazines.get(this);
+        if (mag.count[c] == 0) {
+            mag.count[c] = takeSlots(c, mag.items[c], MagazineSize);
+            if (mag.count[c] == 0) {
+                return heapAllocate(payload);
+            }
+        }
+
+        LoggerRecord *rec = new (mag.items[c][--mag.count[c]]) LoggerRecord();
+        rec->capacity = slotSize(c) - sizeof(LoggerRecord);
+        rec->sizeClass = static_cast<std::uint8_t>(c);
+        return rec;
+    }
+
+    LoggerRecord *LoggerArena::heapAllocate(std::size_t payload) {
+        m_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        void *mem = ::operator new(sizeof(LoggerRecord) + payload);
+        LoggerRecord *rec = new (mem) LoggerRecord();
+        rec->capacity = static_cast<std::uint32_t>(payload);
+        rec->fromHeap = true;
+        return rec;
+    }
+
+    void LoggerArena::release(LoggerRecord *chain) {
+        LoggerRecord *head[ClassesCount] = {};
+        LoggerRecord *tail[ClassesCount] = {};
+        std::uint32_t count[ClassesCount] = {};
+        bool any = false;
+
+        while (chain) {
+            LoggerRecord *rec = chain;
+            chain = chain->next;
+            if (rec->fromHeap) {
+                ::operator delete(rec);
+                continue;
+            }
+            const int c = rec->sizeClass;
+            rec->next = head[c];
+            head[c] = rec;
+            if (!tail[c]) {
+                tail[c] = rec;
+            }
+            ++count[c];
+            any = true;
+        }
+
+        if (any) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (int c = 0; c < ClassesCount; ++c) {
+                if (head[c]) {
+                    tail[c]->next = m_free[c];
+                    m_free[c] = head[c];
+                    m_freeCount[c] += count[c];
+                }
+            }
+        }
+    }
+
+    void LoggerArena::returnSlots(int sizeClass, LoggerRecord **items, int count) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int i = 0; i < count; ++i) {
+            items[i]->next = m_free[sizeClass];
+            m_free[sizeClass] = items[i];
+        }
+        m_freeCount[sizeClass] += static_cast<std::uint32_t>(count);
+    }
+
+    int LoggerArena::takeSlots(int sizeClass, LoggerRecord **items, int count) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        int n = 0;
+        while (n < count && m_free[sizeClass]) {
+            items[n++] = m_free[sizeClass];
+            m_free[sizeClass] = m_free[sizeClass]->next;
+        }
+        m_freeCount[sizeClass] -= static_cast<std::uint32_t>(n);
+        return n;
+    }
+
+    LoggerArenaStats LoggerArena::stats() const {
+        LoggerArenaStats stats;
+        stats.slots = m_slotsCount;
+        stats.slotSize = SlotSize;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (int c = 0; c < ClassesCount; ++c) {
+                stats.freeSlots += m_freeCount[c];
+            }
+        }
+        stats.heapAllocations = m_heapAllocations.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+}   // End namespace DIRA_3D_GW
@@ -0,0 +1,119 @@
+#ifndef LOGGERARENA_H
+#define LOGGERARENA_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "loggertypes.h"
+#include "loggerrecord.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Пул записей очереди сообщений
+ *  \brief Выделяет записи LoggerRecord из заранее выделенного блока памяти, разбитого
+ * на ячейки трёх классов размера: SlotSize, 4 * SlotSize и 16 * SlotSize байт.
+ * Запись размещается в ячейке наименьшего подходящего класса. Ячеек класса 0 столько,
+ * сколько задано при инициализации, следующих классов - в 8 и в 32 раза меньше:
+ * короткие сообщения (до ~150 символов ASCII) встречаются много чаще длинных.
+ *     Каждый поток-источник сообщений получает ячейки из собственного магазина
+ * (thread local кеша из MagazineSize ячеек каждого класса), который пополняется из
+ * общего списка свободных ячеек пачками под мьютексом. Поток записи возвращает
+ * обработанные записи в общий список одной операцией на пачку сообщений. Поэтому в
+ * установившемся режиме запись сообщения не требует обращения к malloc/free.
+ *     Записи, не помещающиеся в ячейку наибольшего класса, а так же записи, для
+ * которых не нашлось свободной ячейки, выделяются в куче и освобождаются потоком
+ * записи.
+ */
+    class LoggerArena {
+    public:
+        static const std::uint32_t SlotSize = 256;      ///< Размер ячейки класса 0 (заголовок и данные записи), байт
+        static const int ClassesCount = 3;              ///< Количество классов размера ячеек
+        static const int MagazineSize = 32;             ///< Количество ячеек класса в магазине потока
+
+        /**
+         * @brief Размер ячейки класса
+         * @param sizeClass Класс размера (0 .. ClassesCount - 1)
+         */
+        static std::uint32_t slotSize(int sizeClass)    {   return SlotSize << (2 * sizeClass);     }
+
+        LoggerArena();
+
+        /**
+         * @brief Деструктор
+         * @remark Все записи, выделенные из пула, должны быть освобождены до вызова.
+         */
+        ~LoggerArena();
+
+        LoggerArena(const LoggerArena &) = delete;
+        LoggerArena &operator=(const LoggerArena &) = delete;
+
+        /**
+         * @brief Выделение блока памяти пула
+         * @remark Вызывается один раз при инициализации объекта ведения журнала. Если
+         * пул не инициализирован, все записи выделяются в куче.
+         *
+         * @param slotsCount Количество ячеек класса 0 (ячеек классов 1 и 2 - в 8 и в 32
+         * раза меньше, но не меньше одной)
+         * @return true если память выделена или false в случае ошибок
+         */
+        bool init(std::uint32_t slotsCount);
+
+        /**
+         * @brief Выделение записи
+         *
+         * @param payload Требуемый размер области данных записи, байт
+         * @return Указатель на запись с инициализированным заголовком
+         */
+        LoggerRecord *allocate(std::size_t payload);
+
+        /**
+         * @brief Освобождение списка записей, связанных через LoggerRecord::next
+         *
+         * @param chain Первая запись списка
+         */
+        void release(LoggerRecord *chain);
+
+        /**
+         * @brief Статистика использования пула
+         */
+        LoggerArenaStats stats() const;
+
+        /**
+         * @brief Возврат ячеек магазина потока в общий список свободных ячеек класса
+         * @private
+         */
+        void returnSlots(int sizeClass, LoggerRecord **items, int count);
+
+        /**
+         * @brief Получение пачки ячеек класса из общего списка для магазина потока
+         * @private
+         * @return Количество полученных ячеек
+         */
+        int takeSlots(int sizeClass, LoggerRecord **items, int count);
+
+        /**
+         * @brief Уникальный (не используемый повторно) номер пула
+         * @private
+         */
+        std::uint64_t serial() const    {   return m_serial;    }
+
+    private:
+        LoggerRecord *heapAllocate(std::size_t payload);
+
+        std::unique_ptr<char[]> m_memory;       ///< Блок памяти ячеек
+        std::uint32_t m_slotsCount;             ///< Количество ячеек всех классов
+        std::uint64_t m_serial;                 ///< Номер пула
+
+        mutable std::mutex m_mutex;                     ///< Мьютекс общих списков свободных ячеек
+        LoggerRecord *m_free[ClassesCount];             ///< Общие списки свободных ячеек классов
+        std::uint32_t m_freeCount[ClassesCount];        ///< Количество ячеек в общих списках
+
+        std::atomic<std::uint64_t> m_heapAllocations;   ///< Количество записей, выделенных в куче
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERARENA_H
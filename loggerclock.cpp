@@ -0,0 +1,119 @@
+#include "loggerclock.h"
+
+#include <thread>
+
+#if defined(LOGGER_HAVE_TSC)
+#include <cpuid.h>
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    /**
+     * @brief Проверка того, что частота счётчика тактов не зависит от частоты и
+     * состояния энергосбережения процессора (CPUID 0x80000007, EDX бит 8)
+     */
+    bool invariant_tsc() {
+#if defined(LOGGER_HAVE_TSC)
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+        return (edx & (1u << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+}
+
+    LoggerClock::LoggerClock(): m_source(LoggerClockSource::ClockRealtime)
+                              , m_rate(0)
+                              , m_anchorRaw(0)
+                              , m_anchorWall(0)
+                              , m_firstRaw(0)
+                              , m_firstWall(0)
+                              , m_nextCalibration(0)
+    {}
+
+    bool LoggerClock::setSource(LoggerClockSource source) {
+        m_rate = 0;
+        if (source == LoggerClockSource::ClockTsc && !invariant_tsc()) {
+            m_source = LoggerClockSource::ClockMonotonicRaw;
+            return false;
+        }
+        m_source = source;
+        return true;
+    }
+
+    void LoggerClock::sample(std::int64_t &raw, std::int64_t &wall) const {
+        // Системное время читается между двумя показаниями источника, соответствие
+        // относится к середине интервала
+        const std::int64_t before = now();
+        wall = wallNow();
+        const std::int64_t after = now();
+        raw = before + (after - before) / 2;
+    }
+
+    void LoggerClock::calibrate() {
+        if (m_source == LoggerClockSource::ClockRealtime) {
+            return;
+        }
+
+        std::int64_t raw;
+        std::int64_t wall;
+        if (m_rate == 0) {
+            sample(raw, wall);
+            m_rate = 1.0;
+            if (m_source == LoggerClockSource::ClockTsc) {
+                std::int64_t raw0 = raw;
+                std::int64_t wall0 = wall;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                sample(raw, wall);
+                if (raw > raw0 && wall > wall0) {
+                    m_rate = static_cast<double>(wall - wall0) / static_cast<double>(raw - raw0);
+                }
+            }
+            m_firstRaw = m_anchorRaw = raw;
+            m_firstWall = m_anchorWall = wall;
+        } else {
+            if (now() < m_nextCalibration) {
+                return;
+            }
+            sample(raw, wall);
+
+            const std::int64_t predicted = toWall(raw);
+            const std::int64_t error = wall - predicted;
+            if (error > CalibrationPeriodNs || error < -CalibrationPeriodNs) {
+                // Системное время переставлено - новое соответствие без подстройки
+                m_firstRaw = m_anchorRaw = raw;
+                m_firstWall = m_anchorWall = wall;
+            } else {
+                // Средний ход источника за всё время работы и плавная компенсация
+                // накопленного расхождения в течение следующего периода
+                double slew = static_cast<double>(error) / static_cast<double>(period());
+                slew = slew > 0.001 ? 0.001 : (slew < -0.001 ? -0.001 : slew);
+                if (raw > m_firstRaw) {
+                    m_rate = static_cast<double>(wall - m_firstWall) / static_cast<double>(raw - m_firstRaw);
+                }
+                m_rate *= 1.0 + slew;
+                m_anchorRaw = raw;
+                m_anchorWall = predicted;
+            }
+        }
+        m_nextCalibration = raw + static_cast<std::int64_t>(static_cast<double>(period()) / m_rate);
+    }
+
+    std::int64_t LoggerClock::period() const {
+        // Пока ход источника измерен на коротком интервале, соответствие уточняется
+        // чаще: период растёт вместе с интервалом измерения до CalibrationPeriodNs
+        const std::int64_t measured = m_anchorWall - m_firstWall;
+        if (measured >= CalibrationPeriodNs) {
+            return CalibrationPeriodNs;
+        }
+        return measured > MinCalibrationPeriodNs ? measured : MinCalibrationPeriodNs;
+    }
+
+}   // End namespace DIRA_3D_GW
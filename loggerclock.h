@@ -0,0 +1,126 @@
+#ifndef LOGGERCLOCK_H
+#define LOGGERCLOCK_H
+
+#include <QtCore/qglobal.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "loggertypes.h"
+
+#if defined(Q_OS_LINUX)
+#include <time.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define LOGGER_HAVE_TSC
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Источник времени сообщений журнала
+ *  \brief Потоки-источники сообщений сохраняют в записи только показание выбранного
+ * источника времени (счётчик тактов процессора, CLOCK_MONOTONIC_RAW или системное
+ * время), без перевода в дату и часовой пояс. Поток записи переводит показания в
+ * системное время (нс от начала эпохи) по линейному соответствию, которое
+ * уточняется не реже раза в секунду (CalibrationPeriodNs).
+ *     При уточнении соответствие подстраивается плавно (не более 0.1% хода), поэтому
+ * время записей остаётся монотонным. Скачок системного времени больше секунды
+ * (ручная установка часов) переносится в журнал сразу.
+ *     Метод now() вызывается потоками-источниками, остальные методы - только потоком
+ * записи.
+ */
+    class LoggerClock {
+    public:
+        static const std::int64_t CalibrationPeriodNs = 1000000000;    ///< Период уточнения соответствия, нс
+        static const std::int64_t MinCalibrationPeriodNs = 50000000;   ///< Начальный период уточнения соответствия, нс
+
+        LoggerClock();
+
+        /**
+         * @brief Установка источника времени
+         * @remark Вызывается до запуска потока записи. Если источник не поддерживается
+         * (нет инвариантного TSC, не Linux), используется ближайший доступный.
+         *
+         * @param source Источник времени
+         * @return true если установлен запрошенный источник или false если
+         * используется замена
+         */
+        bool setSource(LoggerClockSource source);
+
+        /**
+         * @brief Текущий источник времени
+         */
+        LoggerClockSource source() const    {   return m_source;    }
+
+        /**
+         * @brief Показание источника времени
+         */
+        std::int64_t now() const {
+            switch (m_source) {
+#if defined(LOGGER_HAVE_TSC)
+            case LoggerClockSource::ClockTsc:
+                return static_cast<std::int64_t>(__rdtsc());
+#endif
+            case LoggerClockSource::ClockMonotonicRaw: {
+#if defined(Q_OS_LINUX)
+                struct timespec ts;
+                clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+                return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+            }
+            default:
+                return wallNow();
+            }
+        }
+
+        /**
+         * @brief Уточнение соответствия показаний источника системному времени
+         * @remark Вызывается потоком записи перед обработкой каждой пачки сообщений;
+         * соответствие пересчитывается не чаще раза в CalibrationPeriodNs. Первый
+         * вызов для счётчика тактов измеряет его частоту (~10 мс).
+         */
+        void calibrate();
+
+        /**
+         * @brief Перевод показания источника в системное время
+         *
+         * @param stamp Показание источника времени
+         * @return Время, нс от начала эпохи
+         */
+        std::int64_t toWall(std::int64_t stamp) const {
+            if (m_source == LoggerClockSource::ClockRealtime) {
+                return stamp;
+            }
+            return m_anchorWall + static_cast<std::int64_t>(static_cast<double>(stamp - m_anchorRaw) * m_rate);
+        }
+
+        /**
+         * @brief Системное время, нс от начала эпохи
+         */
+        static std::int64_t wallNow() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+    private:
+        void sample(std::int64_t &raw, std::int64_t &wall) const;
+        std::int64_t period() const;
+
+        LoggerClockSource m_source;     ///< Источник времени
+        double m_rate;                  ///< Наносекунд на единицу показания источника (0 - не откалиброван)
+        std::int64_t m_anchorRaw;       ///< Показание источника в точке соответствия
+        std::int64_t m_anchorWall;      ///< Системное время в точке соответствия
+        std::int64_t m_firstRaw;        ///< Показание источника при первой калибровке
+        std::int64_t m_firstWall;       ///< Системное время при первой калибровке
+        std::int64_t m_nextCalibration; ///< Показание источника для следующего уточнения
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERCLOCK_H
@@ -0,0 +1,193 @@
+#include "loggercompress.h"
+
+#include <algorithm>
+#include <cstring>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    // Заголовок члена gzip с полем FEXTRA: ID1 ID2 CM FLG MTIME(4) XFL OS XLEN(2),
+    // далее поле "QL" длиной 4 байта с размером кадра
+    const int GzipHeaderSize = 20;
+    const int GzipTrailerSize = 8;
+    const unsigned char GzipFlagExtra = 0x04;
+
+    void put_le32(char *p, std::uint32_t value) {
+        p[0] = static_cast<char>(value & 0xFF);
+        p[1] = static_cast<char>((value >> 8) & 0xFF);
+        p[2] = static_cast<char>((value >> 16) & 0xFF);
+        p[3] = static_cast<char>((value >> 24) & 0xFF);
+    }
+
+    std::uint32_t get_le32(const char *p) {
+        const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+        return static_cast<std::uint32_t>(u[0]) | (static_cast<std::uint32_t>(u[1]) << 8)
+                | (static_cast<std::uint32_t>(u[2]) << 16) | (static_cast<std::uint32_t>(u[3]) << 24);
+    }
+
+}
+
+    LoggerCompressor::LoggerCompressor() {
+#if defined(LOGGER_ZLIB)
+        std::memset(&m_zstream, 0, sizeof(m_zstream));
+#endif
+    }
+
+    LoggerCompressor::~LoggerCompressor() {
+        release();
+    }
+
+    void LoggerCompressor::release() {
+#if defined(LOGGER_ZLIB)
+        if (m_zstreamInit) {
+            deflateEnd(&m_zstream);
+            m_zstreamInit = false;
+        }
+#endif
+#if defined(LOGGER_ZSTD)
+        ZSTD_freeCCtx(m_zstd);
+        m_zstd = nullptr;
+#endif
+    }
+
+    bool LoggerCompressor::isAvailable(LoggerCompression method) {
+        switch (method) {
+        case LoggerCompression::CompressionNone:
+            return true;
+        case LoggerCompression::CompressionGzip:
+#if defined(LOGGER_ZLIB)
+            return true;
+#else
+            return false;
+#endif
+        case LoggerCompression::CompressionZstd:
+#if defined(LOGGER_ZSTD)
+            return true;
+#else
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    const char *LoggerCompressor::suffix(LoggerCompression method) {
+        switch (method) {
+        case LoggerCompression::CompressionGzip:   return ".gz";
+        case LoggerCompression::CompressionZstd:   return ".zst";
+        case LoggerCompression::CompressionNone:   break;
+        }
+        return "";
+    }
+
+    bool LoggerCompressor::setMethod(LoggerCompression method, int level) {
+        release();
+        m_method = LoggerCompression::CompressionNone;
+        m_level = level;
+        if (!isAvailable(method)) {
+            return false;
+        }
+#if defined(LOGGER_ZLIB)
+        if (method == LoggerCompression::CompressionGzip) {
+            // Сырой deflate: заголовок и контрольная сумма члена gzip формируются в compress()
+            if (deflateInit2(&m_zstream, level > 0 ? std::min(level, 9) : Z_DEFAULT_COMPRESSION,
+                             Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                return false;
+            }
+            m_zstreamInit = true;
+        }
+#endif
+#if defined(LOGGER_ZSTD)
+        if (method == LoggerCompression::CompressionZstd) {
+            m_zstd = ZSTD_createCCtx();
+            if (!m_zstd) {
+                return false;
+            }
+            ZSTD_CCtx_setParameter(m_zstd, ZSTD_c_compressionLevel, level > 0 ? level : ZSTD_CLEVEL_DEFAULT);
+            ZSTD_CCtx_setParameter(m_zstd, ZSTD_c_checksumFlag, 1);
+        }
+#endif
+        m_method = method;
+        return true;
+    }
+
+    bool LoggerCompressor::compress(const char *data, int size, QByteArray &dst) {
+#if defined(LOGGER_ZLIB) || defined(LOGGER_ZSTD)
+        const int start = dst.size();
+#else
+        Q_UNUSED(data);
+        Q_UNUSED(size);
+        Q_UNUSED(dst);
+#endif
+#if defined(LOGGER_ZLIB)
+        if (m_method == LoggerCompression::CompressionGzip) {
+            if (deflateReset(&m_zstream) != Z_OK) {
+                return false;
+            }
+            const uLong bound = deflateBound(&m_zstream, static_cast<uLong>(size));
+            dst.resize(start + GzipHeaderSize + static_cast<int>(bound) + GzipTrailerSize);
+            char *out = dst.data() + start;
+
+            const unsigned char header[16] = {
+                0x1F, 0x8B, Z_DEFLATED, GzipFlagExtra,
+                0, 0, 0, 0,     // MTIME не указывается
+                0, 255,         // XFL, OS - неизвестна
+                8, 0,           // XLEN
+                'Q', 'L', 4, 0  // Поле размера кадра
+            };
+            std::memcpy(out, header, sizeof(header));
+
+            m_zstream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+            m_zstream.avail_in = static_cast<uInt>(size);
+            m_zstream.next_out = reinterpret_cast<Bytef *>(out + GzipHeaderSize);
+            m_zstream.avail_out = static_cast<uInt>(bound);
+            if (deflate(&m_zstream, Z_FINISH) != Z_STREAM_END) {
+                dst.resize(start);
+                return false;
+            }
+            const int compressed = static_cast<int>(bound - m_zstream.avail_out);
+            const int frame = GzipHeaderSize + compressed + GzipTrailerSize;
+            put_le32(out + 16, static_cast<std::uint32_t>(frame));
+            put_le32(out + GzipHeaderSize + compressed,
+                     static_cast<std::uint32_t>(crc32(crc32(0L, Z_NULL, 0),
+                                                      reinterpret_cast<const Bytef *>(data),
+                                                      static_cast<uInt>(size))));
+            put_le32(out + GzipHeaderSize + compressed + 4, static_cast<std::uint32_t>(size));
+            dst.resize(start + frame);
+            return true;
+        }
+#endif
+#if defined(LOGGER_ZSTD)
+        if (m_method == LoggerCompression::CompressionZstd) {
+            const std::size_t bound = ZSTD_compressBound(static_cast<std::size_t>(size));
+            dst.resize(start + static_cast<int>(bound));
+            const std::size_t written = ZSTD_compress2(m_zstd, dst.data() + start, bound,
+                                                       data, static_cast<std::size_t>(size));
+            if (ZSTD_isError(written)) {
+                dst.resize(start);
+                return false;
+            }
+            dst.resize(start + static_cast<int>(written));
+            return true;
+        }
+#endif
+        return false;
+    }
+
+    std::int64_t LoggerCompressor::frameSize(const char *data, std::int64_t size) {
+        const unsigned char *u = reinterpret_cast<const unsigned char *>(data);
+        if (size >= GzipHeaderSize && u[0] == 0x1F && u[1] == 0x8B && (u[3] & GzipFlagExtra)
+                && u[12] == 'Q' && u[13] == 'L' && u[14] == 4 && u[15] == 0) {
+            const std::int64_t frame = get_le32(data + 16);
+            return frame >= GzipHeaderSize + GzipTrailerSize && frame <= size ? frame : 0;
+        }
+#if defined(LOGGER_ZSTD)
+        const std::size_t frame = ZSTD_findFrameCompressedSize(data, static_cast<std::size_t>(size));
+        return ZSTD_isError(frame) ? 0 : static_cast<std::int64_t>(frame);
+#else
+        return 0;
+#endif
+    }
+
+}   // End namespace DIRA_3D_GW
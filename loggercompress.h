@@ -0,0 +1,107 @@
+#ifndef LOGGERCOMPRESS_H
+#define LOGGERCOMPRESS_H
+
+#include <QtCore/qglobal.h>
+#include <QByteArray>
+
+#include <cstdint>
+
+#include "loggertypes.h"
+
+#if defined(LOGGER_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(LOGGER_ZSTD)
+#include <zstd.h>
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Сжатие журнала независимыми кадрами
+ *  \brief Каждый вызов compress() сжимает блок строк в отдельный кадр, который
+ * распаковывается без предыдущих кадров. Файл из последовательности кадров
+ * читается стандартными программами (zcat, zstdcat), а после аварийного завершения
+ * остаётся читаемым до последнего полностью записанного кадра.
+ *     Кадр gzip - отдельный член gzip (RFC 1952) с дополнительным полем "QL",
+ * содержащим полный размер кадра (4 байта, little-endian), поэтому границы кадров
+ * находятся без распаковки (см. frameSize()). Кадр zstd хранит свой размер сам.
+ *     Поддержка методов определяется при сборке: gzip - LOGGER_ZLIB, zstd -
+ * LOGGER_ZSTD.
+ */
+    class LoggerCompressor {
+    public:
+        LoggerCompressor();
+        ~LoggerCompressor();
+
+        LoggerCompressor(const LoggerCompressor &) = delete;
+        LoggerCompressor &operator=(const LoggerCompressor &) = delete;
+
+        /**
+         * @brief Установка метода сжатия
+         * @param method Метод сжатия
+         * @param level Уровень сжатия. 0 - уровень метода по умолчанию
+         * @return true или false если метод не поддерживается сборкой (сжатие отключено)
+         */
+        bool setMethod(LoggerCompression method, int level = 0);
+
+        /**
+         * @brief Метод сжатия
+         */
+        LoggerCompression method() const   {   return m_method;    }
+
+        /**
+         * @brief Проверка того, что сжатие включено
+         */
+        bool isActive() const       {   return m_method != LoggerCompression::CompressionNone;  }
+
+        /**
+         * @brief Расширение файлов, сжатых методом (".gz", ".zst" или пустая строка)
+         */
+        const char *suffix() const  {   return suffix(m_method);    }
+
+        /**
+         * @brief Сжатие блока в один кадр
+         * @param data Данные блока
+         * @param size Размер блока, байт
+         * @param dst Буфер, в конец которого добавляется кадр
+         * @return true или false в случае ошибки сжатия (dst не изменяется)
+         */
+        bool compress(const char *data, int size, QByteArray &dst);
+
+        /**
+         * @brief Проверка поддержки метода сжатия сборкой
+         */
+        static bool isAvailable(LoggerCompression method);
+
+        /**
+         * @brief Расширение файлов, сжатых методом
+         */
+        static const char *suffix(LoggerCompression method);
+
+        /**
+         * @brief Размер кадра, начинающегося с data
+         * @param data Начало кадра
+         * @param size Количество доступных байт
+         * @return Размер кадра или 0, если кадр неполный или не распознан
+         */
+        static std::int64_t frameSize(const char *data, std::int64_t size);
+
+    private:
+        void release();
+
+        LoggerCompression m_method = LoggerCompression::CompressionNone;   ///< Метод сжатия
+        int m_level = 0;                                                    ///< Уровень сжатия
+#if defined(LOGGER_ZLIB)
+        z_stream m_zstream;             ///< Состояние deflate (сбрасывается для каждого кадра)
+        bool m_zstreamInit = false;     ///< Флаг инициализации m_zstream
+#endif
+#if defined(LOGGER_ZSTD)
+        ZSTD_CCtx *m_zstd = nullptr;    ///< Контекст сжатия zstd
+#endif
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERCOMPRESS_H
@@ -0,0 +1,465 @@
+#include "loggerconfig.h"
+#include "loggerformatter.h"
+#include "loggersyslog.h"
+
+#include <QFile>
+#include <QSettings>
+#include <QVariant>
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+#include <QTextCodec>
+#endif
+
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    template <class T>
+    struct NamedValue {
+        const char *name;
+        T value;
+    };
+
+    const NamedValue<LoggerLevel> LevelNames[] = {
+        {"System", System}, {"Critical", Critical}, {"Error", Error}, {"Warning", Warning},
+        {"Info", Info}, {"Debug", Debug}, {"Developer", Developer}
+    };
+
+    const NamedValue<LoggerFormat> FormatNames[] = {
+        {"Text", Text}, {"Json", JsonLines}, {"JsonLines", JsonLines}, {"Logfmt", Logfmt}
+    };
+
+    const NamedValue<LoggerDurability> DurabilityNames[] = {
+        {"Flush", Flush}, {"GroupCommit", GroupCommit}, {"CriticalSync", CriticalSync},
+        {"Critical", CriticalSync}, {"FullSync", FullSync}, {"Full", FullSync}
+    };
+
+    const NamedValue<LoggerCompression> CompressionNames[] = {
+        {"None", CompressionNone}, {"Gzip", CompressionGzip}, {"Gz", CompressionGzip},
+        {"Zstd", CompressionZstd}
+    };
+
+    const NamedValue<LoggerClockSource> ClockNames[] = {
+        {"Realtime", ClockRealtime}, {"MonotonicRaw", ClockMonotonicRaw}, {"Tsc", ClockTsc}
+    };
+
+    const NamedValue<LoggerSchedPolicy> PolicyNames[] = {
+        {"Normal", SchedNormal}, {"Batch", SchedBatch}, {"Idle", SchedIdle}
+    };
+
+    const NamedValue<LoggerOpenMode> OpenModeNames[] = {
+        {"Deferred", OpenDeferred}, {"Sync", OpenSync}
+    };
+
+    const NamedValue<bool> BoolNames[] = {
+        {"true", true}, {"false", false}, {"yes", true}, {"no", false},
+        {"on", true}, {"off", false}, {"1", true}, {"0", false}
+    };
+
+    const NamedValue<std::int64_t> SizeUnits[] = {
+        {"", 1}, {"B", 1},
+        {"K", 1LL << 10}, {"KB", 1LL << 10}, {"KiB", 1LL << 10},
+        {"M", 1LL << 20}, {"MB", 1LL << 20}, {"MiB", 1LL << 20},
+        {"G", 1LL << 30}, {"GB", 1LL << 30}, {"GiB", 1LL << 30},
+        {"T", 1LL << 40}, {"TB", 1LL << 40}, {"TiB", 1LL << 40}
+    };
+
+    const NamedValue<std::int64_t> DurationUnits[] = {
+        {"ns", 1LL}, {"us", 1000LL}, {"ms", 1000000LL}, {"s", 1000000000LL},
+        {"min", 60 * 1000000000LL}, {"h", 3600 * 1000000000LL}, {"d", 86400 * 1000000000LL}
+    };
+
+    //! Ключи, читаемые LoggerConfig (кроме SampleRate<Уровень>)
+    const char *const KnownKeys[] = {
+        "LogFolder", "LogFileName", "LogLevel", "MaxLogFileSize", "MaxFilesCount",
+        "LogFormat", "LogPattern", "SourceFullPath", "RateLimit", "RateLimitBurst", "SuppressDuplicates",
+        "WriterBatchWindow", "WriterBatchWindowUs", "ArenaSize", "AsyncIo", "TailBuffer",
+        "TailSocket", "ThreadFields", "ClockSource", "WriterCpus", "WriterPolicy",
+        "WriterNice", "WriterThreadName", "WriterNumaLocal", "IndexInterval",
+        "PreallocateExtent", "Durability", "SyncInterval", "SyncIntervalMs", "Compression",
+        "CompressionLevel", "ArchiveCompression", "ArchiveCompressionLevel", "ArchiveWorkers",
+        "BatchChecksum", "OpenMode", "FallbackBuffer", "SharedMemorySink", "SharedMemorySize",
+        "SyslogSocket", "SyslogAppName", "SyslogFacility", "WatchConfig"
+    };
+
+    const char SampleRatePrefix[] = "SampleRate";
+
+    bool is_space(QChar c) {
+        return c.unicode() == ' ' || c.unicode() == '\t';
+    }
+
+    /**
+     * @brief Удаление пробелов в начале и в конце диапазона [begin, end)
+     */
+    void trim(const QChar *&begin, const QChar *&end) {
+        while (begin < end && is_space(*begin)) {
+            ++begin;
+        }
+        while (end > begin && is_space(end[-1])) {
+            --end;
+        }
+    }
+
+    /**
+     * @brief Сравнение диапазона символов с ASCII строкой без учёта регистра
+     */
+    bool equals_nocase(const QChar *begin, const QChar *end, const char *name) {
+        const std::size_t n = std::strlen(name);
+        if (static_cast<std::size_t>(end - begin) != n) {
+            return false;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            ushort a = begin[i].unicode();
+            ushort b = static_cast<unsigned char>(name[i]);
+            if (a >= 'A' && a <= 'Z') {
+                a = static_cast<ushort>(a - 'A' + 'a');
+            }
+            if (b >= 'A' && b <= 'Z') {
+                b = static_cast<ushort>(b - 'A' + 'a');
+            }
+            if (a != b) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <class T, std::size_t N>
+    bool lookup(const NamedValue<T> (&table)[N], const QChar *begin, const QChar *end, T &value) {
+        trim(begin, end);
+        for (const NamedValue<T> &entry : table) {
+            if (equals_nocase(begin, end, entry.name)) {
+                value = entry.value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <class T, std::size_t N>
+    bool lookup(const NamedValue<T> (&table)[N], const QString &text, T &value) {
+        return lookup(table, text.constData(), text.constData() + text.size(), value);
+    }
+
+    /**
+     * @brief Разбор неотрицательного числа с единицей измерения
+     * @remark Дробная часть учитывается с точностью до 6 знаков.
+     *
+     * @param units Таблица единиц (множителей)
+     * @param defaultUnit Множитель числа без единицы (0 - единица обязательна)
+     * @param result Значение в минимальных единицах
+     */
+    template <std::size_t N>
+    bool parse_scaled(const QString &text, const NamedValue<std::int64_t> (&units)[N],
+                      std::int64_t defaultUnit, std::int64_t &result) {
+        const std::uint64_t max = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+        const QChar *p = text.constData();
+        const QChar *end = p + text.size();
+        trim(p, end);
+
+        std::uint64_t whole = 0;
+        std::uint64_t frac = 0;
+        std::uint64_t scale = 1;
+        int digits = 0;
+        for (; p < end && p->unicode() >= '0' && p->unicode() <= '9'; ++p, ++digits) {
+            const std::uint64_t d = p->unicode() - '0';
+            if (whole > (max - d) / 10) {
+                return false;
+            }
+            whole = whole * 10 + d;
+        }
+        if (p < end && p->unicode() == '.') {
+            for (++p; p < end && p->unicode() >= '0' && p->unicode() <= '9'; ++p, ++digits) {
+                if (scale < 1000000) {
+                    frac = frac * 10 + (p->unicode() - '0');
+                    scale *= 10;
+                }
+            }
+        }
+        if (digits == 0) {
+            return false;
+        }
+        while (p < end && is_space(*p)) {
+            ++p;
+        }
+
+        std::int64_t unit = 0;
+        if (p == end) {
+            unit = defaultUnit;
+        } else if (!lookup(units, p, end, unit)) {
+            return false;
+        }
+        if (unit <= 0) {
+            return false;
+        }
+        const std::uint64_t mult = static_cast<std::uint64_t>(unit);
+        if (whole > max / mult) {
+            return false;
+        }
+        const std::uint64_t value = whole * mult;
+        // frac < scale, поэтому ни одно из произведений не переполняется
+        const std::uint64_t fraction = mult / scale * frac + mult % scale * frac / scale;
+        if (value > max - fraction) {
+            return false;
+        }
+        result = static_cast<std::int64_t>(value + fraction);
+        return true;
+    }
+
+    /**
+     * @brief Значение ключа строкой
+     * @remark QSettings возвращает значение с запятыми как список строк - он
+     * собирается обратно.
+     */
+    QString text_value(const QSettings &sett, const QString &key) {
+        return sett.value(key).toStringList().join(',').trimmed();
+    }
+
+}
+
+    bool LoggerConfig::parseLevel(const QString &text, LoggerLevel &value) {
+        return lookup(LevelNames, text, value);
+    }
+
+    bool LoggerConfig::parseFormat(const QString &text, LoggerFormat &value) {
+        return lookup(FormatNames, text, value);
+    }
+
+    bool LoggerConfig::parseDurability(const QString &text, LoggerDurability &value) {
+        return lookup(DurabilityNames, text, value);
+    }
+
+    bool LoggerConfig::parseCompression(const QString &text, LoggerCompression &value) {
+        return lookup(CompressionNames, text, value);
+    }
+
+    bool LoggerConfig::parseClockSource(const QString &text, LoggerClockSource &value) {
+        return lookup(ClockNames, text, value);
+    }
+
+    bool LoggerConfig::parseSchedPolicy(const QString &text, LoggerSchedPolicy &value) {
+        return lookup(PolicyNames, text, value);
+    }
+
+    bool LoggerConfig::parseOpenMode(const QString &text, LoggerOpenMode &value) {
+        return lookup(OpenModeNames, text, value);
+    }
+
+    bool LoggerConfig::parseBool(const QString &text, bool &value) {
+        return lookup(BoolNames, text, value);
+    }
+
+    bool LoggerConfig::parseSize(const QString &text, std::int64_t &bytes) {
+        return parse_scaled(text, SizeUnits, 1, bytes);
+    }
+
+    bool LoggerConfig::parseDuration(const QString &text, std::chrono::nanoseconds &value,
+                                     std::chrono::nanoseconds unit) {
+        std::int64_t ns;
+        if (!parse_scaled(text, DurationUnits, static_cast<std::int64_t>(unit.count()), ns)) {
+            return false;
+        }
+        value = std::chrono::nanoseconds(ns);
+        return true;
+    }
+
+    bool LoggerConfig::load(const QString &file, const QString &section) {
+        m_settings = LoggerSettings();
+        m_errors.clear();
+        if (!QFile::exists(file)) {
+            m_errors << QString("Configuration file %1 not found").arg(file);
+            return false;
+        }
+
+        QSettings sett(file, QSettings::IniFormat);
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+        QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+        sett.setIniCodec(codec);
+#endif
+        if (sett.status() != QSettings::NoError) {
+            m_errors << QString("Configuration file %1 cannot be parsed").arg(file);
+        }
+        sett.beginGroup(section);
+
+        LoggerSettings &s = m_settings;
+        auto invalid = [this](const char *key, const QString &text) {
+            m_errors << QString::fromLatin1(key) + ": invalid value \"" + text + "\"";
+        };
+        auto readText = [&](const char *key, QString &value) {
+            if (sett.contains(key)) {
+                value = text_value(sett, key);
+            }
+        };
+        // Чтение значения ключа функцией разбора. Пустое значение равносильно
+        // отсутствию ключа
+        auto read = [&](const char *key, auto &value, auto parse) {
+            const QString text = text_value(sett, key);
+            if (!text.isEmpty() && !parse(text, value)) {
+                invalid(key, text);
+                return false;
+            }
+            return !text.isEmpty();
+        };
+        auto parseInt = [](const QString &text, int &value) {
+            bool ok = false;
+            const int n = text.toInt(&ok);
+            if (ok) {
+                value = n;
+            }
+            return ok;
+        };
+        auto readInt = [&](const char *key, int &value, int min, int max) {
+            int n = value;
+            if (read(key, n, parseInt)) {
+                if (n < min || n > max) {
+                    invalid(key, text_value(sett, key));
+                } else {
+                    value = n;
+                }
+            }
+        };
+        auto readSize = [&](const char *key, std::int64_t &value) {
+            read(key, value, &LoggerConfig::parseSize);
+        };
+        auto readBool = [&](const char *key, bool &value) {
+            read(key, value, &LoggerConfig::parseBool);
+        };
+        auto readDuration = [&](const char *key, std::chrono::nanoseconds unit, auto &value) {
+            std::chrono::nanoseconds d(0);
+            const auto parse = [unit](const QString &text, std::chrono::nanoseconds &v) {
+                return LoggerConfig::parseDuration(text, v, unit);
+            };
+            if (read(key, d, parse)) {
+                value = std::chrono::duration_cast<typename std::decay<decltype(value)>::type>(d);
+            }
+        };
+
+        // Приёмники журнала
+        readText("LogFolder", s.folder);
+        readText("LogFileName", s.fileName);
+        readText("SharedMemorySink", s.shmName);
+        readSize("SharedMemorySize", s.shmSize);
+        readText("SyslogSocket", s.syslogSocket);
+        readText("SyslogAppName", s.syslogAppName);
+        const QString facility = text_value(sett, "SyslogFacility");
+        if (!facility.isEmpty()) {
+            s.syslogFacility = LoggerSyslog::facilityFromString(facility);
+            if (s.syslogFacility == LoggerSyslog::FacilityUser
+                    && facility.compare("user", Qt::CaseInsensitive) != 0 && facility != "1") {
+                invalid("SyslogFacility", facility);
+            }
+        }
+
+        // Файлы и формат строк
+        read("LogLevel", s.level, &LoggerConfig::parseLevel);
+        const QString maxSize = text_value(sett, "MaxLogFileSize");
+        if (maxSize != "-1") {
+            readSize("MaxLogFileSize", s.maxFileSize);
+        }
+        readInt("MaxFilesCount", s.maxFilesCount, -1, std::numeric_limits<int>::max());
+        read("LogFormat", s.format, &LoggerConfig::parseFormat);
+        if (sett.contains("LogPattern")) {
+            // Шаблон не обрезается: пробелы по краям - часть строки журнала
+            const QString pattern = sett.value("LogPattern").toStringList().join(',');
+            LoggerFormatter probe;
+            if (probe.setPattern(pattern)) {
+                s.pattern = pattern;
+            } else {
+                invalid("LogPattern", pattern);
+            }
+        }
+        readBool("SourceFullPath", s.sourceFullPath);
+
+        // Ограничение потока сообщений
+        const QString rate = text_value(sett, "RateLimit");
+        if (!rate.isEmpty()) {
+            bool ok = false;
+            const double r = rate.toDouble(&ok);
+            if (ok && r >= 0) {
+                s.rateLimit = r;
+            } else {
+                invalid("RateLimit", rate);
+            }
+        }
+        readInt("RateLimitBurst", s.rateLimitBurst, 0, std::numeric_limits<int>::max());
+        readBool("SuppressDuplicates", s.suppressDuplicates);
+        for (const NamedValue<LoggerLevel> &entry : LevelNames) {
+            if (entry.value == System) {
+                continue;
+            }
+            const QString key = QString::fromLatin1(SampleRatePrefix) + QString::fromLatin1(entry.name);
+            int rateOneIn = 1;
+            readInt(key.toLatin1().constData(), rateOneIn, 1, std::numeric_limits<int>::max());
+            s.sampleRate[entry.value - System] = static_cast<std::uint32_t>(rateOneIn);
+        }
+
+        // Поток записи
+        readDuration("WriterBatchWindowUs", std::chrono::microseconds(1), s.batchWindow);
+        readDuration("WriterBatchWindow", std::chrono::microseconds(1), s.batchWindow);
+        readSize("ArenaSize", s.arenaSize);
+        readBool("AsyncIo", s.asyncIo);
+        readSize("TailBuffer", s.tailBuffer);
+        readText("TailSocket", s.tailSocket);
+        readBool("ThreadFields", s.threadFields);
+        read("ClockSource", s.clockSource, &LoggerConfig::parseClockSource);
+        for (const QString &cpu : sett.value("WriterCpus").toStringList()) {
+            bool ok = false;
+            const int n = cpu.trimmed().toInt(&ok);
+            if (ok && n >= 0) {
+                s.writer.cpus.push_back(n);
+            } else if (!cpu.trimmed().isEmpty()) {
+                invalid("WriterCpus", cpu.trimmed());
+            }
+        }
+        read("WriterPolicy", s.writer.policy, &LoggerConfig::parseSchedPolicy);
+        readInt("WriterNice", s.writer.nice, -20, 19);
+        readText("WriterThreadName", s.writer.name);
+        readBool("WriterNumaLocal", s.writer.numaLocal);
+        readSize("IndexInterval", s.indexInterval);
+        readSize("PreallocateExtent", s.preallocateExtent);
+
+        // Сохранность и сжатие
+        read("Durability", s.durability, &LoggerConfig::parseDurability);
+        readDuration("SyncIntervalMs", std::chrono::milliseconds(1), s.syncInterval);
+        readDuration("SyncInterval", std::chrono::milliseconds(1), s.syncInterval);
+        read("Compression", s.compression, &LoggerConfig::parseCompression);
+        readInt("CompressionLevel", s.compressionLevel, 0, 22);
+        read("ArchiveCompression", s.archiveCompression, &LoggerConfig::parseCompression);
+        readInt("ArchiveCompressionLevel", s.archiveCompressionLevel, 0, 22);
+        readInt("ArchiveWorkers", s.archiveWorkers, 1, 16);
+        readBool("BatchChecksum", s.batchChecksum);
+        read("OpenMode", s.openMode, &LoggerConfig::parseOpenMode);
+        readSize("FallbackBuffer", s.fallbackBuffer);
+        readBool("WatchConfig", s.watchConfig);
+
+        for (const QString &key : sett.childKeys()) {
+            bool known = false;
+            for (const char *name : KnownKeys) {
+                if (key == name) {
+                    known = true;
+                    break;
+                }
+            }
+            LoggerLevel level;
+            if (!known && key.startsWith(SampleRatePrefix)) {
+                const int prefix = static_cast<int>(sizeof(SampleRatePrefix)) - 1;
+                known = lookup(LevelNames, key.constData() + prefix, key.constData() + key.size(), level)
+                        && level != System;
+            }
+            if (!known) {
+                m_errors << key + ": unknown key";
+            }
+        }
+
+        if (s.folder.isEmpty() && s.shmName.isEmpty() && s.syslogSocket.isEmpty()) {
+            m_errors << QString("No LogFolder, SharedMemorySink or SyslogSocket in section %1").arg(section);
+            return false;
+        }
+        return true;
+    }
+
+}   // End namespace DIRA_3D_GW
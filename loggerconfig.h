@@ -0,0 +1,172 @@
+#ifndef LOGGERCONFIG_H
+#define LOGGERCONFIG_H
+
+#include <QtCore/qglobal.h>
+#include <QString>
+#include <QStringList>
+
+#include <chrono>
+#include <cstdint>
+
+#include "loggertypes.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/**
+ * \struct Настройки журнала, прочитанные из файла конфигурации
+ * \brief Значения по умолчанию совпадают со значениями по умолчанию Logger.
+ * Размеры -1 означают, что параметр в файле не указан и Logger использует своё
+ * значение по умолчанию.
+ */
+struct LoggerSettings
+{
+    QString folder;                                 ///< Каталог файлов журнала (LogFolder)
+    QString fileName;                               ///< Имя файла журнала (LogFileName)
+    LoggerLevel level = System;                     ///< Уровень журнала (LogLevel)
+    std::int64_t maxFileSize = -1;                  ///< Максимальный размер файла, байт (-1 - без ограничения)
+    std::int32_t maxFilesCount = -1;                ///< Количество хранимых файлов (MaxFilesCount)
+    LoggerFormat format = Text;                     ///< Формат строк (LogFormat)
+    QString pattern;                                ///< Шаблон строки формата Text (LogPattern)
+    bool sourceFullPath = false;                    ///< Полный путь файла исходного кода (SourceFullPath)
+
+    double rateLimit = 0;                           ///< Сообщений в секунду (RateLimit, 0 - без ограничения)
+    std::int32_t rateLimitBurst = 0;                ///< Размер всплеска (RateLimitBurst)
+    bool suppressDuplicates = false;                ///< Подавление повторов (SuppressDuplicates)
+
+    std::chrono::microseconds batchWindow{0};       ///< Окно накопления пачки (WriterBatchWindow)
+    std::int64_t arenaSize = -1;                    ///< Записей в пуле (ArenaSize)
+    bool asyncIo = false;                           ///< Асинхронная запись (AsyncIo)
+    std::int64_t tailBuffer = -1;                   ///< Буфер последних строк, байт (TailBuffer)
+    QString tailSocket;                             ///< Сокет чтения последних строк (TailSocket)
+    bool threadFields = false;                      ///< Поля потока в сообщениях (ThreadFields)
+    LoggerClockSource clockSource = ClockRealtime;  ///< Источник времени (ClockSource)
+    LoggerThreadOptions writer;                     ///< Параметры потока записи (Writer*)
+    std::int64_t indexInterval = -1;                ///< Интервал индекса, байт (IndexInterval)
+    std::int64_t preallocateExtent = -1;            ///< Размер резервирования, байт (PreallocateExtent)
+
+    LoggerDurability durability = Flush;            ///< Режим сохранности (Durability)
+    std::chrono::milliseconds syncInterval{1000};   ///< Интервал синхронизации (SyncInterval)
+    LoggerCompression compression = CompressionNone;        ///< Сжатие активного файла (Compression)
+    int compressionLevel = 0;                               ///< Уровень сжатия (CompressionLevel)
+    LoggerCompression archiveCompression = CompressionNone; ///< Сжатие файлов после ротации (ArchiveCompression)
+    int archiveCompressionLevel = 0;                        ///< Уровень сжатия (ArchiveCompressionLevel)
+    int archiveWorkers = 2;                                 ///< Потоков сжатия (ArchiveWorkers)
+    bool batchChecksum = false;                     ///< Контрольные суммы пачек (BatchChecksum)
+    LoggerOpenMode openMode = OpenDeferred;         ///< Режим открытия файла (OpenMode)
+    std::int64_t fallbackBuffer = -1;               ///< Буфер строк без файла, байт (FallbackBuffer)
+
+    QString shmName;                                ///< Имя разделяемой памяти (SharedMemorySink)
+    std::int64_t shmSize = -1;                      ///< Размер разделяемой памяти, байт (SharedMemorySize)
+    QString syslogSocket;                           ///< Сокет syslog (SyslogSocket)
+    QString syslogAppName;                          ///< Имя приложения для syslog (SyslogAppName)
+    int syslogFacility = 1;                         ///< Facility syslog (SyslogFacility)
+
+    bool watchConfig = false;                       ///< Перечитывать файл при изменении (WatchConfig)
+
+    std::uint32_t sampleRate[LoggerLevelsCount] = {1, 1, 1, 1, 1, 1, 1};   ///< Выборка уровней (SampleRate<Уровень>)
+};
+
+/*! \class Чтение и проверка файла конфигурации журнала
+ *  \brief Читает параметры журнала из секции INI-файла в LoggerSettings. Значения
+ * перечислений, размеры и длительности разбираются по статическим таблицам без
+ * выделения памяти и без учёта регистра. Ошибочные значения и неизвестные ключи не
+ * прерывают чтение: параметр сохраняет значение по умолчанию, а описание ошибки
+ * ("Ключ: описание") добавляется в errors().
+ *     Размеры: целое или дробное число с необязательной единицей B, K, KB, KiB, M,
+ * MB, MiB, G, GB, GiB, T, TB, TiB (все единицы двоичные - 1 Kb = 1024 байт, как и
+ * в прежних файлах конфигурации). Длительности: число с единицей ns, us, ms, s,
+ * min, h, d; число без единицы - в единицах ключа (см. parseDuration()).
+ */
+    class LoggerConfig {
+    public:
+        /**
+         * @brief Чтение секции файла конфигурации
+         *
+         * @param file Имя (полный путь) файла конфигурации
+         * @param section Название секции в файле
+         * @return true или false если файл не найден или в нём не указан ни один
+         * приёмник журнала (каталог, разделяемая память или syslog)
+         */
+        bool load(const QString &file, const QString &section);
+
+        /**
+         * @brief Прочитанные настройки
+         */
+        const LoggerSettings &settings() const  {   return m_settings;  }
+
+        /**
+         * @brief Ошибки чтения последнего файла конфигурации
+         */
+        const QStringList &errors() const       {   return m_errors;    }
+
+        /**
+         * @brief Разбор уровня журнала (System, Critical, ... Developer)
+         * @return true или false если строка не распознана (value не изменяется)
+         */
+        static bool parseLevel(const QString &text, LoggerLevel &value);
+
+        /**
+         * @brief Разбор формата строк (Text, Json, JsonLines, Logfmt)
+         */
+        static bool parseFormat(const QString &text, LoggerFormat &value);
+
+        /**
+         * @brief Разбор режима сохранности (Flush, GroupCommit, CriticalSync, FullSync)
+         */
+        static bool parseDurability(const QString &text, LoggerDurability &value);
+
+        /**
+         * @brief Разбор метода сжатия (None, Gzip, Zstd)
+         */
+        static bool parseCompression(const QString &text, LoggerCompression &value);
+
+        /**
+         * @brief Разбор источника времени (Realtime, MonotonicRaw, Tsc)
+         */
+        static bool parseClockSource(const QString &text, LoggerClockSource &value);
+
+        /**
+         * @brief Разбор политики планирования (Normal, Batch, Idle)
+         */
+        static bool parseSchedPolicy(const QString &text, LoggerSchedPolicy &value);
+
+        /**
+         * @brief Разбор режима открытия файла (Deferred, Sync)
+         */
+        static bool parseOpenMode(const QString &text, LoggerOpenMode &value);
+
+        /**
+         * @brief Разбор логического значения (true/false, yes/no, on/off, 1/0)
+         */
+        static bool parseBool(const QString &text, bool &value);
+
+        /**
+         * @brief Разбор размера
+         * @remark Переполнение 64-битного значения считается ошибкой.
+         *
+         * @param text Строка вида "512", "64Kb", "1.5 GiB"
+         * @param bytes Размер, байт
+         * @return true или false если строка не распознана (bytes не изменяется)
+         */
+        static bool parseSize(const QString &text, std::int64_t &bytes);
+
+        /**
+         * @brief Разбор длительности
+         *
+         * @param text Строка вида "250ms", "1.5s", "2min"
+         * @param value Длительность
+         * @param unit Единица числа без указания единицы
+         * @return true или false если строка не распознана (value не изменяется)
+         */
+        static bool parseDuration(const QString &text, std::chrono::nanoseconds &value,
+                                  std::chrono::nanoseconds unit);
+
+    private:
+        LoggerSettings m_settings;  ///< Прочитанные настройки
+        QStringList m_errors;       ///< Ошибки чтения
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERCONFIG_H
@@ -0,0 +1,630 @@
+#include "loggerformatter.h"
+
+#include <QDateTime>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    //! Добавление строкового литерала без завершающего нуля
+    template <int N>
+    inline void append_literal(QByteArray &dst, const char (&text)[N]) {
+        dst.append(text, N - 1);
+    }
+
+}
+
+    LoggerFormatter::LoggerFormatter(): m_format(LoggerFormat::Text)
+                                      , m_sourceFullPath(false)
+                                      , m_msecs(0)
+                                      , m_nanos(0)
+                                      , m_cachedSecs(INT64_MIN)
+                                      , m_textTime()
+                                      , m_isoTime()
+                                      , m_isoOffset()
+    {}
+
+    void LoggerFormatter::setFormat(LoggerFormat format) {
+        m_format = format;
+    }
+
+    LoggerFormat LoggerFormatter::format() const {
+        return m_format;
+    }
+
+    void LoggerFormatter::setSourceFullPath(bool full) {
+        m_sourceFullPath = full;
+    }
+
+    const char *LoggerFormatter::locationFile(const LoggerSourceLocation *loc) const {
+        return m_sourceFullPath ? loc->file() : loc->baseName();
+    }
+
+    const char *LoggerFormatter::levelName(LoggerLevel level) {
+        switch (level) {
+        case LoggerLevel::System:       return "System";
+        case LoggerLevel::Critical:     return "Critical";
+        case LoggerLevel::Error:        return "Error";
+        case LoggerLevel::Warning:      return "Warning";
+        case LoggerLevel::Info:         return "Info";
+        case LoggerLevel::Debug:        return "Debug";
+        case LoggerLevel::Developer:    return "Developer";
+        }
+        return "Unknown";
+    }
+
+    void LoggerFormatter::format(const LoggerRecord &rec, QByteArray &dst) {
+        if (rec.preformatted) {
+            dst.append(rec.message(), static_cast<int>(rec.messageSize));
+            return;
+        }
+        // Время записи хранится в наносекундах, строки содержат миллисекунды
+        m_msecs = rec.time / 1000000;
+        if (rec.time < 0 && rec.time % 1000000 != 0) {
+            --m_msecs;
+        }
+        updateTimeCache(m_msecs);
+        m_nanos = static_cast<int>(rec.time - m_cachedSecs * 1000000000);
+
+        switch (m_format) {
+        case LoggerFormat::JsonLines:
+            formatJson(rec, dst);
+            break;
+        case LoggerFormat::Logfmt:
+            formatLogfmt(rec, dst);
+            break;
+        case LoggerFormat::Text:
+        default:
+            if (m_steps.empty()) {
+                formatText(rec, dst);
+            } else {
+                formatPattern(rec, dst);
+            }
+            break;
+        }
+    }
+
+    bool LoggerFormatter::setPattern(const QString &pattern) {
+        std::vector<Step> steps;
+        QByteArray literals;
+        auto addLiteral = [&](const char *text, int size) {
+            // Соседние символы шаблона объединяются в один шаг
+            if (!steps.empty() && steps.back().kind == StepLiteral) {
+                steps.back().size += size;
+            } else {
+                steps.push_back(Step{StepLiteral, 0, literals.size(), size});
+            }
+            literals.append(text, size);
+        };
+        auto add = [&](StepKind kind, int arg) {
+            steps.push_back(Step{kind, static_cast<std::uint8_t>(arg), 0, 0});
+        };
+
+        const QByteArray p = pattern.toUtf8();
+        bool inGroup = false;
+        for (int i = 0; i < p.size(); ) {
+            if (p[i] != '%') {
+                addLiteral(p.constData() + i, 1);
+                ++i;
+                continue;
+            }
+            if (i + 1 >= p.size()) {
+                return false;
+            }
+            const char c = p[i + 1];
+            i += 2;
+            switch (c) {
+            case '%':   addLiteral("%", 1);         break;
+            case 'l':   add(StepLevel, 0);          break;
+            case 't':   add(StepThread, 0);         break;
+            case 'm':   add(StepMessage, 0);        break;
+            case 'k':   add(StepFields, 0);         break;
+            case 'f':   add(StepFile, 0);           break;
+            case 'n':   add(StepLine, 0);           break;
+            case 'F':   add(StepFunction, 0);       break;
+            case '(':
+                if (inGroup) {
+                    return false;
+                }
+                inGroup = true;
+                add(StepGroupBegin, 0);
+                break;
+            case ')':
+                if (!inGroup) {
+                    return false;
+                }
+                inGroup = false;
+                add(StepGroupEnd, 0);
+                break;
+            case 'd': {
+                int style = TimeText;
+                int digits = 0;
+                if (i < p.size() && p[i] == '{') {
+                    const int end = p.indexOf('}', i);
+                    if (end < 0) {
+                        return false;
+                    }
+                    const QByteArray spec = p.mid(i + 1, end - i - 1);
+                    i = end + 1;
+                    const int dot = spec.indexOf('.');
+                    const QByteArray base = dot < 0 ? spec : spec.left(dot);
+                    const QByteArray precision = dot < 0 ? QByteArray() : spec.mid(dot + 1);
+                    if (base == "text") {
+                        style = TimeText;
+                    } else if (base == "iso8601") {
+                        style = TimeIso;
+                    } else if (base == "epoch") {
+                        style = TimeEpoch;
+                    } else {
+                        return false;
+                    }
+                    if (precision == "ms") {
+                        digits = 3;
+                    } else if (precision == "us") {
+                        digits = 6;
+                    } else if (precision == "ns") {
+                        digits = 9;
+                    } else if (!precision.isEmpty() || dot >= 0) {
+                        return false;
+                    }
+                }
+                add(StepTime, (style << 4) | digits);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        if (inGroup) {
+            return false;
+        }
+        m_steps.swap(steps);
+        m_literals = literals;
+        return true;
+    }
+
+    void LoggerFormatter::formatPattern(const LoggerRecord &rec, QByteArray &dst) {
+        const LoggerSourceLocation *loc = LoggerSourceLocation::find(rec.sourceId);
+        int groupStart = 0;
+        bool groupFilled = false;
+        for (const Step &step : m_steps) {
+            const int before = dst.size();
+            switch (step.kind) {
+            case StepLiteral:
+                dst.append(m_literals.constData() + step.offset, step.size);
+                continue;
+            case StepGroupBegin:
+                groupStart = before;
+                groupFilled = false;
+                continue;
+            case StepGroupEnd:
+                // Необязательная часть без значений отбрасывается вместе с её текстом
+                if (!groupFilled) {
+                    dst.resize(groupStart);
+                }
+                continue;
+            case StepTime:
+                appendTime(step.arg, dst);
+                break;
+            case StepLevel:
+                dst.append(levelName(rec.level));
+                break;
+            case StepThread:
+                if (rec.threadId != 0) {
+                    if (rec.threadName) {
+                        dst.append(rec.threadName);
+                        dst.append(':');
+                    }
+                    appendInt(dst, rec.threadId);
+                }
+                break;
+            case StepMessage:
+                appendUtf8(dst, rec.message(), static_cast<int>(rec.messageSize), EscapeNone);
+                break;
+            case StepFields:
+                appendFieldsKv(rec, dst);
+                break;
+            case StepFile:
+                if (loc) {
+                    dst.append(locationFile(loc));
+                } else {
+                    appendUtf8(dst, rec.sourceFile(), static_cast<int>(rec.sourceFileSize), EscapeNone);
+                }
+                break;
+            case StepLine:
+                if (loc) {
+                    appendInt(dst, loc->line());
+                } else if (rec.sourceLine != -1) {
+                    appendInt(dst, rec.sourceLine);
+                }
+                break;
+            case StepFunction:
+                if (loc) {
+                    dst.append(loc->function());
+                }
+                break;
+            }
+            if (dst.size() != before) {
+                groupFilled = true;
+            }
+        }
+        dst.append('\n');
+    }
+
+    void LoggerFormatter::appendTime(int arg, QByteArray &dst) {
+        static const int divisors[] = {1000000, 1000, 1};
+        const int style = arg >> 4;
+        const int digits = arg & 0xF;
+        switch (style) {
+        case TimeIso:
+            dst.append(m_isoTime, 19);
+            break;
+        case TimeEpoch:
+            appendInt(dst, m_cachedSecs);
+            break;
+        case TimeText:
+        default:
+            dst.append(m_textTime, 19);
+            break;
+        }
+        if (digits > 0) {
+            dst.append('.');
+            appendPadded(dst, m_nanos / divisors[digits / 3 - 1], digits);
+        }
+        if (style == TimeIso) {
+            dst.append(m_isoOffset, 6);
+        }
+    }
+
+    void LoggerFormatter::formatText(const LoggerRecord &rec, QByteArray &dst) {
+        // Формат строки: "dd.MM.yyyy hh:mm:ss [Level] [thread:tid]: message k=v [file (line)]"
+        dst.append(m_textTime, 19);
+        append_literal(dst, " [");
+        dst.append(levelName(rec.level));
+        if (rec.threadId != 0) {
+            append_literal(dst, "] [");
+            if (rec.threadName) {
+                dst.append(rec.threadName);
+                dst.append(':');
+            }
+            appendInt(dst, rec.threadId);
+        }
+        append_literal(dst, "]: ");
+        formatMessage(rec, dst);
+        dst.append('\n');
+    }
+
+    void LoggerFormatter::formatMessage(const LoggerRecord &rec, QByteArray &dst) {
+        if (rec.preformatted) {
+            // Готовая строка передаётся без перевода строки
+            int size = static_cast<int>(rec.messageSize);
+            while (size > 0 && (rec.message()[size - 1] == '\n' || rec.message()[size - 1] == '\r')) {
+                --size;
+            }
+            dst.append(rec.message(), size);
+            return;
+        }
+        appendUtf8(dst, rec.message(), static_cast<int>(rec.messageSize), EscapeNone);
+        appendFieldsKv(rec, dst);
+
+        if (const LoggerSourceLocation *loc = LoggerSourceLocation::find(rec.sourceId)) {
+            append_literal(dst, " [");
+            dst.append(locationFile(loc));
+            append_literal(dst, " (");
+            appendInt(dst, loc->line());
+            append_literal(dst, ")]");
+        } else if (rec.sourceFileSize != 0) {
+            append_literal(dst, " [");
+            appendUtf8(dst, rec.sourceFile(), static_cast<int>(rec.sourceFileSize), EscapeNone);
+            if (rec.sourceLine != -1) {
+                append_literal(dst, " (");
+                appendInt(dst, rec.sourceLine);
+                dst.append(')');
+            }
+            dst.append(']');
+        } else if (rec.sourceLine != -1) {
+            append_literal(dst, " (");
+            appendInt(dst, rec.sourceLine);
+            dst.append(')');
+        }
+    }
+
+    void LoggerFormatter::formatJson(const LoggerRecord &rec, QByteArray &dst) {
+        const std::int64_t ms = m_msecs % 1000;
+
+        append_literal(dst, "{\"time\":\"");
+        dst.append(m_isoTime, 19);
+        dst.append('.');
+        appendPadded(dst, static_cast<int>(ms < 0 ? ms + 1000 : ms), 3);
+        dst.append(m_isoOffset, 6);
+        append_literal(dst, "\",\"level\":\"");
+        dst.append(levelName(rec.level));
+        dst.append('"');
+        if (rec.threadId != 0) {
+            append_literal(dst, ",\"tid\":");
+            appendInt(dst, rec.threadId);
+            if (rec.threadName) {
+                append_literal(dst, ",\"thread\":\"");
+                appendUtf8(dst, rec.threadName, static_cast<int>(std::strlen(rec.threadName)), EscapeJson);
+                dst.append('"');
+            }
+        }
+        append_literal(dst, ",\"msg\":\"");
+        appendUtf8(dst, rec.message(), static_cast<int>(rec.messageSize), EscapeJson);
+        dst.append('"');
+
+        if (const LoggerSourceLocation *loc = LoggerSourceLocation::find(rec.sourceId)) {
+            const char *file = locationFile(loc);
+            append_literal(dst, ",\"file\":\"");
+            appendUtf8(dst, file, static_cast<int>(std::strlen(file)), EscapeJson);
+            append_literal(dst, "\",\"line\":");
+            appendInt(dst, loc->line());
+            append_literal(dst, ",\"func\":\"");
+            appendUtf8(dst, loc->function(), static_cast<int>(std::strlen(loc->function())), EscapeJson);
+            dst.append('"');
+        } else {
+            if (rec.sourceFileSize != 0) {
+                append_literal(dst, ",\"file\":\"");
+                appendUtf8(dst, rec.sourceFile(), static_cast<int>(rec.sourceFileSize), EscapeJson);
+                dst.append('"');
+            }
+            if (rec.sourceLine != -1) {
+                append_literal(dst, ",\"line\":");
+                appendInt(dst, rec.sourceLine);
+            }
+        }
+
+        LoggerFieldReader reader(rec);
+        while (reader.next()) {
+            append_literal(dst, ",\"");
+            appendUtf8(dst, reader.key(), static_cast<int>(std::strlen(reader.key())), EscapeJson);
+            append_literal(dst, "\":");
+            switch (reader.type()) {
+            case LoggerField::String:
+                dst.append('"');
+                appendUtf8(dst, reader.str(), reader.strSize(), EscapeJson);
+                dst.append('"');
+                break;
+            case LoggerField::Double:
+                if (std::isfinite(reader.toDouble()))
+                    appendDouble(dst, reader.toDouble());
+                else
+                    append_literal(dst, "null");
+                break;
+            case LoggerField::Bool:
+                if (reader.toInt() != 0)
+                    append_literal(dst, "true");
+                else
+                    append_literal(dst, "false");
+                break;
+            case LoggerField::UInt:
+                appendUInt(dst, static_cast<std::uint64_t>(reader.toInt()));
+                break;
+            case LoggerField::Int:
+            case LoggerField::Duration:
+            default:
+                // Длительность в JSON записывается целым числом наносекунд
+                appendInt(dst, reader.toInt());
+                break;
+            }
+        }
+        append_literal(dst, "}\n");
+    }
+
+    void LoggerFormatter::formatLogfmt(const LoggerRecord &rec, QByteArray &dst) {
+        const std::int64_t ms = m_msecs % 1000;
+
+        append_literal(dst, "time=");
+        dst.append(m_isoTime, 19);
+        dst.append('.');
+        appendPadded(dst, static_cast<int>(ms < 0 ? ms + 1000 : ms), 3);
+        dst.append(m_isoOffset, 6);
+        append_literal(dst, " level=");
+        dst.append(levelName(rec.level));
+        if (rec.threadId != 0) {
+            append_literal(dst, " tid=");
+            appendInt(dst, rec.threadId);
+            if (rec.threadName) {
+                append_literal(dst, " thread=");
+                appendUtf8(dst, rec.threadName, static_cast<int>(std::strlen(rec.threadName)), EscapeLogfmt);
+            }
+        }
+        append_literal(dst, " msg=");
+        appendUtf8(dst, rec.message(), static_cast<int>(rec.messageSize), EscapeLogfmt);
+
+        if (const LoggerSourceLocation *loc = LoggerSourceLocation::find(rec.sourceId)) {
+            const char *file = locationFile(loc);
+            append_literal(dst, " file=");
+            appendUtf8(dst, file, static_cast<int>(std::strlen(file)), EscapeLogfmt);
+            append_literal(dst, " line=");
+            appendInt(dst, loc->line());
+            append_literal(dst, " func=");
+            appendUtf8(dst, loc->function(), static_cast<int>(std::strlen(loc->function())), EscapeLogfmt);
+        } else {
+            if (rec.sourceFileSize != 0) {
+                append_literal(dst, " file=");
+                appendUtf8(dst, rec.sourceFile(), static_cast<int>(rec.sourceFileSize), EscapeLogfmt);
+            }
+            if (rec.sourceLine != -1) {
+                append_literal(dst, " line=");
+                appendInt(dst, rec.sourceLine);
+            }
+        }
+
+        appendFieldsKv(rec, dst);
+        dst.append('\n');
+    }
+
+    void LoggerFormatter::appendFieldsKv(const LoggerRecord &rec, QByteArray &dst) {
+        LoggerFieldReader reader(rec);
+        while (reader.next()) {
+            dst.append(' ');
+            dst.append(reader.key());
+            dst.append('=');
+            switch (reader.type()) {
+            case LoggerField::String:
+                appendUtf8(dst, reader.str(), reader.strSize(), EscapeLogfmt);
+                break;
+            case LoggerField::Double:
+                appendDouble(dst, reader.toDouble());
+                break;
+            case LoggerField::Duration:
+                appendDuration(dst, reader.toInt());
+                break;
+            case LoggerField::Bool:
+                if (reader.toInt() != 0)
+                    append_literal(dst, "true");
+                else
+                    append_literal(dst, "false");
+                break;
+            case LoggerField::UInt:
+                appendUInt(dst, static_cast<std::uint64_t>(reader.toInt()));
+                break;
+            case LoggerField::Int:
+            default:
+                appendInt(dst, reader.toInt());
+                break;
+            }
+        }
+    }
+
+    void LoggerFormatter::updateTimeCache(std::int64_t msecs) {
+        std::int64_t secs = msecs / 1000;
+        if (msecs < 0 && msecs % 1000 != 0) {
+            --secs;
+        }
+        if (secs == m_cachedSecs) {
+            return;
+        }
+        m_cachedSecs = secs;
+
+        const QDateTime dt = QDateTime::fromMSecsSinceEpoch(secs * 1000);
+        const QDate d = dt.date();
+        const QTime t = dt.time();
+        std::snprintf(m_textTime, sizeof(m_textTime), "%02d.%02d.%04d %02d:%02d:%02d",
+                      d.day(), d.month(), d.year(), t.hour(), t.minute(), t.second());
+        std::snprintf(m_isoTime, sizeof(m_isoTime), "%04d-%02d-%02dT%02d:%02d:%02d",
+                      d.year(), d.month(), d.day(), t.hour(), t.minute(), t.second());
+
+        const int offset = dt.offsetFromUtc() / 60;
+        const int absOffset = offset < 0 ? -offset : offset;
+        std::snprintf(m_isoOffset, sizeof(m_isoOffset), "%c%02d:%02d",
+                      offset < 0 ? '-' : '+', absOffset / 60, absOffset % 60);
+    }
+
+    void LoggerFormatter::appendUtf8(QByteArray &dst, const char *str, int size, Escape mode) {
+        if (mode == EscapeNone) {
+            dst.append(str, size);
+            return;
+        }
+
+        const bool quoted = mode == EscapeLogfmt && needsQuotes(str, size);
+        if (quoted) {
+            dst.append('"');
+        }
+
+        const char *run = str;
+        const char *end = str + size;
+        for (const char *p = str; p != end; ++p) {
+            const unsigned char c = static_cast<unsigned char>(*p);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            dst.append(run, static_cast<int>(p - run));
+            run = p + 1;
+            switch (c) {
+            case '"':  append_literal(dst, "\\\""); break;
+            case '\\': append_literal(dst, "\\\\"); break;
+            case '\n': append_literal(dst, "\\n"); break;
+            case '\r': append_literal(dst, "\\r"); break;
+            case '\t': append_literal(dst, "\\t"); break;
+            default: {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                dst.append(buf, 6);
+                break;
+            }
+            }
+        }
+        dst.append(run, static_cast<int>(end - run));
+
+        if (quoted) {
+            dst.append('"');
+        }
+    }
+
+    void LoggerFormatter::appendInt(QByteArray &dst, std::int64_t value) {
+        if (value < 0) {
+            dst.append('-');
+            appendUInt(dst, 0 - static_cast<std::uint64_t>(value));
+        } else {
+            appendUInt(dst, static_cast<std::uint64_t>(value));
+        }
+    }
+
+    void LoggerFormatter::appendUInt(QByteArray &dst, std::uint64_t value) {
+        char buf[24];
+        char *p = buf + sizeof(buf);
+        do {
+            *--p = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        dst.append(p, static_cast<int>(buf + sizeof(buf) - p));
+    }
+
+    void LoggerFormatter::appendDouble(QByteArray &dst, double value) {
+        char buf[32];
+        const int n = std::snprintf(buf, sizeof(buf), "%.17g", value);
+        if (n > 0) {
+            dst.append(buf, n < static_cast<int>(sizeof(buf)) ? n : static_cast<int>(sizeof(buf)) - 1);
+        }
+    }
+
+    void LoggerFormatter::appendDuration(QByteArray &dst, std::int64_t ns) {
+        // Длительность записывается в наиболее подходящих единицах: 850ns, 12.5us, 3.2ms, 1.75s
+        const std::int64_t absNs = ns < 0 ? -ns : ns;
+        char buf[32];
+        int n;
+        if (absNs < 1000) {
+            n = std::snprintf(buf, sizeof(buf), "%lldns", static_cast<long long>(ns));
+        } else if (absNs < 1000000) {
+            n = std::snprintf(buf, sizeof(buf), "%.3gus", static_cast<double>(ns) / 1e3);
+        } else if (absNs < 1000000000) {
+            n = std::snprintf(buf, sizeof(buf), "%.3gms", static_cast<double>(ns) / 1e6);
+        } else {
+            n = std::snprintf(buf, sizeof(buf), "%.6gs", static_cast<double>(ns) / 1e9);
+        }
+        if (n > 0) {
+            dst.append(buf, n < static_cast<int>(sizeof(buf)) ? n : static_cast<int>(sizeof(buf)) - 1);
+        }
+    }
+
+    void LoggerFormatter::appendPadded(QByteArray &dst, int value, int width) {
+        char buf[12];
+        char *p = buf + sizeof(buf);
+        for (int i = 0; i < width || value != 0; ++i) {
+            *--p = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        dst.append(p, static_cast<int>(buf + sizeof(buf) - p));
+    }
+
+    bool LoggerFormatter::needsQuotes(const char *str, int size) {
+        if (size == 0) {
+            return true;
+        }
+        for (int i = 0; i < size; ++i) {
+            const unsigned char c = static_cast<unsigned char>(str[i]);
+            if (c <= 0x20 || c == '=' || c == '"' || c == '\\') {
+                return true;
+            }
+        }
+        return false;
+    }
+
+}   // End namespace DIRA_3D_GW
@@ -0,0 +1,174 @@
+#ifndef LOGGERFORMATTER_H
+#define LOGGERFORMATTER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+#include "loggertypes.h"
+#include "loggerrecord.h"
+#include "loggersourcelocation.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Преобразование записей журнала в строки файла журнала.
+ *  \brief Формирует строку файла журнала в одном из форматов LoggerFormat.
+ *     Используется только в потоке записи. Строка дописывается в конец буфера,
+ * который передаётся вызывающей стороной и переиспользуется между сообщениями,
+ * поэтому при форматировании не выполняется выделения памяти (кроме роста самого
+ * буфера). Дата и время форматируются один раз в секунду и кешируются.
+ */
+    class LoggerFormatter {
+    public:
+        LoggerFormatter();
+
+        /**
+         * @brief Установка формата записи журнала
+         * @param format Формат записи
+         * @see LoggerFormat
+         */
+        void setFormat(LoggerFormat format);
+
+        /**
+         * @brief Текущий формат записи журнала
+         */
+        LoggerFormat format() const;
+
+        /**
+         * @brief Установка способа вывода имени файла исходного кода
+         * @remark Применяется к местам вызова LoggerSourceLocation. Имена файлов,
+         * переданные строкой, выводятся без изменений.
+         *
+         * @param full true - полный путь к файлу, false - только имя файла
+         */
+        void setSourceFullPath(bool full);
+
+        /**
+         * @brief Установка шаблона строки текстового формата
+         * @remark Шаблон разбирается один раз в последовательность шагов, поэтому
+         * формирование строки - последовательное добавление частей в буфер без
+         * разбора шаблона и выделения памяти. Шаблон применяется к формату Text,
+         * пустой шаблон - стандартная строка Text. Элементы шаблона:
+         *     %d - время "dd.MM.yyyy hh:mm:ss", %d{стиль[.точность]} - время в стиле
+         * text, iso8601 (с часовым поясом) или epoch (секунды) с долями секунды
+         * ms, us или ns, например %d{iso8601.us};
+         *     %l - уровень, %t - поток "имя:tid", %m - сообщение, %k - поля сообщения
+         * " ключ=значение", %f - файл исходного кода, %n - строка, %F - функция,
+         * %% - символ %;
+         *     %( ... %) - необязательная часть: выводится, только если хотя бы один
+         * элемент внутри неё не пуст (например "%( [%f:%n]%)"). Вложение не
+         * поддерживается.
+         *     Перевод строки добавляется автоматически.
+         *
+         * @param pattern Шаблон строки
+         * @return true или false если шаблон содержит ошибку (шаблон не изменяется)
+         */
+        bool setPattern(const QString &pattern);
+
+        /**
+         * @brief Формирование строки файла журнала
+         * @remark Добавляет в конец dst строку, соответствующую записи rec, включая
+         * завершающий символ перевода строки. Готовые строки (rec.preformatted)
+         * добавляются без изменений.
+         *
+         * @param rec Запись очереди сообщений
+         * @param dst Буфер, в конец которого дописывается строка
+         */
+        void format(const LoggerRecord &rec, QByteArray &dst);
+
+        /**
+         * @brief Формирование текста сообщения без времени и уровня
+         * @remark Добавляет в конец dst "message k=v [file (line)]" без перевода строки
+         * (для приёмников, которые передают время и уровень отдельно, например syslog).
+         *
+         * @param rec Запись очереди сообщений
+         * @param dst Буфер, в конец которого дописывается текст
+         */
+        void formatMessage(const LoggerRecord &rec, QByteArray &dst);
+
+        /**
+         * @brief Название уровня логгирования
+         * @param level Уровень логгирования
+         * @return Строка с названием уровня, например "Warning"
+         */
+        static const char *levelName(LoggerLevel level);
+
+    private:
+        //! Вид шага шаблона строки
+        enum StepKind : std::uint8_t {
+            StepLiteral,        // Текст шаблона
+            StepTime,           // Время (arg - стиль и точность)
+            StepLevel,          // Уровень
+            StepThread,         // Поток
+            StepMessage,        // Сообщение
+            StepFields,         // Поля сообщения
+            StepFile,           // Файл исходного кода
+            StepLine,           // Строка файла исходного кода
+            StepFunction,       // Функция
+            StepGroupBegin,     // Начало необязательной части
+            StepGroupEnd,       // Конец необязательной части
+        };
+
+        //! Стиль времени шаблона (старшие биты arg шага StepTime)
+        enum TimeStyle {
+            TimeText = 0,       // dd.MM.yyyy hh:mm:ss
+            TimeIso = 1,        // yyyy-MM-ddThh:mm:ss+hh:mm
+            TimeEpoch = 2,      // Секунды от начала эпохи
+        };
+
+        //! Шаг шаблона строки
+        struct Step {
+            StepKind kind;
+            std::uint8_t arg;   ///< Параметр шага
+            int offset;         ///< Начало текста в m_literals (StepLiteral)
+            int size;           ///< Длина текста (StepLiteral)
+        };
+
+        //! Способ экранирования строковых значений
+        enum Escape {
+            EscapeNone,     // Без экранирования
+            EscapeJson,     // Экранирование строки JSON
+            EscapeLogfmt,   // Значение logfmt, при необходимости в кавычках
+        };
+
+        void formatText(const LoggerRecord &rec, QByteArray &dst);
+        void formatJson(const LoggerRecord &rec, QByteArray &dst);
+        void formatLogfmt(const LoggerRecord &rec, QByteArray &dst);
+        void formatPattern(const LoggerRecord &rec, QByteArray &dst);
+        void appendTime(int arg, QByteArray &dst);
+
+        void appendFieldsKv(const LoggerRecord &rec, QByteArray &dst);
+
+        const char *locationFile(const LoggerSourceLocation *loc) const;
+
+        void updateTimeCache(std::int64_t msecs);
+
+        static void appendUtf8(QByteArray &dst, const char *str, int size, Escape mode);
+        static void appendInt(QByteArray &dst, std::int64_t value);
+        static void appendUInt(QByteArray &dst, std::uint64_t value);
+        static void appendDouble(QByteArray &dst, double value);
+        static void appendDuration(QByteArray &dst, std::int64_t ns);
+        static void appendPadded(QByteArray &dst, int value, int width);
+        static bool needsQuotes(const char *str, int size);
+
+    private:
+        LoggerFormat m_format;              ///< Текущий формат записи
+        bool m_sourceFullPath;              ///< Выводить полный путь к файлу исходного кода
+
+        std::int64_t m_msecs;               ///< Время форматируемой записи, мс от начала эпохи
+        int m_nanos;                        ///< Наносекунды внутри секунды форматируемой записи
+        std::int64_t m_cachedSecs;          ///< Секунда, для которой заполнен кеш
+        char m_textTime[20];                ///< "dd.MM.yyyy hh:mm:ss"
+        char m_isoTime[20];                 ///< "yyyy-MM-ddThh:mm:ss"
+        char m_isoOffset[7];                ///< "+hh:mm"
+
+        std::vector<Step> m_steps;          ///< Шаги шаблона строки (пусто - стандартная строка)
+        QByteArray m_literals;              ///< Текст шаблона для шагов StepLiteral
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERFORMATTER_H
@@ -0,0 +1,199 @@
+#include "loggerframing.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define LOGGER_CRC32C_SSE42
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define LOGGER_CRC32C_ARM
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    /**
+     * @brief Таблицы табличного алгоритма (slicing-by-8)
+     */
+    struct Crc32cTables {
+        std::uint32_t t[8][256];
+
+        Crc32cTables() {
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t crc = i;
+                for (int k = 0; k < 8; ++k) {
+                    crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+                }
+                t[0][i] = crc;
+            }
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                for (int k = 1; k < 8; ++k) {
+                    t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+                }
+            }
+        }
+    };
+
+    std::uint32_t crc32c_soft(std::uint32_t crc, const unsigned char *p, std::size_t n) {
+        static const Crc32cTables tables;
+        const std::uint32_t (*t)[256] = tables.t;
+        while (n >= 8) {
+            std::uint32_t lo = static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8)
+                    | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+            const std::uint32_t hi = static_cast<std::uint32_t>(p[4]) | (static_cast<std::uint32_t>(p[5]) << 8)
+                    | (static_cast<std::uint32_t>(p[6]) << 16) | (static_cast<std::uint32_t>(p[7]) << 24);
+            lo ^= crc;
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+                ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+            p += 8;
+            n -= 8;
+        }
+        while (n-- > 0) {
+            crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+        }
+        return crc;
+    }
+
+#if defined(LOGGER_CRC32C_SSE42)
+    __attribute__((target("sse4.2")))
+    std::uint32_t crc32c_hw(std::uint32_t crc, const unsigned char *p, std::size_t n) {
+#if defined(__x86_64__)
+        std::uint64_t crc64 = crc;
+        while (n >= 8) {
+            std::uint64_t v;
+            std::memcpy(&v, p, 8);
+            crc64 = _mm_crc32_u64(crc64, v);
+            p += 8;
+            n -= 8;
+        }
+        crc = static_cast<std::uint32_t>(crc64);
+#endif
+        while (n >= 4) {
+            std::uint32_t v;
+            std::memcpy(&v, p, 4);
+            crc = _mm_crc32_u32(crc, v);
+            p += 4;
+            n -= 4;
+        }
+        while (n-- > 0) {
+            crc = _mm_crc32_u8(crc, *p++);
+        }
+        return crc;
+    }
+
+    bool has_hw_crc32c() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.2");
+    }
+#elif defined(LOGGER_CRC32C_ARM)
+    std::uint32_t crc32c_hw(std::uint32_t crc, const unsigned char *p, std::size_t n) {
+        while (n >= 8) {
+            std::uint64_t v;
+            std::memcpy(&v, p, 8);
+            crc = __crc32cd(crc, v);
+            p += 8;
+            n -= 8;
+        }
+        while (n-- > 0) {
+            crc = __crc32cb(crc, *p++);
+        }
+        return crc;
+    }
+
+    bool has_hw_crc32c() {
+        return true;
+    }
+#endif
+
+    const char hex_digits[] = "0123456789abcdef";
+
+    void put_hex32(char *dst, std::uint32_t value) {
+        for (int i = 7; i >= 0; --i) {
+            dst[i] = hex_digits[value & 0xF];
+            value >>= 4;
+        }
+    }
+
+    bool get_hex32(const char *src, std::uint32_t &value) {
+        value = 0;
+        for (int i = 0; i < 8; ++i) {
+            const char c = src[i];
+            std::uint32_t d;
+            if (c >= '0' && c <= '9') {
+                d = static_cast<std::uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                d = static_cast<std::uint32_t>(c - 'a' + 10);
+            } else {
+                return false;
+            }
+            value = (value << 4) | d;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Разбор строки-трейлера (без перевода строки)
+     */
+    bool parse_trailer(const char *p, std::uint32_t &length, std::uint32_t &crc) {
+        return std::memcmp(p, LoggerFraming::Magic, LoggerFraming::MagicSize) == 0
+                && get_hex32(p + LoggerFraming::MagicSize, length)
+                && p[LoggerFraming::MagicSize + 8] == ' '
+                && get_hex32(p + LoggerFraming::MagicSize + 9, crc);
+    }
+
+}
+
+    std::uint32_t loggerCrc32c(const char *data, std::size_t size, std::uint32_t crc) {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+#if defined(LOGGER_CRC32C_SSE42) || defined(LOGGER_CRC32C_ARM)
+        static const bool hw = has_hw_crc32c();
+        if (hw) {
+            return ~crc32c_hw(~crc, p, size);
+        }
+#endif
+        return ~crc32c_soft(~crc, p, size);
+    }
+
+    const char LoggerFraming::Magic[] = "#QLCRC ";
+
+    void LoggerFraming::appendTrailer(QByteArray &buf, int from) {
+        const int length = buf.size() - from;
+        const std::uint32_t crc = loggerCrc32c(buf.constData() + from, static_cast<std::size_t>(length));
+        char trailer[TrailerSize];
+        std::memcpy(trailer, Magic, MagicSize);
+        put_hex32(trailer + MagicSize, static_cast<std::uint32_t>(length));
+        trailer[MagicSize + 8] = ' ';
+        put_hex32(trailer + MagicSize + 9, crc);
+        trailer[TrailerSize - 1] = '\n';
+        buf.append(trailer, TrailerSize);
+    }
+
+    bool LoggerFraming::isTrailer(const char *line, std::int64_t size) {
+        std::uint32_t length;
+        std::uint32_t crc;
+        return (size == TrailerSize - 1 || (size == TrailerSize && line[TrailerSize - 1] == '\n'))
+                && parse_trailer(line, length, crc);
+    }
+
+    std::int64_t LoggerFraming::validEnd(const char *data, std::int64_t size, std::int64_t offset) {
+        for (std::int64_t q = size - TrailerSize; q >= 0; --q) {
+            if (data[q] != '#' || (q > 0 && data[q - 1] != '\n') || data[q + TrailerSize - 1] != '\n') {
+                continue;
+            }
+            std::uint32_t length;
+            std::uint32_t crc;
+            if (!parse_trailer(data + q, length, crc) || length > static_cast<std::uint64_t>(q + offset)) {
+                continue;
+            }
+            if (length > static_cast<std::uint64_t>(q)
+                    || loggerCrc32c(data + q - length, length) == crc) {
+                return q + TrailerSize;
+            }
+        }
+        return -1;
+    }
+
+}   // End namespace DIRA_3D_GW
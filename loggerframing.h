@@ -0,0 +1,73 @@
+#ifndef LOGGERFRAMING_H
+#define LOGGERFRAMING_H
+
+#include <QtCore/qglobal.h>
+#include <QByteArray>
+
+#include <cstddef>
+#include <cstdint>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+    /**
+     * @brief Вычисление CRC32C (полином Castagnoli)
+     * @remark Используются инструкции процессора (SSE4.2 на x86, CRC32 на ARMv8),
+     * если они доступны, иначе - табличный алгоритм.
+     *
+     * @param data Данные
+     * @param size Размер данных, байт
+     * @param crc CRC32C предыдущей части данных (0 - начало данных)
+     * @return CRC32C данных
+     */
+    std::uint32_t loggerCrc32c(const char *data, std::size_t size, std::uint32_t crc = 0);
+
+/*! \class Контрольные суммы пачек строк файла журнала
+ *  \brief После каждой записанной пачки строк в файл добавляется строка-трейлер
+ *     #QLCRC <длина пачки> <CRC32C пачки>\n
+ * (длина и сумма - 8 шестнадцатеричных цифр), покрывающая все байты пачки до
+ * трейлера. Файл остаётся текстовым; программы чтения журнала пропускают трейлеры
+ * (см. isTrailer()).
+ *     После аварийного завершения конец файла может содержать недописанную пачку.
+ * validEnd() находит последний трейлер, сумма которого совпадает с данными, - файл
+ * усекается до его конца.
+ */
+    class LoggerFraming {
+    public:
+        static const char Magic[];              ///< Начало строки-трейлера
+        static const int MagicSize = 7;         ///< Длина Magic, байт
+        static const int TrailerSize = 25;      ///< Длина строки-трейлера с переводом строки, байт
+
+        /**
+         * @brief Добавление трейлера пачки в конец буфера
+         *
+         * @param buf Буфер
+         * @param from Начало пачки в буфере
+         */
+        static void appendTrailer(QByteArray &buf, int from);
+
+        /**
+         * @brief Проверка того, что строка является трейлером пачки
+         *
+         * @param line Начало строки
+         * @param size Длина строки (с переводом строки или без), байт
+         */
+        static bool isTrailer(const char *line, std::int64_t size);
+
+        /**
+         * @brief Поиск конца последней целой пачки
+         * @remark Трейлеры просматриваются от конца данных к началу. Пачка, начало
+         * которой находится раньше data, считается целой, если её трейлер цел.
+         *
+         * @param data Конец файла журнала (или файл целиком)
+         * @param size Размер данных, байт
+         * @param offset Смещение data в файле журнала
+         * @return Смещение конца трейлера последней целой пачки относительно data
+         * или -1, если целых пачек нет
+         */
+        static std::int64_t validEnd(const char *data, std::int64_t size, std::int64_t offset);
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERFRAMING_H
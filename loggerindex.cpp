@@ -0,0 +1,198 @@
+#include "loggerindex.h"
+
+#include <QByteArray>
+
+#include <algorithm>
+#include <cstring>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    void put_int64(char *dst, std::int64_t value) {
+        const std::uint64_t v = static_cast<std::uint64_t>(value);
+        for (int i = 0; i < 8; ++i) {
+            dst[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+        }
+    }
+
+    std::int64_t get_int64(const char *src) {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) {
+            v |= static_cast<std::uint64_t>(static_cast<unsigned char>(src[i])) << (8 * i);
+        }
+        return static_cast<std::int64_t>(v);
+    }
+
+    /**
+     * @brief Разбор содержимого файла индекса
+     */
+    bool parse(const QByteArray &data, std::vector<LoggerIndex::Entry> &entries) {
+        entries.clear();
+        const std::size_t size = static_cast<std::size_t>(data.size());
+        if (size < sizeof(LoggerIndex::Magic)
+                || std::memcmp(data.constData(), LoggerIndex::Magic, sizeof(LoggerIndex::Magic)) != 0) {
+            return false;
+        }
+        // Неполная последняя запись (прерванная запись индекса) отбрасывается
+        const std::size_t count = (size - sizeof(LoggerIndex::Magic)) / LoggerIndex::EntrySize;
+        entries.reserve(count);
+        const char *p = data.constData() + sizeof(LoggerIndex::Magic);
+        for (std::size_t i = 0; i < count; ++i, p += LoggerIndex::EntrySize) {
+            entries.push_back(LoggerIndex::Entry{get_int64(p), get_int64(p + 8)});
+        }
+        return true;
+    }
+
+}
+
+    const char LoggerIndex::Magic[8] = { 'Q', 'L', 'G', 'I', 'D', 'X', '0', '1' };
+
+    LoggerIndex::LoggerIndex(): m_interval(0)
+                              , m_next(0)
+    {}
+
+    void LoggerIndex::setInterval(std::int64_t bytes) {
+        m_interval = bytes > 0 ? bytes : 0;
+    }
+
+    QString LoggerIndex::pathFor(const QString &logFile) {
+        return logFile + ".idx";
+    }
+
+    bool LoggerIndex::open(const QString &logFile, std::int64_t logSize) {
+        close();
+        if (m_interval <= 0) {
+            return false;
+        }
+
+        m_file.setFileName(pathFor(logFile));
+        m_next = 0;
+
+        std::vector<Entry> entries;
+        if (logSize > 0 && read(m_file.fileName(), entries)
+                && (entries.empty() || entries.back().offset < logSize)) {
+            if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+                return false;
+            }
+            // Неполная последняя запись отбрасывается
+            m_file.resize(static_cast<qint64>(sizeof(Magic) + entries.size() * EntrySize));
+            // Строки после последней записи индекса, записанные до перезапуска,
+            // остаются без записи - следующая запись через шаг от конца файла
+            m_next = entries.empty() ? logSize : std::max(entries.back().offset + m_interval, logSize);
+            return true;
+        }
+        // Индекс отсутствует или не соответствует файлу журнала. Если журнал не пуст,
+        // первая запись индекса появится со следующей строкой.
+        m_next = logSize;
+        return create();
+    }
+
+    bool LoggerIndex::create() {
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        m_file.write(Magic, sizeof(Magic));
+        m_file.flush();
+        return true;
+    }
+
+    void LoggerIndex::flush() {
+        if (m_pending.empty()) {
+            return;
+        }
+        if (m_file.isOpen()) {
+            char buf[EntrySize];
+            for (const Entry &e : m_pending) {
+                put_int64(buf, e.time);
+                put_int64(buf + 8, e.offset);
+                m_file.write(buf, EntrySize);
+            }
+            m_file.flush();
+        }
+        m_pending.clear();
+    }
+
+    bool LoggerIndex::rename(const QString &logFile) {
+        if (!m_file.isOpen()) {
+            return false;
+        }
+        flush();
+        m_file.close();
+        const QString target = pathFor(logFile);
+        QFile::remove(target);
+        return m_file.rename(target);
+    }
+
+    void LoggerIndex::truncateFront(std::int64_t cut) {
+        if (!m_file.isOpen()) {
+            return;
+        }
+        flush();
+        m_file.close();
+
+        std::vector<Entry> entries;
+        read(m_file.fileName(), entries);
+        if (!create()) {
+            return;
+        }
+        char buf[EntrySize];
+        m_next = 0;
+        for (const Entry &e : entries) {
+            if (e.offset < cut) {
+                continue;
+            }
+            put_int64(buf, e.time);
+            put_int64(buf + 8, e.offset - cut);
+            m_file.write(buf, EntrySize);
+            m_next = e.offset - cut + m_interval;
+        }
+        m_file.flush();
+    }
+
+    void LoggerIndex::close() {
+        if (m_file.isOpen()) {
+            flush();
+            m_file.close();
+        }
+        m_pending.clear();
+    }
+
+    bool LoggerIndex::read(const QString &indexFile, std::vector<Entry> &entries) {
+        QFile file(indexFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            entries.clear();
+            return false;
+        }
+        return parse(file.readAll(), entries);
+    }
+
+    bool LoggerIndex::write(const QString &indexFile, const std::vector<Entry> &entries) {
+        QFile file(indexFile);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        QByteArray data(static_cast<int>(sizeof(Magic) + entries.size() * EntrySize), '\0');
+        std::memcpy(data.data(), Magic, sizeof(Magic));
+        char *p = data.data() + sizeof(Magic);
+        for (const Entry &e : entries) {
+            put_int64(p, e.time);
+            put_int64(p + 8, e.offset);
+            p += EntrySize;
+        }
+        return file.write(data) == data.size();
+    }
+
+    std::int64_t LoggerIndex::seek(const std::vector<Entry> &entries, std::int64_t time) {
+        // Первая запись со временем не меньше time; строки раньше неё, но после
+        // предыдущей записи, ещё могут иметь время не меньше time
+        auto it = std::lower_bound(entries.begin(), entries.end(), time,
+                                   [](const Entry &e, std::int64_t t) { return e.time < t; });
+        if (it == entries.begin()) {
+            return 0;
+        }
+        return (it - 1)->offset;
+    }
+
+}   // End namespace DIRA_3D_GW
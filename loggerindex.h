@@ -0,0 +1,161 @@
+#ifndef LOGGERINDEX_H
+#define LOGGERINDEX_H
+
+#include <QString>
+#include <QFile>
+
+#include <cstdint>
+#include <vector>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Разреженный индекс файла журнала
+ *  \brief Для каждого файла журнала рядом с ним ведётся файл индекса
+ * ("<файл журнала>.idx"), в который записывается время и смещение первой строки
+ * после каждых interval байт журнала. По индексу можно двоичным поиском перейти к
+ * строкам заданного интервала времени, не просматривая файл журнала целиком.
+ *     Формат файла индекса: заголовок Magic (8 байт), далее записи по 16 байт -
+ * время строки (нс от начала эпохи) и смещение начала строки в файле журнала
+ * (оба - 64-битные целые со знаком, little-endian). Время записей не убывает.
+ *     Индекс дописывается потоком записи по мере записи журнала и переносится вместе
+ * с файлом журнала при ротации.
+ */
+    class LoggerIndex {
+    public:
+        //! Запись индекса
+        struct Entry {
+            std::int64_t time;      ///< Время первой строки, нс от начала эпохи
+            std::int64_t offset;    ///< Смещение начала строки в файле журнала, байт
+        };
+
+        static const char Magic[8];                 ///< Заголовок файла индекса
+        static const std::size_t EntrySize = 16;    ///< Размер записи в файле индекса, байт
+
+        LoggerIndex();
+
+        /**
+         * @brief Установка шага индекса
+         * @param bytes Шаг индекса, байт журнала. 0 - индекс не ведётся
+         */
+        void setInterval(std::int64_t bytes);
+
+        /**
+         * @brief Проверка того, что индекс ведётся
+         */
+        bool isEnabled() const      {   return m_interval > 0;  }
+
+        /**
+         * @brief Открытие индекса файла журнала
+         * @remark Существующий индекс продолжается, если он соответствует файлу журнала
+         * (не ссылается за его конец), иначе создаётся заново.
+         *
+         * @param logFile Путь к файлу журнала
+         * @param logSize Текущий размер файла журнала, байт
+         * @return true если индекс открыт или false в случае ошибок
+         */
+        bool open(const QString &logFile, std::int64_t logSize);
+
+        /**
+         * @brief Регистрация строки журнала
+         * @remark Строка попадает в индекс, если она начинается после очередной
+         * границы шага индекса.
+         *
+         * @param time Время строки, нс от начала эпохи
+         * @param offset Смещение начала строки в файле журнала
+         */
+        void add(std::int64_t time, std::int64_t offset) {
+            if (m_interval > 0 && offset >= m_next) {
+                m_pending.push_back(Entry{time, offset});
+                m_next = offset + m_interval;
+            }
+        }
+
+        /**
+         * @brief Запись накопленных записей в файл индекса
+         */
+        void flush();
+
+        /**
+         * @brief Отбрасывание накопленных записей
+         * @remark Вызывается, если строки, на которые они ссылаются, не записаны.
+         *
+         * @param logSize Фактический размер файла журнала
+         */
+        void discard(std::int64_t logSize) {
+            m_pending.clear();
+            m_next = logSize;
+        }
+
+        /**
+         * @brief Перенос индекса вслед за переименованным файлом журнала
+         * @remark Индекс закрывается; для нового файла журнала вызывается open().
+         *
+         * @param logFile Новый путь к файлу журнала
+         * @return true если индекс перенесён или false в случае ошибок
+         */
+        bool rename(const QString &logFile);
+
+        /**
+         * @brief Удаление начала индекса после удаления начала файла журнала
+         * @remark Записи, указывающие в удалённую часть, удаляются, смещения остальных
+         * уменьшаются на cut.
+         *
+         * @param cut Размер удалённой части файла журнала, байт
+         */
+        void truncateFront(std::int64_t cut);
+
+        /**
+         * @brief Закрытие индекса
+         */
+        void close();
+
+        /**
+         * @brief Путь к файлу индекса для файла журнала
+         */
+        static QString pathFor(const QString &logFile);
+
+        /**
+         * @brief Чтение файла индекса
+         *
+         * @param indexFile Путь к файлу индекса
+         * @param entries Записи индекса
+         * @return true если индекс прочитан или false если файл отсутствует или повреждён
+         */
+        static bool read(const QString &indexFile, std::vector<Entry> &entries);
+
+        /**
+         * @brief Запись файла индекса
+         * @remark Используется для индекса файла журнала, преобразованного целиком
+         * (например сжатого после ротации).
+         *
+         * @param indexFile Путь к файлу индекса
+         * @param entries Записи индекса
+         * @return true если индекс записан или false в случае ошибок
+         */
+        static bool write(const QString &indexFile, const std::vector<Entry> &entries);
+
+        /**
+         * @brief Поиск смещения, с которого начинаются строки не раньше заданного времени
+         * @remark Возвращает смещение последней записи индекса со временем меньше time
+         * (или 0, если такой записи нет). Строки со временем не меньше time не могут
+         * находиться до этого смещения.
+         *
+         * @param entries Записи индекса
+         * @param time Время, нс от начала эпохи
+         * @return Смещение в файле журнала, байт
+         */
+        static std::int64_t seek(const std::vector<Entry> &entries, std::int64_t time);
+
+    private:
+        bool create();
+
+        std::int64_t m_interval;            ///< Шаг индекса, байт
+        std::int64_t m_next;                ///< Смещение, после которого добавляется следующая запись
+        QFile m_file;                       ///< Файл индекса
+        std::vector<Entry> m_pending;       ///< Записи, ещё не записанные в файл
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERINDEX_H
@@ -0,0 +1,103 @@
+#include "loggerratelimiter.h"
+
+#include <chrono>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+    LoggerRateLimiter::LoggerRateLimiter(): m_interval(0)
+                                          , m_tolerance(0)
+    {
+        for (auto &slot : m_slots) {
+            slot.key.store(0, std::memory_order_relaxed);
+            slot.tat.store(0, std::memory_order_relaxed);
+            slot.dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void LoggerRateLimiter::setLimit(double perSecond, std::int32_t burst) {
+        if (perSecond <= 0) {
+            m_interval = 0;
+            m_tolerance = 0;
+            return;
+        }
+        if (burst <= 0) {
+            burst = perSecond < 1 ? 1 : static_cast<std::int32_t>(perSecond);
+        }
+        m_interval = static_cast<std::int64_t>(1e9 / perSecond);
+        m_tolerance = m_interval * burst;
+    }
+
+    bool LoggerRateLimiter::isEnabled() const {
+        return m_interval > 0;
+    }
+
+    bool LoggerRateLimiter::allow(const QString &sourceFile, std::int32_t sourceLine, std::uint64_t &suppressed) {
+        suppressed = 0;
+        if (m_interval <= 0 || (sourceFile.isEmpty() && sourceLine == -1)) {
+            return true;
+        }
+
+        // Старший бит ключа отличает места вызова, заданные строкой, от
+        // зарегистрированных LoggerSourceLocation
+        const std::uint64_t key = (static_cast<std::uint64_t>(qHash(sourceFile)) << 32)
+                                  ^ static_cast<std::uint32_t>(sourceLine)
+                                  ^ (1ULL << 63);
+        return allowKey(key, suppressed);
+    }
+
+    bool LoggerRateLimiter::allow(std::uint32_t sourceId, std::uint64_t &suppressed) {
+        suppressed = 0;
+        if (m_interval <= 0 || sourceId == 0) {
+            return true;
+        }
+        return allowKey(sourceId, suppressed);
+    }
+
+    bool LoggerRateLimiter::allowKey(std::uint64_t key, std::uint64_t &suppressed) {
+        Slot *slot = findSlot(key);
+        if (slot == nullptr) {
+            return true;
+        }
+
+        const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        std::int64_t tat = slot->tat.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::int64_t newTat = (tat > now ? tat : now) + m_interval;
+            if (newTat - now > m_tolerance) {
+                slot->dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (slot->tat.compare_exchange_weak(tat, newTat, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        if (slot->dropped.load(std::memory_order_relaxed) != 0) {
+            suppressed = slot->dropped.exchange(0, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    LoggerRateLimiter::Slot *LoggerRateLimiter::findSlot(std::uint64_t key) {
+        std::uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+        for (int i = 0; i < MaxProbes; ++i) {
+            Slot &slot = m_slots[(h >> 32) % SlotsCount];
+            std::uint64_t cur = slot.key.load(std::memory_order_acquire);
+            if (cur == key) {
+                return &slot;
+            }
+            if (cur == 0) {
+                if (slot.key.compare_exchange_strong(cur, key, std::memory_order_acq_rel)
+                        || cur == key) {
+                    return &slot;
+                }
+            }
+            h += 0x100000000ULL;
+        }
+        return nullptr;
+    }
+
+}   // End namespace DIRA_3D_GW
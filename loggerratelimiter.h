@@ -0,0 +1,83 @@
+#ifndef LOGGERRATELIMITER_H
+#define LOGGERRATELIMITER_H
+
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Ограничение частоты сообщений для каждого места вызова
+ *  \brief Реализует алгоритм "token bucket" (в виде GCRA) отдельно для каждого места
+ * вызова, которое идентифицируется именем файла исходного кода и номером строки.
+ *     Проверка выполняется без блокировок: состояние каждого места вызова хранится
+ * в ячейке таблицы фиксированного размера и обновляется атомарными операциями.
+ * Если свободных ячеек не осталось, сообщения нового места вызова не ограничиваются.
+ */
+    class LoggerRateLimiter {
+    public:
+        LoggerRateLimiter();
+
+        /**
+         * @brief Установка ограничения частоты сообщений
+         * @remark Должна вызываться до начала ведения журнала.
+         *
+         * @param perSecond Допустимое количество сообщений в секунду для одного места
+         * вызова. Значение <= 0 отключает ограничение.
+         * @param burst Количество сообщений, которое может быть записано подряд без
+         * ограничения. Значение <= 0 соответствует perSecond.
+         */
+        void setLimit(double perSecond, std::int32_t burst = 0);
+
+        /**
+         * @brief Проверка того, что ограничение частоты включено
+         */
+        bool isEnabled() const;
+
+        /**
+         * @brief Проверка возможности записи сообщения из указанного места вызова
+         *
+         * @param sourceFile Имя файла исходного кода
+         * @param sourceLine Номер строки кода
+         * @param suppressed Количество сообщений этого места вызова, отброшенных с
+         * момента последнего разрешённого сообщения
+         * @return true если сообщение можно записать или false если его необходимо
+         * отбросить
+         */
+        bool allow(const QString &sourceFile, std::int32_t sourceLine, std::uint64_t &suppressed);
+
+        /**
+         * @brief Проверка возможности записи сообщения из зарегистрированного места вызова
+         *
+         * @param sourceId Идентификатор места вызова LoggerSourceLocation
+         * @param suppressed Количество сообщений этого места вызова, отброшенных с
+         * момента последнего разрешённого сообщения
+         * @return true если сообщение можно записать или false если его необходимо
+         * отбросить
+         */
+        bool allow(std::uint32_t sourceId, std::uint64_t &suppressed);
+
+    private:
+        //! Состояние одного места вызова
+        struct Slot {
+            std::atomic<std::uint64_t> key;      ///< Ключ места вызова (0 - ячейка свободна)
+            std::atomic<std::int64_t> tat;       ///< Теоретическое время следующего сообщения, нс
+            std::atomic<std::uint64_t> dropped;  ///< Количество отброшенных сообщений
+        };
+
+        static const int SlotsCount = 1024;     ///< Размер таблицы мест вызова
+        static const int MaxProbes = 16;        ///< Максимальная длина поиска ячейки
+
+        bool allowKey(std::uint64_t key, std::uint64_t &suppressed);
+        Slot *findSlot(std::uint64_t key);
+
+        Slot m_slots[SlotsCount];           ///< Таблица мест вызова
+        std::int64_t m_interval;            ///< Интервал между сообщениями, нс
+        std::int64_t m_tolerance;           ///< Допустимое опережение (burst * интервал), нс
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERRATELIMITER_H
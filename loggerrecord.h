@@ -0,0 +1,270 @@
+#ifndef LOGGERRECORD_H
+#define LOGGERRECORD_H
+
+#include <QString>
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+
+#include "loggertypes.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/**
+ * \struct Запись очереди сообщений журнала
+ * \brief Содержит все данные сообщения в исходном виде. Преобразование записи в
+ * строку файла журнала выполняется в потоке записи.
+ *     Запись размещается в ячейке LoggerArena (или, если не помещается в ячейку, в
+ * отдельном блоке памяти) и не содержит объектов с динамической памятью: заголовок
+ * записи сразу продолжается данными, в которых последовательно хранятся текст
+ * сообщения и имя файла исходного кода в UTF-8, а так же поля сообщения.
+ *     Поля структурированного сообщения хранятся в компактном двоичном виде:
+ * [тип (1 байт)][указатель на имя][значение (8 байт)] для чисел и длительностей и
+ * [тип (1 байт)][указатель на имя][длина (4 байта)][UTF-8 байты] для строк.
+ *     Записи связываются в очередь через указатель next.
+ */
+struct LoggerRecord
+{
+    LoggerRecord *next = nullptr;               ///< Следующая запись в очереди
+    std::int64_t time = 0;                      ///< Время регистрации сообщения, нс от начала эпохи
+                                                ///< (до обработки потоком записи - показание источника времени)
+    const char *threadName = nullptr;           ///< Имя потока-источника (строка со статическим временем жизни)
+    LoggerLevel level = LoggerLevel::Warning;   ///< Уровень сообщения
+    std::int32_t sourceLine = -1;               ///< Номер строки в файле исходного кода
+    std::uint32_t sourceId = 0;                 ///< Идентификатор места вызова (LoggerSourceLocation)
+    std::uint32_t messageSize = 0;              ///< Длина текста сообщения, байт
+    std::uint32_t sourceFileSize = 0;           ///< Длина имени файла исходного кода, байт
+    std::uint32_t fieldsSize = 0;               ///< Размер полей сообщения, байт
+    std::uint32_t capacity = 0;                 ///< Размер области данных записи, байт
+    std::uint32_t threadId = 0;                 ///< Идентификатор потока-источника (0 - не записывается)
+    bool fromHeap = false;                      ///< Запись размещена вне LoggerArena
+    std::uint8_t sizeClass = 0;                 ///< Класс размера ячейки LoggerArena
+    bool preformatted = false;                  ///< Текст сообщения - готовая строка файла журнала
+
+    //! Размер поля с числовым значением в двоичном представлении
+    static const std::size_t NumericFieldSize = 1 + sizeof(const char *) + 8;
+
+    char *data()                        {   return reinterpret_cast<char *>(this + 1);          }
+    const char *data() const            {   return reinterpret_cast<const char *>(this + 1);    }
+    const char *message() const         {   return data();                                      }
+    const char *sourceFile() const      {   return data() + messageSize;                        }
+    const char *fields() const          {   return data() + messageSize + sourceFileSize;       }
+
+    /**
+     * @brief Оценка сверху размера данных записи
+     * @remark Используется для выбора ячейки до преобразования строк в UTF-8.
+     *
+     * @param message Текст сообщения
+     * @param sourceFile Имя файла исходного кода
+     * @param list Поля сообщения
+     * @param extraNumeric Количество дополнительных числовых полей
+     * @return Размер области данных, достаточный для записи
+     */
+    static std::size_t payloadBound(const QString &message,
+                                    const QString &sourceFile,
+                                    std::initializer_list<LoggerField> list,
+                                    int extraNumeric = 0) {
+        // Точный размер UTF-8 вместо оценки 3 байта на символ: с оценкой сообщения
+        // ASCII длиннее ~50 символов не помещались бы в ячейку наименьшего класса
+        std::size_t size = utf8Size(message) + utf8Size(sourceFile)
+                           + NumericFieldSize * static_cast<std::size_t>(extraNumeric);
+        for (const auto &f : list) {
+            size += NumericFieldSize;
+            if (f.type() == LoggerField::String) {
+                size += utf8Size(f.toString());
+            }
+        }
+        return size;
+    }
+
+    /**
+     * @brief Запись текста сообщения и имени файла исходного кода
+     * @remark Удаляет ранее добавленные поля. Область данных должна вмещать
+     * payloadBound() байт.
+     *
+     * @param msg Текст сообщения
+     * @param file Имя файла исходного кода
+     */
+    void assign(const QString &msg, const QString &file) {
+        messageSize = encodeUtf8(msg, data());
+        sourceFileSize = encodeUtf8(file, data() + messageSize);
+        fieldsSize = 0;
+    }
+
+    /**
+     * @brief Добавление поля в двоичное представление записи
+     *
+     * @param f Поле сообщения
+     */
+    void appendField(const LoggerField &f) {
+        char *p = data() + messageSize + sourceFileSize + fieldsSize;
+        const char type = static_cast<char>(f.type());
+        const char *key = f.key();
+        *p++ = type;
+        std::memcpy(p, &key, sizeof(key));
+        p += sizeof(key);
+        if (f.type() == LoggerField::String) {
+            const std::uint32_t len = encodeUtf8(f.toString(), p + sizeof(len));
+            std::memcpy(p, &len, sizeof(len));
+            p += sizeof(len) + len;
+        } else if (f.type() == LoggerField::Double) {
+            const double v = f.toDouble();
+            std::memcpy(p, &v, sizeof(v));
+            p += sizeof(v);
+        } else {
+            const std::int64_t v = f.toInt();
+            std::memcpy(p, &v, sizeof(v));
+            p += sizeof(v);
+        }
+        fieldsSize = static_cast<std::uint32_t>(p - fields());
+    }
+
+    /**
+     * @brief Добавление полей в двоичное представление записи
+     *
+     * @param list Список полей сообщения
+     */
+    void appendFields(std::initializer_list<LoggerField> list) {
+        for (const auto &f : list) {
+            appendField(f);
+        }
+    }
+
+    /**
+     * @brief Сравнение сообщений без учёта времени регистрации
+     * @return true если уровень, текст, место вызова и поля сообщений совпадают
+     */
+    bool sameMessage(const LoggerRecord &other) const {
+        const std::uint32_t size = messageSize + sourceFileSize + fieldsSize;
+        return level == other.level && sourceLine == other.sourceLine && sourceId == other.sourceId
+                && messageSize == other.messageSize && sourceFileSize == other.sourceFileSize
+                && fieldsSize == other.fieldsSize
+                && std::memcmp(data(), other.data(), size) == 0;
+    }
+
+    /**
+     * @brief Размер строки в UTF-8 (результат encodeUtf8())
+     */
+    static std::size_t utf8Size(const QString &src) {
+        std::size_t size = 0;
+        const QChar *p = src.constData();
+        const QChar *end = p + src.size();
+        for (; p != end; ++p) {
+            const std::uint32_t uc = p->unicode();
+            if (uc < 0x80) {
+                size += 1;
+            } else if (uc < 0x800) {
+                size += 2;
+            } else if (p->isHighSurrogate() && p + 1 != end && (p + 1)->isLowSurrogate()) {
+                ++p;
+                size += 4;
+            } else {
+                size += 3;
+            }
+        }
+        return size;
+    }
+
+    /**
+     * @brief Преобразование строки в UTF-8 без выделения памяти
+     *
+     * @param src Исходная строка
+     * @param dst Буфер размером не менее utf8Size(src) байт
+     * @return Количество записанных байт
+     */
+    static std::uint32_t encodeUtf8(const QString &src, char *dst) {
+        char *out = dst;
+        const QChar *p = src.constData();
+        const QChar *end = p + src.size();
+        for (; p != end; ++p) {
+            std::uint32_t uc = p->unicode();
+            if (uc < 0x80) {
+                *out++ = static_cast<char>(uc);
+            } else if (uc < 0x800) {
+                *out++ = static_cast<char>(0xC0 | (uc >> 6));
+                *out++ = static_cast<char>(0x80 | (uc & 0x3F));
+            } else if (p->isHighSurrogate() && p + 1 != end && (p + 1)->isLowSurrogate()) {
+                uc = QChar::surrogateToUcs4(*p, *(p + 1));
+                ++p;
+                *out++ = static_cast<char>(0xF0 | (uc >> 18));
+                *out++ = static_cast<char>(0x80 | ((uc >> 12) & 0x3F));
+                *out++ = static_cast<char>(0x80 | ((uc >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (uc & 0x3F));
+            } else {
+                *out++ = static_cast<char>(0xE0 | (uc >> 12));
+                *out++ = static_cast<char>(0x80 | ((uc >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (uc & 0x3F));
+            }
+        }
+        return static_cast<std::uint32_t>(out - dst);
+    }
+};
+
+/**
+ * \class Последовательное чтение полей из двоичного представления записи
+ * \brief Не выполняет копирования данных: строковые значения возвращаются
+ * указателем на UTF-8 байты внутри записи.
+ */
+class LoggerFieldReader
+{
+public:
+    explicit LoggerFieldReader(const LoggerRecord &rec)
+        : m_cur(rec.fields()), m_end(rec.fields() + rec.fieldsSize) {}
+
+    /**
+     * @brief Переход к следующему полю
+     * @return true если поле прочитано или false если поля закончились
+     */
+    bool next() {
+        if (m_end - m_cur < static_cast<std::ptrdiff_t>(1 + sizeof(const char *))) {
+            return false;
+        }
+        m_type = static_cast<LoggerField::Type>(*m_cur++);
+        std::memcpy(&m_key, m_cur, sizeof(m_key));
+        m_cur += sizeof(m_key);
+        if (m_type == LoggerField::String) {
+            std::uint32_t len = 0;
+            std::memcpy(&len, m_cur, sizeof(len));
+            m_cur += sizeof(len);
+            m_str = m_cur;
+            m_strSize = static_cast<int>(len);
+            m_cur += len;
+        } else {
+            std::memcpy(&m_value, m_cur, sizeof(m_value));
+            m_cur += sizeof(m_value);
+        }
+        return true;
+    }
+
+    const char *key() const         {   return m_key;       }
+    LoggerField::Type type() const  {   return m_type;      }
+    const char *str() const         {   return m_str;       }
+    int strSize() const             {   return m_strSize;   }
+
+    std::int64_t toInt() const {
+        std::int64_t v;
+        std::memcpy(&v, m_value, sizeof(v));
+        return v;
+    }
+
+    double toDouble() const {
+        double v;
+        std::memcpy(&v, m_value, sizeof(v));
+        return v;
+    }
+
+private:
+    const char *m_cur;
+    const char *m_end;
+    const char *m_key = nullptr;
+    LoggerField::Type m_type = LoggerField::Int;
+    char m_value[8] = {};
+    const char *m_str = nullptr;
+    int m_strSize = 0;
+};
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERRECORD_H
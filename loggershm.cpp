@@ -0,0 +1,381 @@
+#include "loggershm.h"
+
+#include <QByteArray>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#if defined(Q_OS_UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+    /**
+     * \struct Заголовок буфера в разделяемой памяти
+     * \brief Поля писателя и читателя разнесены по разным строкам кэша.
+     */
+    struct LoggerShmRing::Shared {
+        std::atomic<std::uint32_t> state;           ///< 0 - не инициализирован, 1 - инициализируется, 2 - готов
+        std::uint32_t magic;                        ///< Признак буфера
+        std::uint32_t version;                      ///< Версия формата
+        std::uint64_t capacity;                     ///< Размер области кадров, байт
+
+        alignas(64) std::atomic<std::uint64_t> head;    ///< Конец записанных кадров
+        std::atomic<std::uint32_t> seq;                 ///< Счётчик пробуждений (futex)
+        std::atomic<std::uint32_t> consumerWaiting;     ///< Читатель ожидает кадров
+        std::atomic<std::int64_t> producerPid;          ///< Процесс-писатель (0 - не подключен)
+        std::atomic<std::uint64_t> dropped;             ///< Отброшено строк
+
+        alignas(64) std::atomic<std::uint64_t> tail;    ///< Начало непрочитанных кадров
+        std::atomic<std::int64_t> consumerPid;          ///< Процесс-читатель (0 - не подключен)
+    };
+
+namespace {
+
+    const std::uint32_t Magic = 0x514C5352;     // "QLSR"
+    const std::uint32_t Version = 1;
+    const std::size_t HeaderSize = 4096;
+    const std::uint64_t Align = 16;
+    const std::int32_t PadLevel = -0x7FFFFFFF;
+
+    //! Заголовок кадра
+    struct FrameHeader {
+        std::uint32_t size;     ///< Размер строки или размер пропуска до конца области
+        std::int32_t level;     ///< Уровень сообщения или PadLevel
+        std::int64_t time;      ///< Время строки, нс от начала эпохи
+    };
+
+    std::uint64_t align_up(std::uint64_t value) {
+        return (value + Align - 1) & ~(Align - 1);
+    }
+
+    std::uint64_t frame_size(std::uint64_t size) {
+        return align_up(sizeof(FrameHeader) + size);
+    }
+
+#if defined(Q_OS_UNIX)
+    QByteArray shm_name(const QString &name) {
+        QByteArray n = name.toLocal8Bit();
+        if (!n.startsWith('/')) {
+            n.prepend('/');
+        }
+        return n;
+    }
+
+    bool process_alive(std::int64_t pid) {
+        return pid > 0 && (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM);
+    }
+#endif
+
+#if defined(Q_OS_LINUX)
+    // Буфер разделяется между процессами, поэтому используются не-PRIVATE операции futex
+    void futex_wait(std::atomic<std::uint32_t> *addr, std::uint32_t expected, std::chrono::milliseconds timeout) {
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+        ts.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(addr), FUTEX_WAIT, expected, &ts, nullptr, 0);
+    }
+
+    void futex_wake(std::atomic<std::uint32_t> *addr) {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+#endif
+
+}
+
+    const int LoggerShmRing::MaxWaitMs;
+
+    LoggerShmRing::LoggerShmRing() {}
+
+    LoggerShmRing::~LoggerShmRing() {
+        close();
+    }
+
+    bool LoggerShmRing::open(const QString &name, std::int64_t capacity, bool producer) {
+        close();
+#if defined(Q_OS_UNIX)
+        const QByteArray path = shm_name(name);
+        const int fd = shm_open(path.constData(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0) {
+            qWarning("Cannot open the shared memory %s: %s", path.constData(), std::strerror(errno));
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size == 0) {
+            std::uint64_t area = Align;
+            while (area * 2 <= static_cast<std::uint64_t>(std::max<std::int64_t>(capacity, 64 * 1024))) {
+                area *= 2;
+            }
+            if (ftruncate(fd, static_cast<off_t>(HeaderSize + area)) != 0) {
+                qWarning("Cannot resize the shared memory %s: %s", path.constData(), std::strerror(errno));
+            }
+        }
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) <= HeaderSize) {
+            ::close(fd);
+            return false;
+        }
+        void *mem = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED) {
+            qWarning("Cannot map the shared memory %s: %s", path.constData(), std::strerror(errno));
+            return false;
+        }
+        Shared *shared = static_cast<Shared *>(mem);
+        const std::size_t mapSize = static_cast<std::size_t>(st.st_size);
+
+        // Заголовок инициализирует первый подключившийся процесс
+        std::uint32_t expected = 0;
+        if (shared->state.compare_exchange_strong(expected, 1)) {
+            std::uint64_t area = Align;
+            while (area * 2 <= mapSize - HeaderSize) {
+                area *= 2;
+            }
+            shared->magic = Magic;
+            shared->version = Version;
+            shared->capacity = area;
+            shared->head.store(0, std::memory_order_relaxed);
+            shared->seq.store(0, std::memory_order_relaxed);
+            shared->consumerWaiting.store(0, std::memory_order_relaxed);
+            shared->producerPid.store(0, std::memory_order_relaxed);
+            shared->dropped.store(0, std::memory_order_relaxed);
+            shared->tail.store(0, std::memory_order_relaxed);
+            shared->consumerPid.store(0, std::memory_order_relaxed);
+            shared->state.store(2, std::memory_order_release);
+        } else {
+            for (int i = 0; i < 1000 && shared->state.load(std::memory_order_acquire) != 2; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        if (shared->state.load(std::memory_order_acquire) != 2 || shared->magic != Magic
+                || shared->version != Version || (shared->capacity & (shared->capacity - 1)) != 0
+                || HeaderSize + shared->capacity > mapSize) {
+            qWarning("The shared memory %s is not a log ring", path.constData());
+            munmap(mem, mapSize);
+            return false;
+        }
+
+        m_shared = shared;
+        m_data = static_cast<char *>(mem) + HeaderSize;
+        m_capacity = shared->capacity;
+        m_mapSize = mapSize;
+        m_producer = producer;
+        if (producer) {
+            // Кадры предыдущего писателя, не успевшие стать видимыми, перезаписываются
+            m_pos = shared->head.load(std::memory_order_acquire);
+            m_stalled = false;
+            shared->producerPid.store(getpid(), std::memory_order_release);
+        } else {
+            m_pos = m_next = shared->tail.load(std::memory_order_acquire);
+            shared->consumerPid.store(getpid(), std::memory_order_release);
+        }
+        return true;
+#else
+        Q_UNUSED(name);
+        Q_UNUSED(capacity);
+        Q_UNUSED(producer);
+        qWarning("Shared memory log ring is not supported on this platform");
+        return false;
+#endif
+    }
+
+    void LoggerShmRing::close() {
+#if defined(Q_OS_UNIX)
+        if (!m_shared) {
+            return;
+        }
+        if (m_producer) {
+            wake();
+            m_shared->producerPid.store(0, std::memory_order_release);
+        } else {
+            m_shared->consumerPid.store(0, std::memory_order_release);
+        }
+        munmap(m_shared, m_mapSize);
+        m_shared = nullptr;
+        m_data = nullptr;
+        m_capacity = 0;
+        m_mapSize = 0;
+#endif
+    }
+
+    bool LoggerShmRing::remove(const QString &name) {
+#if defined(Q_OS_UNIX)
+        return shm_unlink(shm_name(name).constData()) == 0;
+#else
+        Q_UNUSED(name);
+        return false;
+#endif
+    }
+
+    bool LoggerShmRing::waitSpace(std::uint64_t need) {
+#if defined(Q_OS_UNIX)
+        std::uint64_t tail = m_shared->tail.load(std::memory_order_acquire);
+        if (m_pos + need - tail <= m_capacity) {
+            m_stalled = false;
+            return true;
+        }
+        // После истечения ожидания строки отбрасываются сразу, пока сборщик не
+        // освободит часть буфера: иначе каждая строка ждала бы MaxWaitMs
+        if (m_stalled && tail == m_stalledTail) {
+            return false;
+        }
+        m_stalled = false;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(MaxWaitMs);
+        while (m_pos + need - tail > m_capacity) {
+            // Без сборщика ожидание бессмысленно: строки отбрасываются сразу
+            if (!process_alive(m_shared->consumerPid.load(std::memory_order_acquire))) {
+                return false;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                m_stalled = true;
+                m_stalledTail = tail;
+                return false;
+            }
+            wake();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            tail = m_shared->tail.load(std::memory_order_acquire);
+        }
+        return true;
+#else
+        Q_UNUSED(need);
+        return false;
+#endif
+    }
+
+    bool LoggerShmRing::push(std::int64_t time, LoggerLevel level, const char *data, int size) {
+        if (!m_shared || size < 0) {
+            return false;
+        }
+        const std::uint64_t lineSize = std::min<std::uint64_t>(static_cast<std::uint64_t>(size),
+                                                               m_capacity / 4 - sizeof(FrameHeader));
+        const std::uint64_t total = frame_size(lineSize);
+        const std::uint64_t offset = m_pos & (m_capacity - 1);
+        const std::uint64_t pad = offset + total > m_capacity ? m_capacity - offset : 0;
+        if (!waitSpace(pad + total)) {
+            m_shared->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Кадр хранится непрерывно: остаток в конце области пропускается
+        if (pad != 0) {
+            const FrameHeader header{static_cast<std::uint32_t>(pad), PadLevel, 0};
+            std::memcpy(m_data + offset, &header, sizeof(header));
+            m_pos += pad;
+        }
+        char *dst = m_data + (m_pos & (m_capacity - 1));
+        const FrameHeader header{static_cast<std::uint32_t>(lineSize), static_cast<std::int32_t>(level), time};
+        std::memcpy(dst, &header, sizeof(header));
+        std::memcpy(dst + sizeof(header), data, lineSize);
+        m_pos += total;
+        // Кадр виден сборщику сразу, а не в конце пачки: при аварийном завершении
+        // приложения теряются только строки, не записанные в буфер
+        m_shared->head.store(m_pos, std::memory_order_release);
+        return true;
+    }
+
+    void LoggerShmRing::wake() {
+        if (!m_shared) {
+            return;
+        }
+        m_shared->seq.fetch_add(1, std::memory_order_seq_cst);
+#if defined(Q_OS_LINUX)
+        if (m_shared->consumerWaiting.load(std::memory_order_seq_cst) != 0) {
+            futex_wake(&m_shared->seq);
+        }
+#endif
+    }
+
+    std::uint64_t LoggerShmRing::dropped() const {
+        return m_shared ? m_shared->dropped.load(std::memory_order_relaxed) : 0;
+    }
+
+    bool LoggerShmRing::peek(Frame &frame) {
+        if (!m_shared) {
+            return false;
+        }
+        for (;;) {
+            const std::uint64_t head = m_shared->head.load(std::memory_order_acquire);
+            if (m_pos == head) {
+                return false;
+            }
+            FrameHeader header;
+            std::memcpy(&header, m_data + (m_pos & (m_capacity - 1)), sizeof(header));
+            const std::uint64_t size = header.level == PadLevel ? header.size : frame_size(header.size);
+            if (size == 0 || size > head - m_pos || (m_pos & (m_capacity - 1)) + size > m_capacity) {
+                // Повреждённый кадр: непрочитанные кадры пропускаются
+                qWarning("Shared memory log ring is corrupted, %llu bytes skipped",
+                         static_cast<unsigned long long>(head - m_pos));
+                m_pos = m_next = head;
+                return false;
+            }
+            if (header.level == PadLevel) {
+                m_pos += size;
+                continue;
+            }
+            frame.time = header.time;
+            frame.level = static_cast<LoggerLevel>(header.level);
+            frame.data = m_data + (m_pos & (m_capacity - 1)) + sizeof(header);
+            frame.size = static_cast<int>(header.size);
+            m_next = m_pos + size;
+            return true;
+        }
+    }
+
+    void LoggerShmRing::consume() {
+        if (!m_shared) {
+            return;
+        }
+        m_pos = m_next;
+    }
+
+    void LoggerShmRing::release(std::uint64_t position) {
+        if (!m_shared) {
+            return;
+        }
+        m_shared->tail.store(std::min(position, m_pos), std::memory_order_release);
+    }
+
+    bool LoggerShmRing::wait(std::chrono::milliseconds timeout) {
+        if (!m_shared) {
+            return false;
+        }
+        const std::uint32_t seen = m_shared->seq.load(std::memory_order_acquire);
+        if (m_shared->head.load(std::memory_order_acquire) != m_pos) {
+            return true;
+        }
+#if defined(Q_OS_LINUX)
+        m_shared->consumerWaiting.store(1, std::memory_order_seq_cst);
+        futex_wait(&m_shared->seq, seen, timeout);
+        m_shared->consumerWaiting.store(0, std::memory_order_relaxed);
+#else
+        Q_UNUSED(seen);
+        std::this_thread::sleep_for(std::min(timeout, std::chrono::milliseconds(10)));
+#endif
+        return m_shared->head.load(std::memory_order_acquire) != m_pos;
+    }
+
+    bool LoggerShmRing::producerAlive() const {
+#if defined(Q_OS_UNIX)
+        return m_shared && process_alive(m_shared->producerPid.load(std::memory_order_acquire));
+#else
+        return false;
+#endif
+    }
+
+}   // End namespace DIRA_3D_GW
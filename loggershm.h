@@ -0,0 +1,167 @@
+#ifndef LOGGERSHM_H
+#define LOGGERSHM_H
+
+#include <QtCore/qglobal.h>
+#include <QString>
+
+#include <chrono>
+#include <cstdint>
+
+#include "loggertypes.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Кольцевой буфер строк журнала в разделяемой памяти
+ *  \brief Передаёт отформатированные строки журнала из приложения (поток записи
+ * Logger) в отдельный процесс-сборщик (qt-logger-collector), который выполняет запись
+ * файлов, ротацию и синхронизацию с диском.
+ *     Буфер - объект POSIX shared memory (shm_open) с одним писателем и одним
+ * читателем. Каждая строка хранится кадром [размер][уровень][время][строка];
+ * строка становится видимой сборщику сразу после записи кадра, поэтому при аварийном
+ * завершении приложения сборщик сохраняет все строки, попавшие в буфер.
+ *     Сборщик освобождает кадры (release()) только после записи их строк, поэтому
+ * объём строк, прочитанных, но ещё не записанных сборщиком, ограничен размером
+ * буфера, а при аварийном завершении сборщика незаписанные строки остаются в буфере.
+ *     Если буфер заполнен, писатель ждёт сборщика не дольше MaxWaitMs; если сборщик
+ * не подключён или не успевает, строки отбрасываются с учётом в dropped(). После
+ * неудачного ожидания следующие строки отбрасываются без ожидания, пока сборщик не
+ * освободит часть буфера.
+ *     Буфер сохраняется после завершения обоих процессов (до remove()): сборщик,
+ * запущенный позже приложения, получает накопленные строки, а перезапущенное
+ * приложение продолжает запись в тот же буфер.
+ *     Поддерживается только на Unix-платформах; ожидание сборщика без опроса - в Linux.
+ */
+    class LoggerShmRing {
+    public:
+        //! Кадр буфера
+        struct Frame {
+            std::int64_t time = 0;                          ///< Время строки, нс от начала эпохи
+            LoggerLevel level = LoggerLevel::Developer;     ///< Уровень сообщения
+            const char *data = nullptr;                     ///< Строка (указывает в буфер)
+            int size = 0;                                   ///< Размер строки, байт
+        };
+
+        static const std::int64_t DefaultCapacity = 4 * 1024 * 1024;   ///< Размер буфера по умолчанию, байт
+        static const int MaxWaitMs = 1000;                              ///< Максимальное ожидание места в буфере, мс
+
+        LoggerShmRing();
+
+        /**
+         * @brief Деструктор
+         * @remark Отключается от буфера, не удаляя его.
+         */
+        ~LoggerShmRing();
+
+        LoggerShmRing(const LoggerShmRing &) = delete;
+        LoggerShmRing &operator=(const LoggerShmRing &) = delete;
+
+        /**
+         * @brief Подключение к буферу (создание, если буфера нет)
+         * @remark Размер существующего буфера не меняется.
+         *
+         * @param name Имя объекта разделяемой памяти ("/qt-logger-app")
+         * @param capacity Размер области строк нового буфера, байт (округляется вниз
+         * до степени двойки)
+         * @param producer true - писатель (приложение), false - читатель (сборщик)
+         * @return true если буфер подключен или false в случае ошибок
+         */
+        bool open(const QString &name, std::int64_t capacity, bool producer);
+
+        /**
+         * @brief Отключение от буфера
+         */
+        void close();
+
+        /**
+         * @brief Проверка подключения к буферу
+         */
+        bool isOpen() const     {   return m_shared != nullptr; }
+
+        /**
+         * @brief Удаление объекта разделяемой памяти
+         * @remark Подключенные процессы продолжают работать со своим отображением.
+         */
+        static bool remove(const QString &name);
+
+        /**
+         * @brief Запись строки (писатель)
+         * @remark Строки длиннее четверти буфера обрезаются.
+         *
+         * @param time Время строки, нс от начала эпохи
+         * @param level Уровень сообщения
+         * @param data Строка
+         * @param size Размер строки, байт
+         * @return true если строка записана или false если она отброшена
+         */
+        bool push(std::int64_t time, LoggerLevel level, const char *data, int size);
+
+        /**
+         * @brief Пробуждение ожидающего сборщика (писатель, один раз на пачку строк)
+         */
+        void wake();
+
+        /**
+         * @brief Количество строк, отброшенных писателями буфера
+         */
+        std::uint64_t dropped() const;
+
+        /**
+         * @brief Чтение следующего кадра без его освобождения (читатель)
+         *
+         * @param frame Кадр (действителен до вызова consume())
+         * @return true если кадр прочитан или false если буфер пуст
+         */
+        bool peek(Frame &frame);
+
+        /**
+         * @brief Переход к кадру, следующему за прочитанным peek() (читатель)
+         * @remark Кадр остаётся занятым до вызова release(): писатель не может
+         * использовать его место, пока сборщик не записал строку.
+         */
+        void consume();
+
+        /**
+         * @brief Позиция чтения (читатель)
+         * @return Позиция после последнего кадра, пройденного consume()
+         */
+        std::uint64_t position() const  {   return m_pos;   }
+
+        /**
+         * @brief Освобождение кадров для писателя (читатель)
+         * @param position Позиция, полученная position(): освобождаются все кадры до неё
+         */
+        void release(std::uint64_t position);
+
+        /**
+         * @brief Ожидание новых кадров (читатель)
+         *
+         * @param timeout Максимальное время ожидания
+         * @return true если буфер не пуст
+         */
+        bool wait(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Проверка того, что процесс-писатель подключен и работает
+         */
+        bool producerAlive() const;
+
+    private:
+        struct Shared;
+
+        bool waitSpace(std::uint64_t need);
+
+        Shared *m_shared = nullptr;         ///< Заголовок буфера в разделяемой памяти
+        char *m_data = nullptr;             ///< Область кадров
+        std::uint64_t m_capacity = 0;       ///< Размер области кадров, байт
+        std::size_t m_mapSize = 0;          ///< Размер отображения, байт
+        bool m_producer = false;            ///< Подключен писатель
+        std::uint64_t m_pos = 0;            ///< Позиция записи (писатель) или чтения (читатель)
+        std::uint64_t m_next = 0;           ///< Позиция после кадра, прочитанного peek()
+        bool m_stalled = false;             ///< Ожидание сборщика истекло (писатель)
+        std::uint64_t m_stalledTail = 0;    ///< Позиция чтения сборщика при истечении ожидания
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERSHM_H
@@ -0,0 +1,97 @@
+#include "loggersignal.h"
+
+#include <thread>
+
+#if defined(Q_OS_LINUX)
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LOGGER_CPU_RELAX() _mm_pause()
+#else
+#define LOGGER_CPU_RELAX() std::this_thread::yield()
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+    LoggerSignal::LoggerSignal(): m_seq(0)
+                                , m_spins(MinSpins)
+                                , m_sleeping(false)
+    {}
+
+    std::uint32_t LoggerSignal::value() const {
+        return m_seq.load(std::memory_order_acquire);
+    }
+
+    void LoggerSignal::notify() {
+        // Последовательная согласованность изменения счётчика и чтения флага
+        // m_sleeping (и наоборот в wait) гарантирует, что либо поток записи увидит
+        // новое значение счётчика, либо уведомляющий поток увидит, что он спит
+        m_seq.fetch_add(1, std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_seq_cst)) {
+            wake();
+        }
+    }
+
+    bool LoggerSignal::wait(std::uint32_t seen, std::chrono::microseconds timeout) {
+        // Активное ожидание: если сообщения приходят часто, поток записи
+        // не засыпает. Длительность ожидания подстраивается под нагрузку.
+        for (int i = 0; i < m_spins; ++i) {
+            if (m_seq.load(std::memory_order_acquire) != seen) {
+                m_spins = m_spins * 2 < MaxSpins ? m_spins * 2 : MaxSpins;
+                return false;
+            }
+            LOGGER_CPU_RELAX();
+        }
+        m_spins = m_spins / 2 > MinSpins ? m_spins / 2 : MinSpins;
+
+        m_sleeping.store(true, std::memory_order_seq_cst);
+        if (m_seq.load(std::memory_order_seq_cst) == seen) {
+            park(seen, timeout);
+        }
+        m_sleeping.store(false, std::memory_order_relaxed);
+        return true;
+    }
+
+#if defined(Q_OS_LINUX)
+
+    void LoggerSignal::park(std::uint32_t seen, std::chrono::microseconds timeout) {
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000);
+        ts.tv_nsec = static_cast<long>((timeout.count() % 1000000) * 1000);
+        // Ядро атомарно сравнивает значение счётчика с seen перед засыпанием,
+        // поэтому уведомление после проверки очереди не может быть потеряно
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&m_seq),
+                FUTEX_WAIT_PRIVATE, seen, &ts, nullptr, 0);
+    }
+
+    void LoggerSignal::wake() {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&m_seq),
+                FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+#else
+
+    void LoggerSignal::park(std::uint32_t seen, std::chrono::microseconds timeout) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, timeout, [&]() {
+            return m_seq.load(std::memory_order_acquire) != seen;
+        });
+    }
+
+    void LoggerSignal::wake() {
+        // Захват мьютекса после изменения счётчика гарантирует, что ожидающий
+        // поток либо увидит новое значение, либо уже ожидает на условной переменной
+        { std::lock_guard<std::mutex> lock(m_mutex); }
+        m_cv.notify_all();
+    }
+
+#endif
+
+}   // End namespace DIRA_3D_GW
@@ -0,0 +1,81 @@
+#ifndef LOGGERSIGNAL_H
+#define LOGGERSIGNAL_H
+
+#include <QtCore/qglobal.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if !defined(Q_OS_LINUX)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Сигнал о появлении сообщений в очереди
+ *  \brief Передаёт потоку записи уведомления от потоков-источников сообщений.
+ *     Состояние сигнала - атомарный счётчик последовательности, который увеличивается
+ * при каждом уведомлении. Поток записи запоминает значение счётчика до проверки
+ * очереди и ждёт его изменения, поэтому уведомление, пришедшее между проверкой
+ * очереди и засыпанием, не теряется. Ожидание начинается с короткого адаптивного
+ * активного ожидания, после чего поток засыпает на futex (Linux) или условной
+ * переменной (остальные платформы). Ложные пробуждения допустимы: вызывающая
+ * сторона всегда перепроверяет очередь.
+ *     Поток записи сообщает о том, что он спит, поэтому системный вызов пробуждения
+ * выполняется только если поток действительно ожидает на futex, а не на каждое
+ * сообщение.
+ */
+    class LoggerSignal {
+    public:
+        LoggerSignal();
+
+        LoggerSignal(const LoggerSignal &) = delete;
+        LoggerSignal &operator=(const LoggerSignal &) = delete;
+
+        /**
+         * @brief Текущее значение счётчика последовательности
+         */
+        std::uint32_t value() const;
+
+        /**
+         * @brief Уведомление ожидающего потока
+         * @remark Увеличивает счётчик последовательности и, если поток записи спит,
+         * будит его.
+         */
+        void notify();
+
+        /**
+         * @brief Ожидание уведомления
+         * @remark Возвращает управление, когда значение счётчика отличается от seen,
+         * по истечении таймаута или при ложном пробуждении.
+         *
+         * @param seen Значение счётчика, полученное до проверки очереди
+         * @param timeout Максимальное время ожидания
+         * @return true если поток засыпал или false если уведомление получено во
+         * время активного ожидания
+         */
+        bool wait(std::uint32_t seen, std::chrono::microseconds timeout);
+
+    private:
+        void park(std::uint32_t seen, std::chrono::microseconds timeout);
+        void wake();
+
+        static const int MinSpins = 16;         ///< Минимальное количество итераций активного ожидания
+        static const int MaxSpins = 4096;       ///< Максимальное количество итераций активного ожидания
+
+        std::atomic<std::uint32_t> m_seq;       ///< Счётчик последовательности уведомлений
+        int m_spins;                            ///< Текущее количество итераций активного ожидания
+        std::atomic<bool> m_sleeping;           ///< Флаг того, что поток записи спит
+
+#if !defined(Q_OS_LINUX)
+        std::mutex m_mutex;                     ///< Мьютекс условной переменной
+        std::condition_variable m_cv;           ///< Условная переменная для засыпания потока
+#endif
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERSIGNAL_H
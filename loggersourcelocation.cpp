@@ -0,0 +1,44 @@
+#include "loggersourcelocation.h"
+
+#include <atomic>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    const std::uint32_t MaxLocations = 16384;   ///< Размер реестра мест вызова
+
+    std::atomic<std::uint32_t> g_nextId(1);     ///< Следующий свободный идентификатор
+    std::atomic<const LoggerSourceLocation *> g_locations[MaxLocations];   ///< Реестр мест вызова
+
+}
+
+    LoggerSourceLocation::LoggerSourceLocation(const char *file, std::int32_t line, const char *function)
+        : m_file(file ? file : "")
+        , m_baseName(m_file)
+        , m_function(function ? function : "")
+        , m_line(line)
+        , m_id(0)
+    {
+        for (const char *p = m_file; *p; ++p) {
+            if (*p == '/' || *p == '\\') {
+                m_baseName = p + 1;
+            }
+        }
+
+        const std::uint32_t id = g_nextId.fetch_add(1, std::memory_order_relaxed);
+        if (id < MaxLocations) {
+            m_id = id;
+            g_locations[id].store(this, std::memory_order_release);
+        }
+    }
+
+    const LoggerSourceLocation *LoggerSourceLocation::find(std::uint32_t id) {
+        if (id == 0 || id >= MaxLocations) {
+            return nullptr;
+        }
+        return g_locations[id].load(std::memory_order_acquire);
+    }
+
+}   // End namespace DIRA_3D_GW
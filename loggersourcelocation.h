@@ -0,0 +1,68 @@
+#ifndef LOGGERSOURCELOCATION_H
+#define LOGGERSOURCELOCATION_H
+
+#include <cstdint>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Место вызова в исходном коде
+ *  \brief Хранит имя файла исходного кода, номер строки и имя функции места вызова.
+ *     Объект создаётся один раз для каждого места вызова (как статическая переменная,
+ * см. макрос LOGGER_HERE) и при создании регистрируется в общем реестре, получая
+ * небольшой целочисленный идентификатор. В записях очереди сообщений хранится только
+ * этот идентификатор, а имя файла выводится потоком записи из реестра без копирования.
+ *     Регистрация выполняется без блокировок. Если реестр заполнен, объект получает
+ * идентификатор 0 и сообщения с ним записываются без места вызова.
+ */
+    class LoggerSourceLocation {
+    public:
+        /**
+         * @brief Конструктор. Регистрирует место вызова в реестре.
+         *
+         * @param file Имя файла исходного кода (__FILE__)
+         * @param line Номер строки кода (__LINE__)
+         * @param function Имя функции (__func__)
+         */
+        LoggerSourceLocation(const char *file, std::int32_t line, const char *function);
+
+        LoggerSourceLocation(const LoggerSourceLocation &) = delete;
+        LoggerSourceLocation &operator=(const LoggerSourceLocation &) = delete;
+
+        std::uint32_t id() const        {   return m_id;        }
+        const char *file() const        {   return m_file;      }
+        const char *baseName() const    {   return m_baseName;  }
+        std::int32_t line() const       {   return m_line;      }
+        const char *function() const    {   return m_function;  }
+
+        /**
+         * @brief Поиск места вызова по идентификатору
+         *
+         * @param id Идентификатор места вызова
+         * @return Указатель на место вызова или nullptr если идентификатор не
+         * зарегистрирован
+         */
+        static const LoggerSourceLocation *find(std::uint32_t id);
+
+    private:
+        const char *m_file;         ///< Полный путь к файлу исходного кода
+        const char *m_baseName;     ///< Имя файла без каталога (указатель внутрь m_file)
+        const char *m_function;     ///< Имя функции
+        std::int32_t m_line;        ///< Номер строки кода
+        std::uint32_t m_id;         ///< Идентификатор в реестре (0 - не зарегистрировано)
+    };
+
+}   // End namespace DIRA_3D_GW
+
+/**
+ * @brief Ссылка на статический объект LoggerSourceLocation текущего места вызова.
+ * @remark Объект создаётся и регистрируется при первом выполнении строки, например:
+ *  logger.error("Device disconnected", LOGGER_HERE());
+ */
+#define LOGGER_HERE() \
+    ([](const char *loggerFunc) -> const DIRA_3D_GW::LoggerSourceLocation & { \
+        static const DIRA_3D_GW::LoggerSourceLocation loggerLocation(__FILE__, __LINE__, loggerFunc); \
+        return loggerLocation; \
+    }(__func__))
+
+#endif // LOGGERSOURCELOCATION_H
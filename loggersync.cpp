@@ -0,0 +1,160 @@
+#include "loggersync.h"
+#include "loggerthread.h"
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    int dup_fd(int fd) {
+#if defined(Q_OS_WIN)
+        return _dup(fd);
+#else
+        return dup(fd);
+#endif
+    }
+
+    void close_fd(int fd) {
+#if defined(Q_OS_WIN)
+        _close(fd);
+#else
+        close(fd);
+#endif
+    }
+
+    /**
+     * @brief Сохранение данных файла на диск (без обязательного сохранения метаданных)
+     */
+    void sync_fd(int fd) {
+#if defined(Q_OS_WIN)
+        _commit(fd);
+#elif defined(Q_OS_LINUX)
+        fdatasync(fd);
+#else
+        fsync(fd);
+#endif
+    }
+
+}
+
+    LoggerSyncer::LoggerSyncer() {}
+
+    LoggerSyncer::~LoggerSyncer() {
+        stop();
+    }
+
+    void LoggerSyncer::start(std::chrono::milliseconds interval, const LoggerThreadOptions &options) {
+        if (m_thread.joinable()) {
+            return;
+        }
+        m_interval = interval;
+        m_options = options;
+        m_stop = false;
+        m_thread = std::thread(&LoggerSyncer::run, this);
+    }
+
+    void LoggerSyncer::stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+
+        for (int fd : m_retired) {
+            close_fd(fd);
+        }
+        m_retired.clear();
+        if (m_fd >= 0) {
+            close_fd(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    void LoggerSyncer::attach(int fd) {
+        const int copy = fd >= 0 ? dup_fd(fd) : -1;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_fd >= 0) {
+                // Копия дескриптора закрывается потоком синхронизации после
+                // сохранения оставшихся данных предыдущего файла
+                m_retired.push_back(m_fd);
+                m_urgent = true;
+            }
+            m_fd = copy;
+        }
+        m_cv.notify_one();
+    }
+
+    void LoggerSyncer::written(bool urgent) {
+        bool wake = urgent;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_dirty) {
+                // Поток пробуждается только для установки срока синхронизации первой
+                // несохранённой пачки; последующие пачки войдут в ту же синхронизацию
+                m_dirty = true;
+                m_dirtySince = std::chrono::steady_clock::now();
+                wake = wake || m_interval.count() > 0;
+            }
+            m_urgent = m_urgent || urgent;
+        }
+        if (wake) {
+            m_cv.notify_one();
+        }
+    }
+
+    std::uint64_t LoggerSyncer::syncCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_syncs;
+    }
+
+    void LoggerSyncer::run() {
+        applyThreadOptions(m_options, "-sync");
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            const bool due = m_urgent || m_stop || (m_dirty && m_interval.count() > 0
+                    && std::chrono::steady_clock::now() >= m_dirtySince + m_interval);
+            if (!due) {
+                if (m_dirty && m_interval.count() > 0) {
+                    m_cv.wait_until(lock, m_dirtySince + m_interval);
+                } else {
+                    m_cv.wait(lock);
+                }
+                continue;
+            }
+            if (m_stop && !m_dirty && m_retired.empty()) {
+                break;
+            }
+
+            const int fd = m_dirty ? m_fd : -1;
+            std::vector<int> retired;
+            retired.swap(m_retired);
+            m_dirty = false;
+            m_urgent = false;
+
+            // Синхронизация выполняется без мьютекса: поток записи продолжает
+            // записывать следующие пачки, они войдут в следующую синхронизацию
+            lock.unlock();
+            for (int old : retired) {
+                sync_fd(old);
+                close_fd(old);
+            }
+            if (fd >= 0) {
+                sync_fd(fd);
+            }
+            lock.lock();
+            ++m_syncs;
+        }
+    }
+
+}   // End namespace DIRA_3D_GW
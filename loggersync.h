@@ -0,0 +1,97 @@
+#ifndef LOGGERSYNC_H
+#define LOGGERSYNC_H
+
+#include <QtCore/qglobal.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "loggertypes.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Поток синхронизации файла журнала с диском
+ *  \brief Выполняет fdatasync файла журнала в отдельном потоке, поэтому поток записи
+ * никогда не блокируется на синхронизации.
+ *     Поток записи сообщает о каждой записанной пачке строк. Несрочные пачки
+ * синхронизируются одним вызовом не позже чем через интервал синхронизации после
+ * записи первой из них (group commit), срочные - сразу. Все пачки, записанные к
+ * моменту синхронизации, сохраняются одним вызовом.
+ *     Объект хранит собственную копию дескриптора файла, поэтому поток записи может
+ * закрыть или переименовать файл при ротации, не дожидаясь синхронизации.
+ */
+    class LoggerSyncer {
+    public:
+        LoggerSyncer();
+
+        /**
+         * @brief Деструктор
+         * @remark Синхронизирует несохранённые данные и завершает поток.
+         */
+        ~LoggerSyncer();
+
+        LoggerSyncer(const LoggerSyncer &) = delete;
+        LoggerSyncer &operator=(const LoggerSyncer &) = delete;
+
+        /**
+         * @brief Запуск потока синхронизации
+         *
+         * @param interval Интервал синхронизации несрочных пачек. 0 - несрочные
+         * пачки синхронизируются только вместе со срочными
+         * @param options Параметры потока синхронизации
+         */
+        void start(std::chrono::milliseconds interval,
+                   const LoggerThreadOptions &options = LoggerThreadOptions());
+
+        /**
+         * @brief Синхронизация несохранённых данных и завершение потока
+         */
+        void stop();
+
+        /**
+         * @brief Установка файла для синхронизации
+         * @remark Вызывается после открытия файла журнала и после ротации. Данные
+         * предыдущего файла синхронизируются перед закрытием его копии дескриптора.
+         *
+         * @param fd Дескриптор файла (-1 - файл не открыт)
+         */
+        void attach(int fd);
+
+        /**
+         * @brief Уведомление о записи пачки строк в файл
+         *
+         * @param urgent true - синхронизировать без ожидания интервала
+         */
+        void written(bool urgent);
+
+        /**
+         * @brief Количество выполненных синхронизаций
+         */
+        std::uint64_t syncCount() const;
+
+    private:
+        void run();
+
+        std::chrono::milliseconds m_interval{0};        ///< Интервал синхронизации
+        LoggerThreadOptions m_options;                  ///< Параметры потока синхронизации
+        mutable std::mutex m_mutex;                     ///< Мьютекс состояния
+        std::condition_variable m_cv;                   ///< Пробуждение потока синхронизации
+        std::thread m_thread;                           ///< Поток синхронизации
+
+        int m_fd = -1;                                  ///< Копия дескриптора текущего файла
+        std::vector<int> m_retired;                     ///< Копии дескрипторов предыдущих файлов
+        bool m_dirty = false;                           ///< Есть несинхронизированные данные
+        bool m_urgent = false;                          ///< Запрошена срочная синхронизация
+        bool m_stop = false;                            ///< Флаг завершения потока
+        std::chrono::steady_clock::time_point m_dirtySince; ///< Время первой несинхронизированной записи
+        std::uint64_t m_syncs = 0;                      ///< Количество выполненных синхронизаций
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERSYNC_H
@@ -0,0 +1,315 @@
+#include "loggersyslog.h"
+
+#include <cstdio>
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    void append_uint(QByteArray &dst, std::uint64_t value, int width = 0) {
+        char buf[24];
+        int n = 0;
+        do {
+            buf[n++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (n < width) {
+            buf[n++] = '0';
+        }
+        while (n > 0) {
+            dst.append(buf[--n]);
+        }
+    }
+
+    /**
+     * @brief Замена символов, недопустимых в полях заголовка RFC 5424 (только
+     * печатные ASCII без пробела)
+     */
+    QByteArray header_field(const QByteArray &value, int maxSize) {
+        QByteArray field = value.left(maxSize);
+        for (int i = 0; i < field.size(); ++i) {
+            if (field[i] < 33 || field[i] > 126) {
+                field[i] = '_';
+            }
+        }
+        return field.isEmpty() ? QByteArray("-") : field;
+    }
+
+    /**
+     * @brief Дата по номеру дня от начала эпохи (пролептический григорианский календарь)
+     */
+    void civil_from_days(std::int64_t days, int &year, int &month, int &day) {
+        days += 719468;
+        const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const std::int64_t doe = days - era * 146097;
+        const std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const std::int64_t mp = (5 * doy + 2) / 153;
+        day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+        month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+        year = static_cast<int>(yoe + era * 400 + (month <= 2 ? 1 : 0));
+    }
+
+}
+
+    LoggerSyslog::LoggerSyslog(): m_cachedSecs(INT64_MIN)
+    {
+        m_timeCache[0] = '\0';
+    }
+
+    LoggerSyslog::~LoggerSyslog() {
+        closeSocket();
+    }
+
+    void LoggerSyslog::setTarget(const QString &socketPath, const QString &appName, int facility) {
+        m_path = socketPath.toLocal8Bit();
+        m_appName = appName.toUtf8();
+        m_facility = facility >= 0 && facility <= 23 ? facility : FacilityUser;
+    }
+
+    bool LoggerSyslog::open() {
+        if (!isEnabled()) {
+            return false;
+        }
+#if defined(Q_OS_UNIX)
+        char host[256];
+        if (gethostname(host, sizeof(host)) != 0) {
+            host[0] = '\0';
+        }
+        host[sizeof(host) - 1] = '\0';
+        m_hostName = header_field(QByteArray(host), 255);
+        m_procId = QByteArray::number(static_cast<qint64>(getpid()));
+#else
+        m_hostName = "-";
+        m_procId = "-";
+#endif
+        m_appName = header_field(m_appName.isEmpty() ? QByteArray("qt-logger") : m_appName, 48);
+        m_batch.reserve(MaxBatch * 256);
+        m_ends.reserve(MaxBatch);
+        m_nextConnect = std::chrono::steady_clock::time_point();
+        return connectSocket();
+    }
+
+    bool LoggerSyslog::connectSocket() {
+#if defined(Q_OS_UNIX)
+        const auto now = std::chrono::steady_clock::now();
+        if (now < m_nextConnect) {
+            return false;
+        }
+        m_nextConnect = now + std::chrono::seconds(1);
+
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (static_cast<std::size_t>(m_path.size()) >= sizeof(addr.sun_path)) {
+            return false;
+        }
+        std::memcpy(addr.sun_path, m_path.constData(), static_cast<std::size_t>(m_path.size()));
+
+        m_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (m_fd < 0) {
+            return false;
+        }
+        fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+        fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL, 0) | O_NONBLOCK);
+        if (::connect(m_fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+            closeSocket();
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void LoggerSyslog::closeSocket() {
+#if defined(Q_OS_UNIX)
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+#endif
+    }
+
+    void LoggerSyslog::appendTimestamp(std::int64_t time) {
+        std::int64_t secs = time / 1000000000;
+        std::int64_t ns = time % 1000000000;
+        if (ns < 0) {
+            --secs;
+            ns += 1000000000;
+        }
+        if (secs != m_cachedSecs) {
+            std::int64_t days = secs / 86400;
+            std::int64_t rem = secs % 86400;
+            if (rem < 0) {
+                --days;
+                rem += 86400;
+            }
+            int year, month, day;
+            civil_from_days(days, year, month, day);
+            std::snprintf(m_timeCache, sizeof(m_timeCache), "%04d-%02d-%02dT%02d:%02d:%02d",
+                          year, month, day, static_cast<int>(rem / 3600),
+                          static_cast<int>(rem / 60 % 60), static_cast<int>(rem % 60));
+            m_cachedSecs = secs;
+        }
+        m_batch.append(m_timeCache, 19);
+        m_batch.append('.');
+        append_uint(m_batch, static_cast<std::uint64_t>(ns / 1000), 6);
+        m_batch.append('Z');
+    }
+
+    void LoggerSyslog::add(const LoggerRecord &rec, LoggerFormatter &formatter) {
+        const int start = m_batch.size();
+        m_batch.append('<');
+        append_uint(m_batch, static_cast<std::uint64_t>(m_facility * 8 + severity(rec.level)));
+        m_batch.append(">1 ", 3);
+        appendTimestamp(rec.time);
+        m_batch.append(' ');
+        m_batch.append(m_hostName);
+        m_batch.append(' ');
+        m_batch.append(m_appName);
+        m_batch.append(' ');
+        m_batch.append(m_procId);
+        m_batch.append(" - - ", 5);
+        formatter.formatMessage(rec, m_batch);
+
+        if (m_batch.size() - start > MaxMessageSize) {
+            // Сообщение обрезается по границе символа UTF-8
+            int end = start + MaxMessageSize;
+            while (end > start && (static_cast<unsigned char>(m_batch[end]) & 0xC0) == 0x80) {
+                --end;
+            }
+            m_batch.truncate(end);
+        }
+        m_ends.push_back(m_batch.size());
+        if (m_ends.size() >= static_cast<std::size_t>(MaxBatch)) {
+            flush();
+        }
+    }
+
+    void LoggerSyslog::flush() {
+        if (m_ends.empty()) {
+            return;
+        }
+        const std::size_t count = m_ends.size();
+        std::size_t sent = 0;
+        std::size_t dropped = 0;
+
+        if (m_fd >= 0 || connectSocket()) {
+#if defined(Q_OS_UNIX)
+            iovec iov[MaxBatch];
+            for (std::size_t i = 0; i < count; ++i) {
+                const int begin = i == 0 ? 0 : m_ends[i - 1];
+                iov[i].iov_base = const_cast<char *>(m_batch.constData()) + begin;
+                iov[i].iov_len = static_cast<std::size_t>(m_ends[i] - begin);
+            }
+#if defined(Q_OS_LINUX)
+            mmsghdr msgs[MaxBatch];
+            std::memset(msgs, 0, sizeof(mmsghdr) * count);
+            for (std::size_t i = 0; i < count; ++i) {
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+#endif
+            std::size_t i = 0;
+            while (i < count) {
+#if defined(Q_OS_LINUX)
+                const int n = sendmmsg(m_fd, msgs + i, static_cast<unsigned int>(count - i), MSG_DONTWAIT);
+#else
+                const int n = ::send(m_fd, iov[i].iov_base, iov[i].iov_len, MSG_DONTWAIT) < 0 ? -1 : 1;
+#endif
+                if (n > 0) {
+                    i += static_cast<std::size_t>(n);
+                    sent += static_cast<std::size_t>(n);
+                    continue;
+                }
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EMSGSIZE) {
+                    // Сообщение больше допустимого размера датаграммы
+                    ++i;
+                    ++dropped;
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) {
+                    // syslog перезапущен: подключение восстанавливается при следующей пачке
+                    closeSocket();
+                }
+                // Поток записи не ждёт syslog: остаток пачки отбрасывается
+                dropped += count - i;
+                break;
+            }
+#endif
+        } else {
+            dropped = count;
+        }
+
+        m_sent.fetch_add(sent, std::memory_order_relaxed);
+        m_dropped.fetch_add(dropped, std::memory_order_relaxed);
+        m_batch.resize(0);
+        m_ends.clear();
+    }
+
+    void LoggerSyslog::close() {
+        flush();
+        closeSocket();
+    }
+
+    LoggerSyslogStats LoggerSyslog::stats() const {
+        LoggerSyslogStats s;
+        s.sent = m_sent.load(std::memory_order_relaxed);
+        s.dropped = m_dropped.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    int LoggerSyslog::severity(LoggerLevel level) {
+        switch (level) {
+        case LoggerLevel::System:       return 5;
+        case LoggerLevel::Critical:     return 2;
+        case LoggerLevel::Error:        return 3;
+        case LoggerLevel::Warning:      return 4;
+        case LoggerLevel::Info:         return 6;
+        case LoggerLevel::Debug:        return 7;
+        case LoggerLevel::Developer:    return 7;
+        }
+        return 7;
+    }
+
+    int LoggerSyslog::facilityFromString(const QString &name) {
+        static const char *names[] = {
+            "kern", "user", "mail", "daemon", "auth", "syslog", "lpr", "news",
+            "uucp", "cron", "authpriv", "ftp"
+        };
+        const QString lower = name.trimmed().toLower();
+        bool ok = false;
+        const int number = lower.toInt(&ok);
+        if (ok) {
+            return number >= 0 && number <= 23 ? number : FacilityUser;
+        }
+        for (int i = 0; i < static_cast<int>(sizeof(names) / sizeof(names[0])); ++i) {
+            if (lower == names[i]) {
+                return i;
+            }
+        }
+        if (lower.startsWith("local") && lower.size() == 6) {
+            const int n = lower.mid(5).toInt(&ok);
+            if (ok && n >= 0 && n <= 7) {
+                return 16 + n;
+            }
+        }
+        return FacilityUser;
+    }
+
+}   // End namespace DIRA_3D_GW
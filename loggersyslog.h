@@ -0,0 +1,129 @@
+#ifndef LOGGERSYSLOG_H
+#define LOGGERSYSLOG_H
+
+#include <QtCore/qglobal.h>
+#include <QString>
+#include <QByteArray>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "loggertypes.h"
+#include "loggerrecord.h"
+#include "loggerformatter.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Передача сообщений журнала в syslog
+ *  \brief Сообщения передаются в формате RFC 5424 датаграммами в локальный
+ * Unix-сокет syslog ("/dev/log", который слушают rsyslog, syslog-ng и journald):
+ *     <PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID - - MSG
+ * где PRI = facility * 8 + severity (см. severity()), TIMESTAMP - время сообщения в
+ * UTC с микросекундами, MSG - текст сообщения с полями и местом вызова.
+ *     Сообщения накапливаются потоком записи и передаются одним вызовом sendmmsg на
+ * пачку (в Linux). Передача неблокирующая: если syslog недоступен или его очередь
+ * заполнена, сообщения отбрасываются с учётом в stats(); соединение
+ * восстанавливается не чаще раза в секунду.
+ *     Путь к сокету настраивается, поэтому вместо syslog можно использовать любой
+ * локальный датаграммный сокет (например в тестах).
+ *     Методы, кроме stats(), вызываются только потоком записи.
+ */
+    class LoggerSyslog {
+    public:
+        static const int FacilityUser = 1;          ///< Facility по умолчанию (user-level messages)
+        static const int MaxMessageSize = 8192;     ///< Максимальный размер сообщения, байт
+        static const int MaxBatch = 64;             ///< Количество сообщений в одном вызове sendmmsg
+
+        LoggerSyslog();
+        ~LoggerSyslog();
+
+        LoggerSyslog(const LoggerSyslog &) = delete;
+        LoggerSyslog &operator=(const LoggerSyslog &) = delete;
+
+        /**
+         * @brief Установка параметров передачи
+         * @remark Вызывается до запуска потока записи.
+         *
+         * @param socketPath Путь к сокету syslog. Пустая строка - передача отключена
+         * @param appName Имя приложения (APP-NAME)
+         * @param facility Facility сообщений (0..23)
+         */
+        void setTarget(const QString &socketPath, const QString &appName, int facility);
+
+        /**
+         * @brief Проверка того, что передача включена
+         */
+        bool isEnabled() const      {   return !m_path.isEmpty();   }
+
+        /**
+         * @brief Подключение к сокету syslog
+         * @return true если сокет подключен или false если syslog пока недоступен
+         * (подключение будет повторено при передаче)
+         */
+        bool open();
+
+        /**
+         * @brief Добавление сообщения в пачку
+         * @remark Заполненная пачка передаётся сразу.
+         *
+         * @param rec Запись очереди сообщений (время - нс от начала эпохи)
+         * @param formatter Форматирование текста сообщения
+         */
+        void add(const LoggerRecord &rec, LoggerFormatter &formatter);
+
+        /**
+         * @brief Передача накопленных сообщений
+         */
+        void flush();
+
+        /**
+         * @brief Передача накопленных сообщений и закрытие сокета
+         */
+        void close();
+
+        /**
+         * @brief Статистика передачи
+         */
+        LoggerSyslogStats stats() const;
+
+        /**
+         * @brief Severity syslog для уровня сообщения
+         * @remark System - Notice (5), Critical - Critical (2), Error - Error (3),
+         * Warning - Warning (4), Info - Informational (6), Debug и Developer - Debug (7).
+         */
+        static int severity(LoggerLevel level);
+
+        /**
+         * @brief Facility по названию ("user", "daemon", "local0".."local7") или номеру
+         * @return Facility или FacilityUser, если название не распознано
+         */
+        static int facilityFromString(const QString &name);
+
+    private:
+        bool connectSocket();
+        void closeSocket();
+        void appendTimestamp(std::int64_t time);
+
+        QByteArray m_path;                  ///< Путь к сокету syslog
+        QByteArray m_appName;               ///< APP-NAME
+        QByteArray m_hostName;              ///< HOSTNAME
+        QByteArray m_procId;                ///< PROCID
+        int m_facility = FacilityUser;      ///< Facility сообщений
+        int m_fd = -1;                      ///< Сокет syslog
+        std::chrono::steady_clock::time_point m_nextConnect;   ///< Время следующей попытки подключения
+
+        QByteArray m_batch;                 ///< Сообщения пачки
+        std::vector<int> m_ends;            ///< Концы сообщений пачки в m_batch
+        std::int64_t m_cachedSecs;          ///< Секунда, для которой заполнен кеш времени
+        char m_timeCache[20];               ///< "yyyy-MM-ddThh:mm:ss"
+
+        std::atomic<std::uint64_t> m_sent{0};       ///< Передано сообщений
+        std::atomic<std::uint64_t> m_dropped{0};    ///< Отброшено сообщений
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERSYSLOG_H
@@ -0,0 +1,437 @@
+#include "loggertail.h"
+#include "loggerformatter.h"
+#include "loggerthread.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(Q_OS_UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    std::uint64_t align_up(std::uint64_t value, std::uint64_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+#if defined(Q_OS_UNIX)
+    bool set_nonblocking(int fd) {
+        const int flags = fcntl(fd, F_GETFL, 0);
+        return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1
+                && fcntl(fd, F_SETFD, FD_CLOEXEC) != -1;
+    }
+
+#if defined(MSG_NOSIGNAL)
+    const int SendFlags = MSG_NOSIGNAL | MSG_DONTWAIT;
+#else
+    const int SendFlags = MSG_DONTWAIT;
+#endif
+#endif
+
+}
+
+    LoggerTail::LoggerTail() {}
+
+    void LoggerTail::setCapacity(std::int64_t bytes) {
+        if (bytes <= 0) {
+            m_capacity = 0;
+            m_buffer.reset();
+            return;
+        }
+        std::uint64_t capacity = MinCapacity;
+        while (capacity < static_cast<std::uint64_t>(bytes)) {
+            capacity <<= 1;
+        }
+        m_capacity = capacity;
+        m_buffer.reset(new char[capacity]);
+        m_write = m_oldest = m_seq = 0;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_reserved.store(0, std::memory_order_relaxed);
+    }
+
+    void LoggerTail::readHeader(std::uint64_t pos, Header &header) const {
+        std::memcpy(&header, m_buffer.get() + (pos & (m_capacity - 1)), sizeof(Header));
+    }
+
+    void LoggerTail::writeHeader(std::uint64_t pos, const Header &header) {
+        std::memcpy(m_buffer.get() + (pos & (m_capacity - 1)), &header, sizeof(Header));
+    }
+
+    bool LoggerTail::overwritten(std::uint64_t pos) const {
+        // Данные читаются до проверки: если поток записи начал перезаписывать их,
+        // граница m_reserved уже сдвинута за pos + m_capacity
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_reserved.load(std::memory_order_relaxed) > pos + m_capacity;
+    }
+
+    void LoggerTail::reserve(std::uint64_t end) {
+        // Вытесняемые строки удаляются с начала буфера, пока новая строка не поместится
+        while (m_oldest < m_write && end - m_oldest > m_capacity) {
+            Header header;
+            readHeader(m_oldest, header);
+            m_oldest += header.level == PadLevel
+                    ? header.size
+                    : align_up(sizeof(Header) + header.size, Align);
+        }
+        m_tail.store(m_oldest, std::memory_order_release);
+        m_reserved.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void LoggerTail::append(const char *data, int size, LoggerLevel level) {
+        if (m_capacity == 0 || size <= 0) {
+            return;
+        }
+        const std::uint64_t maxLine = m_capacity / 4 - sizeof(Header);
+        const std::uint64_t lineSize = std::min(static_cast<std::uint64_t>(size), maxLine);
+        const std::uint64_t total = align_up(sizeof(Header) + lineSize, Align);
+
+        // Строка хранится непрерывно: остаток в конце буфера пропускается
+        const std::uint64_t offset = m_write & (m_capacity - 1);
+        if (offset + total > m_capacity) {
+            const std::uint64_t pad = m_capacity - offset;
+            reserve(m_write + pad);
+            writeHeader(m_write, Header{static_cast<std::uint32_t>(pad), PadLevel, 0});
+            m_write += pad;
+        }
+
+        reserve(m_write + total);
+        writeHeader(m_write, Header{static_cast<std::uint32_t>(lineSize), static_cast<std::int32_t>(level), m_seq});
+        std::memcpy(m_buffer.get() + (m_write & (m_capacity - 1)) + sizeof(Header), data, lineSize);
+        m_write += total;
+        ++m_seq;
+        m_head.store(m_write, std::memory_order_release);
+    }
+
+    void LoggerTail::publish() {
+        if (m_capacity == 0) {
+            return;
+        }
+        // Пара к проверке m_head ожидающим потоком после увеличения m_waiters
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_relaxed) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+            }
+            m_cv.notify_all();
+        }
+#if defined(Q_OS_UNIX)
+        const int fd = m_notifyFd.load(std::memory_order_acquire);
+        if (fd >= 0 && m_notifyArmed.exchange(false, std::memory_order_acq_rel)) {
+            const char byte = 1;
+            if (::write(fd, &byte, 1) < 0) {
+                // Канал неблокирующий: если он заполнен, уведомление уже ожидает чтения
+            }
+        }
+#endif
+    }
+
+    void LoggerTail::setNotifyFd(int fd) {
+        m_notifyFd.store(fd, std::memory_order_release);
+    }
+
+    void LoggerTail::armNotify() const {
+        m_notifyArmed.store(true, std::memory_order_seq_cst);
+    }
+
+    LoggerTail::Cursor LoggerTail::subscribe(LoggerLevel level, bool fromOldest) const {
+        Cursor cursor;
+        cursor.level = level;
+        cursor.pos = fromOldest ? m_tail.load(std::memory_order_acquire)
+                                : m_head.load(std::memory_order_acquire);
+        return cursor;
+    }
+
+    bool LoggerTail::next(Cursor &cursor, Line &line) const {
+        if (m_capacity == 0) {
+            return false;
+        }
+        for (;;) {
+            if (cursor.pos == m_head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            Header header;
+            readHeader(cursor.pos, header);
+            if (overwritten(cursor.pos)) {
+                // Подписчик отстал: продолжение с самой старой строки буфера,
+                // пропущенные строки определяются по разрыву порядковых номеров
+                cursor.pos = m_tail.load(std::memory_order_acquire);
+                continue;
+            }
+            if (header.level == PadLevel) {
+                cursor.pos += header.size;
+                continue;
+            }
+            if (cursor.seqKnown && header.seq > cursor.seq) {
+                cursor.missed += header.seq - cursor.seq;
+            }
+            cursor.seq = header.seq + 1;
+            cursor.seqKnown = true;
+
+            const std::uint64_t pos = cursor.pos;
+            cursor.pos += align_up(sizeof(Header) + header.size, Align);
+            if (header.level > static_cast<std::int32_t>(cursor.level)) {
+                continue;
+            }
+            line.data = m_buffer.get() + (pos & (m_capacity - 1)) + sizeof(Header);
+            line.size = static_cast<int>(header.size);
+            line.level = static_cast<LoggerLevel>(header.level);
+            line.seq = header.seq;
+            line.missed = cursor.missed;
+            cursor.missed = 0;
+            cursor.current = pos;
+            return true;
+        }
+    }
+
+    bool LoggerTail::commit(Cursor &cursor) const {
+        if (overwritten(cursor.current)) {
+            ++cursor.missed;
+            return false;
+        }
+        return true;
+    }
+
+    bool LoggerTail::wait(const Cursor &cursor, std::chrono::milliseconds timeout) const {
+        if (m_capacity == 0) {
+            return false;
+        }
+        m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, timeout, [&]() { return pending(cursor); });
+        }
+        m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        return pending(cursor);
+    }
+
+    LoggerTailServer::LoggerTailServer() {}
+
+    LoggerTailServer::~LoggerTailServer() {
+        stop();
+    }
+
+    bool LoggerTailServer::start(const QString &path, LoggerTail *tail, const LoggerThreadOptions &options) {
+#if defined(Q_OS_UNIX)
+        if (m_thread.joinable()) {
+            return false;
+        }
+        if (!tail || !tail->isEnabled()) {
+            qWarning("Log tail buffer is disabled, the tail socket is not created");
+            return false;
+        }
+        m_path = path.toLocal8Bit();
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (m_path.isEmpty() || static_cast<std::size_t>(m_path.size()) >= sizeof(addr.sun_path)) {
+            qWarning("Invalid tail socket path %s", m_path.constData());
+            return false;
+        }
+        std::memcpy(addr.sun_path, m_path.constData(), static_cast<std::size_t>(m_path.size()));
+
+        if (pipe(m_wakeFds) != 0 || !set_nonblocking(m_wakeFds[0]) || !set_nonblocking(m_wakeFds[1])) {
+            qWarning("Cannot create the tail socket wakeup pipe");
+            stop();
+            return false;
+        }
+        ::unlink(m_path.constData());
+        m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_listenFd < 0 || !set_nonblocking(m_listenFd)
+                || bind(m_listenFd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0
+                || listen(m_listenFd, 8) != 0) {
+            qWarning("Cannot listen on the tail socket %s: %s", m_path.constData(), std::strerror(errno));
+            stop();
+            return false;
+        }
+
+        m_tail = tail;
+        m_options = options;
+        m_stop = false;
+        m_tail->setNotifyFd(m_wakeFds[1]);
+        m_thread = std::thread(&LoggerTailServer::run, this);
+        return true;
+#else
+        Q_UNUSED(path);
+        Q_UNUSED(tail);
+        Q_UNUSED(options);
+        qWarning("Log tail socket is not supported on this platform");
+        return false;
+#endif
+    }
+
+    void LoggerTailServer::stop() {
+#if defined(Q_OS_UNIX)
+        m_stop = true;
+        if (m_thread.joinable()) {
+            const char byte = 1;
+            if (::write(m_wakeFds[1], &byte, 1) < 0) {
+                // Канал заполнен - поток уже будет разбужен
+            }
+            m_thread.join();
+        }
+        if (m_tail) {
+            m_tail->setNotifyFd(-1);
+            m_tail = nullptr;
+        }
+        if (m_listenFd >= 0) {
+            ::close(m_listenFd);
+            m_listenFd = -1;
+            ::unlink(m_path.constData());
+        }
+        for (int &fd : m_wakeFds) {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+#endif
+    }
+
+    void LoggerTailServer::run() {
+#if defined(Q_OS_UNIX)
+        applyThreadOptions(m_options, "-tail");
+
+        //! Подключённый клиент
+        struct Client {
+            int fd;
+            LoggerTail::Cursor cursor;
+            std::string out;            ///< Строки, ещё не переданные клиенту
+            std::size_t sent;           ///< Передано байт из out
+            std::string in;             ///< Неполная строка команды клиента
+        };
+        static const std::size_t outLimit = 64 * 1024;
+
+        std::vector<Client> clients;
+        std::vector<pollfd> fds;
+
+        while (!m_stop.load(std::memory_order_acquire)) {
+            // Уведомление запрашивается до чтения буфера: строки, добавленные после
+            // чтения, разбудят poll
+            m_tail->armNotify();
+
+            bool ready = false;
+            for (std::size_t i = 0; i < clients.size(); ) {
+                Client &c = clients[i];
+                while (c.out.size() - c.sent < outLimit) {
+                    LoggerTail::Line line;
+                    if (!m_tail->next(c.cursor, line)) {
+                        break;
+                    }
+                    if (line.missed != 0) {
+                        c.out += "-- " + std::to_string(line.missed) + " lines missed --\n";
+                    }
+                    const std::size_t before = c.out.size();
+                    c.out.append(line.data, static_cast<std::size_t>(line.size));
+                    if (!m_tail->commit(c.cursor)) {
+                        c.out.resize(before);
+                    }
+                }
+                bool alive = true;
+                if (c.sent < c.out.size()) {
+                    const ssize_t n = send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, SendFlags);
+                    if (n > 0) {
+                        c.sent += static_cast<std::size_t>(n);
+                    } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        alive = false;
+                    }
+                    if (c.sent == c.out.size()) {
+                        c.out.clear();
+                        c.sent = 0;
+                    }
+                }
+                if (!alive) {
+                    ::close(c.fd);
+                    clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(i));
+                    continue;
+                }
+                // Клиент, которому ещё есть что передать, не ждёт уведомления
+                ready = ready || (c.out.empty() && m_tail->pending(c.cursor));
+                ++i;
+            }
+
+            fds.clear();
+            fds.push_back(pollfd{m_wakeFds[0], POLLIN, 0});
+            fds.push_back(pollfd{m_listenFd, POLLIN, 0});
+            for (const Client &c : clients) {
+                fds.push_back(pollfd{c.fd, static_cast<short>(POLLIN | (c.out.empty() ? 0 : POLLOUT)), 0});
+            }
+            if (poll(fds.data(), static_cast<nfds_t>(fds.size()), ready ? 0 : 1000) < 0) {
+                continue;
+            }
+
+            if (fds[0].revents & POLLIN) {
+                char drain[64];
+                while (::read(m_wakeFds[0], drain, sizeof(drain)) > 0) {}
+            }
+            // Команды клиентов: название уровня сообщений
+            for (std::size_t i = clients.size(); i-- > 0; ) {
+                const short revents = fds[i + 2].revents;
+                if (!(revents & (POLLIN | POLLHUP | POLLERR))) {
+                    continue;
+                }
+                Client &c = clients[i];
+                char buf[256];
+                const ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+                if (n <= 0 && !(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))) {
+                    ::close(c.fd);
+                    clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(i));
+                    continue;
+                }
+                if (n > 0) {
+                    c.in.append(buf, static_cast<std::size_t>(n));
+                }
+                std::size_t eol;
+                while ((eol = c.in.find('\n')) != std::string::npos) {
+                    const QString name = QString::fromUtf8(c.in.data(), static_cast<int>(eol)).trimmed();
+                    c.in.erase(0, eol + 1);
+                    for (int l = LoggerLevel::System; l <= LoggerLevel::Developer; ++l) {
+                        const LoggerLevel level = static_cast<LoggerLevel>(l);
+                        if (name.compare(LoggerFormatter::levelName(level), Qt::CaseInsensitive) == 0) {
+                            c.cursor.level = level;
+                        }
+                    }
+                }
+                if (c.in.size() > sizeof(buf)) {
+                    c.in.clear();
+                }
+            }
+            // Новые клиенты добавляются после обработки команд: fds содержит
+            // только клиентов, бывших в списке на момент poll()
+            if (fds[1].revents & POLLIN) {
+                for (;;) {
+                    const int fd = accept(m_listenFd, nullptr, nullptr);
+                    if (fd < 0) {
+                        break;
+                    }
+                    set_nonblocking(fd);
+#if defined(SO_NOSIGPIPE)
+                    const int one = 1;
+                    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+                    // Новый клиент получает строки, сохранённые в буфере (как tail -f)
+                    clients.push_back(Client{fd, m_tail->subscribe(LoggerLevel::Developer, true),
+                                             std::string(), 0, std::string()});
+                }
+            }
+        }
+
+        for (const Client &c : clients) {
+            ::close(c.fd);
+        }
+#endif
+    }
+
+}   // End namespace DIRA_3D_GW
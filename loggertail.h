@@ -0,0 +1,235 @@
+#ifndef LOGGERTAIL_H
+#define LOGGERTAIL_H
+
+#include <QtCore/qglobal.h>
+#include <QString>
+#include <QByteArray>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "loggertypes.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Кольцевой буфер последних строк журнала
+ *  \brief Поток записи копирует в буфер каждую строку, записываемую в файл журнала,
+ * подписчики (панель журнала, LoggerTailServer) читают строки из буфера по своему
+ * курсору без блокировок и без копирования.
+ *     Поток записи никогда не ждёт подписчиков: если подписчик отстал больше чем на
+ * размер буфера, его строки перезаписываются, а курсор при следующем чтении
+ * переносится на самую старую строку буфера с указанием количества пропущенных строк.
+ *     Строка читается прямо из буфера и может быть перезаписана во время чтения,
+ * поэтому после обработки строки (например копирования в QString) подписчик вызывает
+ * commit(): false означает, что строка перезаписана и результат обработки
+ * отбрасывается.
+ *     Запись в буфер - только потоком записи; чтение - из любого количества потоков,
+ * каждый со своим курсором.
+ */
+    class LoggerTail {
+    public:
+        //! Строка журнала в буфере
+        struct Line {
+            const char *data = nullptr;     ///< Строка (указывает в буфер, включая перевод строки)
+            int size = 0;                   ///< Размер строки, байт
+            LoggerLevel level = LoggerLevel::Developer;     ///< Уровень сообщения
+            std::uint64_t seq = 0;          ///< Порядковый номер строки
+            std::uint64_t missed = 0;       ///< Пропущено строк перед этой строкой (подписчик отстал)
+        };
+
+        //! Курсор подписчика
+        struct Cursor {
+            std::uint64_t pos = 0;          ///< Позиция следующей строки в буфере
+            std::uint64_t seq = 0;          ///< Порядковый номер следующей строки
+            bool seqKnown = false;          ///< Порядковый номер определён
+            std::uint64_t current = 0;      ///< Позиция последней прочитанной строки
+            std::uint64_t missed = 0;       ///< Пропущено строк с момента последнего чтения
+            LoggerLevel level = LoggerLevel::Developer;     ///< Наименее важный читаемый уровень
+        };
+
+        static const std::int64_t MinCapacity = 64 * 1024;     ///< Минимальный размер буфера, байт
+
+        LoggerTail();
+
+        LoggerTail(const LoggerTail &) = delete;
+        LoggerTail &operator=(const LoggerTail &) = delete;
+
+        /**
+         * @brief Установка размера буфера
+         * @remark Вызывается до запуска потока записи. Размер округляется вверх до
+         * степени двойки. Строки длиннее четверти буфера сохраняются в буфере
+         * обрезанными (файл журнала это не затрагивает).
+         *
+         * @param bytes Размер буфера, байт. 0 - буфер не ведётся
+         */
+        void setCapacity(std::int64_t bytes);
+
+        /**
+         * @brief Проверка того, что буфер ведётся
+         */
+        bool isEnabled() const      {   return m_capacity != 0; }
+
+        /**
+         * @brief Создание курсора подписчика
+         *
+         * @param level Наименее важный читаемый уровень (строки остальных уровней
+         * пропускаются без учёта в Line::missed)
+         * @param fromOldest true - начать с самой старой строки буфера, false - только
+         * новые строки
+         * @return Курсор
+         */
+        Cursor subscribe(LoggerLevel level = LoggerLevel::Developer, bool fromOldest = false) const;
+
+        /**
+         * @brief Чтение следующей строки
+         *
+         * @param cursor Курсор подписчика
+         * @param line Строка (действительна до следующего вызова next() с этим курсором)
+         * @return true если строка прочитана или false если новых строк нет
+         */
+        bool next(Cursor &cursor, Line &line) const;
+
+        /**
+         * @brief Проверка того, что последняя прочитанная строка не была перезаписана
+         * во время обработки
+         *
+         * @param cursor Курсор подписчика
+         * @return true если строка действительна или false если её нужно отбросить
+         * (она будет учтена в Line::missed следующей строки)
+         */
+        bool commit(Cursor &cursor) const;
+
+        /**
+         * @brief Проверка наличия непрочитанных строк
+         */
+        bool pending(const Cursor &cursor) const {
+            return m_head.load(std::memory_order_acquire) != cursor.pos;
+        }
+
+        /**
+         * @brief Ожидание новых строк
+         *
+         * @param cursor Курсор подписчика
+         * @param timeout Максимальное время ожидания
+         * @return true если есть непрочитанные строки
+         */
+        bool wait(const Cursor &cursor, std::chrono::milliseconds timeout) const;
+
+        /**
+         * @brief Добавление строки
+         * @remark Вызывается потоком записи; подписчики узнают о строке после publish().
+         */
+        void append(const char *data, int size, LoggerLevel level);
+
+        /**
+         * @brief Пробуждение ожидающих подписчиков
+         * @remark Вызывается потоком записи один раз на пачку строк.
+         */
+        void publish();
+
+        /**
+         * @brief Установка дескриптора, в который записывается байт при появлении
+         * новых строк (для ожидания строк вместе с сокетами в poll)
+         * @private
+         */
+        void setNotifyFd(int fd);
+
+        /**
+         * @brief Запрос уведомления через дескриптор при следующем publish()
+         * @private
+         */
+        void armNotify() const;
+
+    private:
+        //! Заголовок строки в буфере
+        struct Header {
+            std::uint32_t size;     ///< Размер строки или размер пропуска до конца буфера
+            std::int32_t level;     ///< Уровень сообщения или PadLevel
+            std::uint64_t seq;      ///< Порядковый номер строки
+        };
+
+        static const std::int32_t PadLevel = -0x7FFFFFFF;   ///< Признак пропуска до конца буфера
+        static const std::uint64_t Align = 16;              ///< Выравнивание строк в буфере
+
+        void readHeader(std::uint64_t pos, Header &header) const;
+        void writeHeader(std::uint64_t pos, const Header &header);
+        void reserve(std::uint64_t end);
+        bool overwritten(std::uint64_t pos) const;
+
+        std::uint64_t m_capacity = 0;                   ///< Размер буфера, байт
+        std::unique_ptr<char[]> m_buffer;               ///< Буфер строк
+        std::uint64_t m_write = 0;                      ///< Позиция записи (поток записи)
+        std::uint64_t m_oldest = 0;                     ///< Самая старая строка (поток записи)
+        std::uint64_t m_seq = 0;                        ///< Порядковый номер следующей строки
+
+        std::atomic<std::uint64_t> m_head{0};           ///< Конец опубликованных строк
+        std::atomic<std::uint64_t> m_tail{0};           ///< Самая старая строка буфера
+        std::atomic<std::uint64_t> m_reserved{0};       ///< Конец области, которая может перезаписываться
+
+        mutable std::atomic<int> m_waiters{0};          ///< Количество ожидающих подписчиков
+        mutable std::mutex m_mutex;                     ///< Мьютекс ожидания
+        mutable std::condition_variable m_cv;           ///< Пробуждение ожидающих подписчиков
+        std::atomic<int> m_notifyFd{-1};                ///< Дескриптор уведомления
+        mutable std::atomic<bool> m_notifyArmed{false}; ///< Уведомление через дескриптор запрошено
+    };
+
+/*! \class Трансляция строк журнала через локальный сокет
+ *  \brief Служебный поток принимает подключения к Unix-сокету и передаёт каждому
+ * клиенту новые строки журнала из LoggerTail (аналог tail -f). Клиент может в любой
+ * момент прислать строку с названием уровня ("Warning\n"), после чего получает только
+ * сообщения этого уровня и более важные.
+ *     Медленные клиенты не задерживают ни поток записи, ни других клиентов: отставший
+ * клиент получает строку "-- N lines missed --" и продолжает с самой старой строки
+ * буфера.
+ *     Поддерживается только на Unix-платформах.
+ */
+    class LoggerTailServer {
+    public:
+        LoggerTailServer();
+
+        /**
+         * @brief Деструктор
+         * @remark Закрывает подключения и удаляет файл сокета.
+         */
+        ~LoggerTailServer();
+
+        LoggerTailServer(const LoggerTailServer &) = delete;
+        LoggerTailServer &operator=(const LoggerTailServer &) = delete;
+
+        /**
+         * @brief Запуск потока трансляции
+         *
+         * @param path Путь к файлу сокета (существующий файл заменяется)
+         * @param tail Буфер строк журнала
+         * @param options Параметры потока трансляции
+         * @return true если сокет создан или false в случае ошибок
+         */
+        bool start(const QString &path, LoggerTail *tail,
+                   const LoggerThreadOptions &options = LoggerThreadOptions());
+
+        /**
+         * @brief Завершение потока трансляции
+         */
+        void stop();
+
+    private:
+        void run();
+
+        LoggerTail *m_tail = nullptr;           ///< Буфер строк журнала
+        LoggerThreadOptions m_options;          ///< Параметры потока трансляции
+        QByteArray m_path;                      ///< Путь к файлу сокета
+        int m_listenFd = -1;                    ///< Сокет приёма подключений
+        int m_wakeFds[2] = { -1, -1 };          ///< Канал пробуждения потока
+        std::atomic<bool> m_stop{false};        ///< Флаг завершения потока
+        std::thread m_thread;                   ///< Поток трансляции
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERTAIL_H
@@ -0,0 +1,124 @@
+#include "loggerthread.h"
+
+#include <QByteArray>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+
+#if defined(Q_OS_LINUX)
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+    thread_local LoggerThreadInfo t_loggerThreadInfo = { 0, nullptr };
+
+namespace {
+
+    std::mutex g_namesMutex;            ///< Мьютекс таблицы имён потоков
+    std::set<std::string> g_names;      ///< Имена потоков (адреса строк не меняются)
+
+}
+
+    void initThreadInfo(LoggerThreadInfo &info) {
+#if defined(Q_OS_LINUX)
+        // Системный идентификатор совпадает с отображаемым в top/perf/gdb
+        info.id = static_cast<std::uint32_t>(syscall(SYS_gettid));
+#else
+        static std::atomic<std::uint32_t> nextId(1);
+        info.id = nextId.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+
+    void setCurrentThreadName(const QString &name) {
+        LoggerThreadInfo &info = t_loggerThreadInfo;
+        if (info.id == 0) {
+            initThreadInfo(info);
+        }
+        if (name.isEmpty()) {
+            info.name = nullptr;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(g_namesMutex);
+        info.name = g_names.insert(name.toStdString()).first->c_str();
+    }
+
+#if defined(Q_OS_LINUX)
+
+    bool applyThreadOptions(const LoggerThreadOptions &options, const char *suffix) {
+        bool ok = true;
+        const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+
+        // Имя потока в Linux ограничено 15 символами
+        QByteArray name = options.name.toUtf8();
+        name.append(suffix);
+        name.truncate(15);
+        if (!name.isEmpty()) {
+            pthread_setname_np(pthread_self(), name.constData());
+        }
+
+        if (!options.cpus.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : options.cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+                qWarning("Cannot set CPU affinity of the logger thread %s", name.constData());
+                ok = false;
+            }
+        }
+
+        if (options.policy != LoggerSchedPolicy::SchedNormal) {
+            struct sched_param param;
+            param.sched_priority = 0;
+            const int policy = options.policy == LoggerSchedPolicy::SchedIdle ? SCHED_IDLE : SCHED_BATCH;
+            if (sched_setscheduler(tid, policy, &param) != 0) {
+                qWarning("Cannot set scheduling policy of the logger thread %s", name.constData());
+                ok = false;
+            }
+        }
+
+        // В Linux значение nice относится к отдельному потоку
+        if (options.nice != 0 && setpriority(PRIO_PROCESS, static_cast<id_t>(tid), options.nice) != 0) {
+            qWarning("Cannot set nice value of the logger thread %s", name.constData());
+            ok = false;
+        }
+
+        if (options.numaLocal) {
+            // Память, впервые используемая потоком, выделяется на узле NUMA процессора,
+            // на котором он выполняется (без зависимости от libnuma)
+            if (syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0) != 0) {
+                qWarning("Cannot set NUMA memory policy of the logger thread %s", name.constData());
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+#else
+
+    bool applyThreadOptions(const LoggerThreadOptions &options, const char *) {
+        const bool ok = options.cpus.empty()
+                && options.policy == LoggerSchedPolicy::SchedNormal
+                && options.nice == 0
+                && !options.numaLocal;
+        if (!ok) {
+            qWarning("Logger thread options are supported on Linux only");
+        }
+        return ok;
+    }
+
+#endif
+
+}   // End namespace DIRA_3D_GW
@@ -0,0 +1,65 @@
+#ifndef LOGGERTHREAD_H
+#define LOGGERTHREAD_H
+
+#include "loggertypes.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+    /**
+     * @brief Применение параметров к вызывающему потоку
+     * @remark Вызывается служебным потоком журнала в начале работы, до выделения его
+     * буферов, чтобы при numaLocal память выделялась на узле NUMA процессоров потока.
+     * Привязка к процессорам, политика планирования, nice и NUMA поддерживаются
+     * только в Linux; на остальных платформах устанавливается только имя потока
+     * (если поддерживается).
+     *
+     * @param options Параметры потока
+     * @param suffix Суффикс имени потока (например "-sync")
+     * @return true если все параметры применены или false если часть из них не применена
+     */
+    bool applyThreadOptions(const LoggerThreadOptions &options, const char *suffix = "");
+
+    /**
+     * \struct Сведения о потоке-источнике сообщений
+     */
+    struct LoggerThreadInfo
+    {
+        std::uint32_t id;       ///< Идентификатор потока (tid в Linux, 0 - ещё не определён)
+        const char *name;       ///< Имя потока (nullptr - не задано)
+    };
+
+    //! Сведения о текущем потоке
+    extern thread_local LoggerThreadInfo t_loggerThreadInfo;
+
+    /**
+     * @brief Определение идентификатора текущего потока
+     * @private
+     */
+    void initThreadInfo(LoggerThreadInfo &info);
+
+    /**
+     * @brief Сведения о текущем потоке
+     * @remark Идентификатор определяется при первом обращении в потоке, далее
+     * обращение стоит одного чтения thread local переменной.
+     */
+    inline const LoggerThreadInfo &currentThreadInfo() {
+        LoggerThreadInfo &info = t_loggerThreadInfo;
+        if (info.id == 0) {
+            initThreadInfo(info);
+        }
+        return info;
+    }
+
+    /**
+     * @brief Установка имени текущего потока для записей журнала
+     * @remark Имена хранятся до завершения программы, поэтому записи очереди ссылаются
+     * на них без копирования. Одинаковые имена хранятся один раз.
+     *
+     * @param name Имя потока
+     */
+    void setCurrentThreadName(const QString &name);
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERTHREAD_H
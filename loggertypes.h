@@ -1,6 +1,13 @@
 #ifndef LOGGERTYPES_H
 #define LOGGERTYPES_H
 
+#include <QString>
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
 //! Namespace for Graphical Workstation of the 6G_DIRA_3D project
 namespace DIRA_3D_GW {
 
@@ -23,6 +30,167 @@ enum LoggerLevel
     Developer = 5,  // Логгирование для разработчика. Например, свойства объектов, dump памяти и т.п.
 };
 
+//! Количество уровней ведения журнала (от System до Developer)
+static const int LoggerLevelsCount = LoggerLevel::Developer - LoggerLevel::System + 1;
+
+/**
+ * \struct Статистика выборочной записи сообщений одного уровня
+ */
+struct LoggerSamplingStats
+{
+    std::uint32_t rate = 1;     ///< Записывается одно сообщение из rate
+    std::uint64_t written = 0;  ///< Количество записанных сообщений
+    std::uint64_t skipped = 0;  ///< Количество пропущенных сообщений
+};
+
+/**
+ * \struct Статистика использования пула записей очереди сообщений
+ */
+struct LoggerArenaStats
+{
+    std::uint32_t slots = 0;            ///< Количество ячеек пула (всех классов размера)
+    std::uint32_t slotSize = 0;         ///< Размер ячейки наименьшего класса, байт
+    std::uint32_t freeSlots = 0;        ///< Количество ячеек в общих списках свободных
+    std::uint64_t heapAllocations = 0;  ///< Количество записей, выделенных в куче
+};
+
+/**
+ * \struct Статистика передачи сообщений в syslog
+ */
+struct LoggerSyslogStats
+{
+    std::uint64_t sent = 0;             ///< Количество переданных сообщений
+    std::uint64_t dropped = 0;          ///< Количество отброшенных сообщений (syslog недоступен или не успевает)
+};
+
+/**
+ * \enum Перечисление поддерживаемых форматов записи в файл журнала
+ */
+enum LoggerFormat
+{
+    Text = 0,       // Текстовый формат: "дата [уровень]: сообщение [файл (строка)]"
+    JsonLines = 1,  // Одна JSON запись на строку (JSON Lines)
+    Logfmt = 2,     // Строка пар ключ=значение (logfmt)
+};
+
+/**
+ * \enum Перечисление режимов сохранности записанных сообщений
+ */
+enum LoggerDurability
+{
+    Flush = 0,          // Строки передаются ядру без fdatasync (данные в кеше ОС)
+    GroupCommit = 1,    // fdatasync не чаще одного раза в интервал синхронизации
+    CriticalSync = 2,   // Как GroupCommit, но пачка с Critical/System сообщениями
+                        // синхронизируется сразу после записи
+    FullSync = 3,       // Синхронизация после каждой пачки сообщений
+};
+
+/**
+ * \enum Перечисление методов сжатия файлов журнала
+ */
+enum LoggerCompression
+{
+    CompressionNone = 0,    // Без сжатия
+    CompressionGzip = 1,    // Кадры gzip (zlib), файл читается zcat
+    CompressionZstd = 2,    // Кадры zstd, файл читается zstdcat. Требует сборки с libzstd
+};
+
+/**
+ * \enum Перечисление источников времени сообщений
+ */
+enum LoggerClockSource
+{
+    ClockRealtime = 0,      // Системное время (по умолчанию)
+    ClockMonotonicRaw = 1,  // CLOCK_MONOTONIC_RAW с переводом в системное время потоком записи
+    ClockTsc = 2,           // Счётчик тактов процессора (rdtsc) с переводом в системное время
+                            // потоком записи. Требует инвариантного TSC (x86)
+};
+
+/**
+ * \enum Перечисление режимов открытия файла журнала при инициализации
+ */
+enum LoggerOpenMode
+{
+    OpenDeferred = 0,   // Файл открывается потоком записи, инициализация его не ожидает
+    OpenSync = 1,       // Инициализация ожидает открытия файла и возвращает его результат
+};
+
+/**
+ * \enum Перечисление политик планирования служебных потоков журнала
+ */
+enum LoggerSchedPolicy
+{
+    SchedNormal = 0,    // Обычная политика планирования (SCHED_OTHER)
+    SchedBatch = 1,     // Фоновая пакетная обработка (SCHED_BATCH)
+    SchedIdle = 2,      // Выполнение только при простое процессора (SCHED_IDLE)
+};
+
+/**
+ * \struct Параметры служебных потоков журнала (потока записи и потока синхронизации)
+ */
+struct LoggerThreadOptions
+{
+    std::vector<int> cpus;                          ///< Номера процессоров для привязки потока (пусто - без привязки)
+    LoggerSchedPolicy policy = SchedNormal;         ///< Политика планирования
+    int nice = 0;                                   ///< Значение nice потока (0 - не изменяется)
+    QString name = QString("qt-logger");           ///< Имя потока для top/perf (до 15 символов)
+    bool numaLocal = false;                         ///< Выделять память потока на локальном узле NUMA
+};
+
+/**
+ * \class Типизированное поле структурированного сообщения журнала
+ * \brief Хранит имя и значение одного поля сообщения (целое со знаком или без
+ * знака, логическое, вещественное, строка или длительность).
+ *     Имя поля не копируется, поэтому оно должно быть строковым литералом или
+ * другой строкой со статическим временем жизни.
+ */
+class LoggerField
+{
+public:
+    enum Type : std::uint8_t
+    {
+        Int = 0,        // Целое число со знаком
+        Double = 1,     // Вещественное число
+        String = 2,     // Строка
+        Duration = 3,   // Длительность в наносекундах
+        Bool = 4,       // Логическое значение
+        UInt = 5,       // Целое число без знака
+    };
+
+    // Любой целый тип (long, unsigned, std::size_t, qint64 ...) сохраняется в 64 битах
+    template <typename T, typename std::enable_if<std::is_integral<T>::value
+                                                  && !std::is_same<T, bool>::value, int>::type = 0>
+    LoggerField(const char *key, T value)
+        : m_key(key), m_type(std::is_signed<T>::value ? Int : UInt)
+        , m_int(static_cast<std::int64_t>(value)), m_double(0.0) {}
+    LoggerField(const char *key, bool value)
+        : m_key(key), m_type(Bool), m_int(value ? 1 : 0), m_double(0.0) {}
+    LoggerField(const char *key, double value)
+        : m_key(key), m_type(Double), m_int(0), m_double(value) {}
+    LoggerField(const char *key, const QString &value)
+        : m_key(key), m_type(String), m_int(0), m_double(0.0), m_string(value) {}
+    LoggerField(const char *key, const char *value)
+        : m_key(key), m_type(String), m_int(0), m_double(0.0), m_string(QString::fromUtf8(value)) {}
+    template <typename Rep, typename Period>
+    LoggerField(const char *key, std::chrono::duration<Rep, Period> value)
+        : m_key(key), m_type(Duration)
+        , m_int(std::chrono::duration_cast<std::chrono::nanoseconds>(value).count())
+        , m_double(0.0) {}
+
+    const char *key() const         {   return m_key;       }
+    Type type() const               {   return m_type;      }
+    std::int64_t toInt() const      {   return m_int;       }
+    double toDouble() const         {   return m_double;    }
+    const QString &toString() const {   return m_string;    }
+
+private:
+    const char *m_key;      ///< Имя поля
+    Type m_type;            ///< Тип значения поля
+    std::int64_t m_int;     ///< Значение для типов Int, UInt, Bool и Duration
+    double m_double;        ///< Значение для типа Double
+    QString m_string;       ///< Значение для типа String
+};
+
 }   // End namespace DIRA_3D_GW
 
 #endif // LOGGERTYPES_H
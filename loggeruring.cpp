@@ -0,0 +1,435 @@
+#include "loggeruring.h"
+
+#if defined(LOGGER_IO_URING)
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+    int uring_setup(unsigned entries, io_uring_params *params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int uring_enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    int uring_register(int fd, unsigned opcode, const void *arg, unsigned count) {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+    }
+
+    unsigned load_acquire(const unsigned *p)        {   return __atomic_load_n(p, __ATOMIC_ACQUIRE);    }
+    void store_release(unsigned *p, unsigned v)     {   __atomic_store_n(p, v, __ATOMIC_RELEASE);       }
+
+    /**
+     * @brief Синхронная запись данных по смещению (используется при ошибках и
+     * неполной записи через io_uring)
+     */
+    bool write_all(int fd, const char *data, std::size_t size, std::int64_t offset) {
+        while (size > 0) {
+            const ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += n;
+            size -= static_cast<std::size_t>(n);
+            offset += n;
+        }
+        return true;
+    }
+
+}
+
+    /**
+     * @brief Буфер записи
+     */
+    struct UringBuffer {
+        bool busy = false;          ///< Буфер находится в обработке ядром
+        bool sync = false;          ///< После записи буфера запрошен fdatasync
+        int fd = -1;                ///< Дескриптор файла
+        std::int64_t offset = 0;    ///< Смещение записи в файле
+        iovec iov;                  ///< Адрес и размер данных
+    };
+
+    struct LoggerUringWriter::Ring {
+        int fd = -1;                        ///< Дескриптор io_uring
+
+        void *sqMap = nullptr;              ///< Отображение очереди отправки
+        std::size_t sqMapSize = 0;
+        void *cqMap = nullptr;              ///< Отображение очереди завершения
+        std::size_t cqMapSize = 0;
+        io_uring_sqe *sqes = nullptr;       ///< Массив элементов очереди отправки
+        std::size_t sqesSize = 0;
+
+        unsigned *sqTail = nullptr;
+        unsigned sqMask = 0;
+        unsigned *sqArray = nullptr;
+        unsigned *cqHead = nullptr;
+        unsigned *cqTail = nullptr;
+        unsigned cqMask = 0;
+        io_uring_cqe *cqes = nullptr;
+
+        char *memory = nullptr;             ///< Память буферов записи
+        std::size_t memorySize = 0;
+        std::size_t bufferSize = 0;         ///< Размер одного буфера
+        bool fixed = false;                 ///< Буферы зарегистрированы в ядре
+        std::vector<UringBuffer> buffers;   ///< Буферы записи
+
+        unsigned pending = 0;               ///< Подготовленные, но не отправленные операции
+        unsigned inflight = 0;              ///< Отправленные, но не завершённые операции
+        bool failed = false;                ///< Произошла ошибка записи
+
+        ~Ring() {
+            if (memory) {
+                munmap(memory, memorySize);
+            }
+            if (sqes) {
+                munmap(sqes, sqesSize);
+            }
+            if (cqMap && cqMap != sqMap) {
+                munmap(cqMap, cqMapSize);
+            }
+            if (sqMap) {
+                munmap(sqMap, sqMapSize);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        io_uring_sqe *nextSqe() {
+            const unsigned tail = *sqTail + pending;
+            const unsigned index = tail & sqMask;
+            io_uring_sqe *sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqArray[index] = index;
+            ++pending;
+            return sqe;
+        }
+    };
+
+    LoggerUringWriter::LoggerUringWriter(): m_ring(nullptr)
+                                          , m_fd(-1)
+                                          , m_offset(0)
+    {}
+
+    LoggerUringWriter::~LoggerUringWriter() {
+        drain();
+        delete m_ring;
+    }
+
+    bool LoggerUringWriter::init(int buffers, std::size_t bufferSize) {
+        if (m_ring || buffers <= 0 || bufferSize == 0) {
+            return false;
+        }
+
+        Ring *ring = new Ring();
+        std::unique_ptr<Ring> guard(ring);
+
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        // На каждый буфер - запись и, возможно, связанный с ней fdatasync
+        ring->fd = uring_setup(static_cast<unsigned>(buffers) * 2, &params);
+        if (ring->fd < 0) {
+            return false;
+        }
+
+        ring->sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap && ring->cqMapSize > ring->sqMapSize) {
+            ring->sqMapSize = ring->cqMapSize;
+        }
+
+        ring->sqMap = mmap(nullptr, ring->sqMapSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+        if (ring->sqMap == MAP_FAILED) {
+            ring->sqMap = nullptr;
+            return false;
+        }
+        if (singleMap) {
+            ring->cqMap = ring->sqMap;
+        } else {
+            ring->cqMap = mmap(nullptr, ring->cqMapSize, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+            if (ring->cqMap == MAP_FAILED) {
+                ring->cqMap = nullptr;
+                return false;
+            }
+        }
+
+        ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        ring->sqes = static_cast<io_uring_sqe *>(sqes);
+
+        char *sq = static_cast<char *>(ring->sqMap);
+        char *cq = static_cast<char *>(ring->cqMap);
+        ring->sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        ring->sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        ring->sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        ring->cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        ring->cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        ring->cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        ring->cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        ring->bufferSize = bufferSize;
+        ring->memorySize = bufferSize * static_cast<std::size_t>(buffers);
+        void *memory = mmap(nullptr, ring->memorySize, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            return false;
+        }
+        ring->memory = static_cast<char *>(memory);
+
+        ring->buffers.resize(static_cast<std::size_t>(buffers));
+        std::vector<iovec> iovs(ring->buffers.size());
+        for (std::size_t i = 0; i < ring->buffers.size(); ++i) {
+            iovs[i].iov_base = ring->memory + i * bufferSize;
+            iovs[i].iov_len = bufferSize;
+        }
+        // Регистрация буферов избавляет ядро от отображения страниц на каждую
+        // запись. При нехватке RLIMIT_MEMLOCK используется обычная векторная запись.
+        ring->fixed = uring_register(ring->fd, IORING_REGISTER_BUFFERS,
+                                     iovs.data(), static_cast<unsigned>(iovs.size())) == 0;
+
+        m_ring = guard.release();
+        return true;
+    }
+
+    bool LoggerUringWriter::isActive() const {
+        return m_ring != nullptr;
+    }
+
+    void LoggerUringWriter::attach(int fd, std::int64_t offset) {
+        m_fd = fd;
+        m_offset = offset;
+        if (m_ring) {
+            m_ring->failed = false;
+        }
+    }
+
+    std::int64_t LoggerUringWriter::offset() const {
+        return m_offset;
+    }
+
+    bool LoggerUringWriter::write(const char *data, std::size_t size, bool sync) {
+        if (!m_ring || m_fd < 0) {
+            return false;
+        }
+
+        while (size > 0) {
+            const int index = freeBuffer();
+            UringBuffer &buf = m_ring->buffers[static_cast<std::size_t>(index)];
+            const std::size_t chunk = size < m_ring->bufferSize ? size : m_ring->bufferSize;
+            char *dst = m_ring->memory + static_cast<std::size_t>(index) * m_ring->bufferSize;
+            std::memcpy(dst, data, chunk);
+
+            data += chunk;
+            size -= chunk;
+
+            buf.busy = true;
+            buf.sync = sync && size == 0;
+            buf.fd = m_fd;
+            buf.offset = m_offset;
+            buf.iov.iov_base = dst;
+            buf.iov.iov_len = chunk;
+
+            io_uring_sqe *sqe = m_ring->nextSqe();
+            sqe->fd = m_fd;
+            sqe->off = static_cast<std::uint64_t>(m_offset);
+            sqe->user_data = static_cast<std::uint64_t>(index) + 1;
+            if (m_ring->fixed) {
+                sqe->opcode = IORING_OP_WRITE_FIXED;
+                sqe->addr = reinterpret_cast<std::uint64_t>(dst);
+                sqe->len = static_cast<std::uint32_t>(chunk);
+                sqe->buf_index = static_cast<std::uint16_t>(index);
+            } else {
+                sqe->opcode = IORING_OP_WRITEV;
+                sqe->addr = reinterpret_cast<std::uint64_t>(&buf.iov);
+                sqe->len = 1;
+            }
+            m_offset += static_cast<std::int64_t>(chunk);
+
+            if (buf.sync) {
+                // fdatasync выполняется после завершения этой записи (IO_LINK) и всех
+                // ранее отправленных (IO_DRAIN), а при ошибке записи отменяется
+                sqe->flags |= IOSQE_IO_LINK;
+                prepareSync();
+            }
+            submitPending();
+        }
+
+        const bool ok = !m_ring->failed;
+        m_ring->failed = false;
+        return ok;
+    }
+
+    bool LoggerUringWriter::sync() {
+        if (!m_ring || m_fd < 0) {
+            return false;
+        }
+        // Для нового fdatasync нужна свободная ячейка очереди отправки
+        while (m_ring->inflight + 1 > m_ring->buffers.size() * 2) {
+            reap(1);
+        }
+        prepareSync();
+        submitPending();
+
+        const bool ok = !m_ring->failed;
+        m_ring->failed = false;
+        return ok;
+    }
+
+    void LoggerUringWriter::prepareSync() {
+        io_uring_sqe *fsync = m_ring->nextSqe();
+        fsync->opcode = IORING_OP_FSYNC;
+        fsync->flags = IOSQE_IO_DRAIN;
+        fsync->fd = m_fd;
+        fsync->fsync_flags = IORING_FSYNC_DATASYNC;
+        fsync->user_data = 0;
+    }
+
+    void LoggerUringWriter::drain() {
+        if (!m_ring) {
+            return;
+        }
+        submitPending();
+        while (m_ring->inflight > 0) {
+            reap(1);
+        }
+    }
+
+    void LoggerUringWriter::submitPending() {
+        while (m_ring->pending > 0) {
+            store_release(m_ring->sqTail, *m_ring->sqTail + m_ring->pending);
+            const unsigned count = m_ring->pending;
+            m_ring->pending = 0;
+            m_ring->inflight += count;
+
+            int ret;
+            unsigned submitted = 0;
+            while (submitted < count) {
+                ret = uring_enter(m_ring->fd, count - submitted, 0, 0);
+                if (ret > 0) {
+                    submitted += static_cast<unsigned>(ret);
+                } else if (ret < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY)) {
+                    // Очередь завершения переполнена - освобождаем её и повторяем
+                    reap(0);
+                } else {
+                    break;
+                }
+            }
+            if (submitted < count) {
+                // Ядро не принимает операции: дальнейшая запись невозможна
+                m_ring->failed = true;
+                m_ring->inflight -= count - submitted;
+            }
+        }
+    }
+
+    void LoggerUringWriter::reap(unsigned minComplete) {
+        if (minComplete > 0) {
+            const int ret = uring_enter(m_ring->fd, 0, minComplete, IORING_ENTER_GETEVENTS);
+            if (ret < 0 && errno != EINTR && errno != EAGAIN) {
+                m_ring->failed = true;
+                m_ring->inflight = 0;
+                for (auto &buf : m_ring->buffers) {
+                    buf.busy = false;
+                }
+                return;
+            }
+        }
+
+        unsigned head = *m_ring->cqHead;
+        const unsigned tail = load_acquire(m_ring->cqTail);
+        while (head != tail) {
+            const io_uring_cqe &cqe = m_ring->cqes[head & m_ring->cqMask];
+            ++head;
+            --m_ring->inflight;
+
+            if (cqe.user_data == 0) {
+                // Завершение fdatasync; отмена (-ECANCELED) обрабатывается вместе с записью
+                if (cqe.res < 0 && cqe.res != -ECANCELED) {
+                    m_ring->failed = true;
+                }
+                continue;
+            }
+
+            UringBuffer &buf = m_ring->buffers[static_cast<std::size_t>(cqe.user_data - 1)];
+            const std::size_t size = buf.iov.iov_len;
+            if (cqe.res < 0 || static_cast<std::size_t>(cqe.res) < size) {
+                // Ошибка или неполная запись: остаток дописывается синхронно
+                const std::size_t done = cqe.res > 0 ? static_cast<std::size_t>(cqe.res) : 0;
+                if (!write_all(buf.fd, static_cast<const char *>(buf.iov.iov_base) + done,
+                               size - done, buf.offset + static_cast<std::int64_t>(done))
+                        || (buf.sync && fdatasync(buf.fd) != 0)) {
+                    m_ring->failed = true;
+                }
+            }
+            buf.busy = false;
+        }
+        store_release(m_ring->cqHead, head);
+    }
+
+    int LoggerUringWriter::freeBuffer() {
+        for (;;) {
+            reap(0);
+            for (std::size_t i = 0; i < m_ring->buffers.size(); ++i) {
+                if (!m_ring->buffers[i].busy) {
+                    return static_cast<int>(i);
+                }
+            }
+            reap(1);
+        }
+    }
+
+}   // End namespace DIRA_3D_GW
+
+#else
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+    struct LoggerUringWriter::Ring {};
+
+    LoggerUringWriter::LoggerUringWriter(): m_ring(nullptr)
+                                          , m_fd(-1)
+                                          , m_offset(0)
+    {}
+
+    LoggerUringWriter::~LoggerUringWriter() {}
+
+    bool LoggerUringWriter::init(int, std::size_t)          {   return false;       }
+    bool LoggerUringWriter::isActive() const                {   return false;       }
+    void LoggerUringWriter::attach(int fd, std::int64_t offset) {   m_fd = fd; m_offset = offset;   }
+    std::int64_t LoggerUringWriter::offset() const          {   return m_offset;    }
+    bool LoggerUringWriter::write(const char *, std::size_t, bool)  {   return false;   }
+    bool LoggerUringWriter::sync()                          {   return false;       }
+    void LoggerUringWriter::prepareSync()                   {}
+    void LoggerUringWriter::drain()                         {}
+    void LoggerUringWriter::submitPending()                 {}
+    void LoggerUringWriter::reap(unsigned)                  {}
+    int LoggerUringWriter::freeBuffer()                     {   return -1;          }
+
+}   // End namespace DIRA_3D_GW
+
+#endif
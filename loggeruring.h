@@ -0,0 +1,103 @@
+#ifndef LOGGERURING_H
+#define LOGGERURING_H
+
+#include <cstddef>
+#include <cstdint>
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Асинхронная запись файла журнала через io_uring (Linux)
+ *  \brief Позволяет потоку записи не блокироваться на записи в файл: данные копируются
+ * в один из нескольких зарегистрированных в ядре буферов и отправляются операцией
+ * IORING_OP_WRITE_FIXED по явному смещению, после чего поток записи продолжает
+ * работу. Одновременно в обработке ядром может находиться несколько буферов.
+ *     Запись может быть связана (IOSQE_IO_LINK) с последующей операцией fdatasync,
+ * которая выполнится только после завершения записи.
+ *     Доступна при сборке с макросом LOGGER_IO_URING (опция CMake QT_LOGGER_IO_URING).
+ * Если io_uring не поддерживается ядром или сборкой, init() возвращает false и
+ * используется обычная запись через QFile.
+ */
+    class LoggerUringWriter {
+    public:
+        LoggerUringWriter();
+
+        /**
+         * @brief Деструктор
+         * @remark Дожидается завершения всех операций и освобождает ресурсы io_uring.
+         */
+        ~LoggerUringWriter();
+
+        LoggerUringWriter(const LoggerUringWriter &) = delete;
+        LoggerUringWriter &operator=(const LoggerUringWriter &) = delete;
+
+        /**
+         * @brief Создание io_uring и регистрация буферов записи
+         *
+         * @param buffers Количество буферов, одновременно находящихся в обработке
+         * @param bufferSize Размер одного буфера, байт
+         * @return true если асинхронная запись доступна или false в противном случае
+         */
+        bool init(int buffers = 4, std::size_t bufferSize = 256 * 1024);
+
+        /**
+         * @brief Проверка того, что асинхронная запись инициализирована
+         */
+        bool isActive() const;
+
+        /**
+         * @brief Установка файла для записи
+         * @remark Перед сменой или закрытием файла необходимо вызвать drain().
+         *
+         * @param fd Дескриптор файла (открытого без O_APPEND)
+         * @param offset Смещение, с которого продолжается запись (размер файла)
+         */
+        void attach(int fd, std::int64_t offset);
+
+        /**
+         * @brief Асинхронная запись данных в конец файла
+         * @remark Данные копируются в буфер, поэтому могут быть изменены сразу после
+         * возврата. Если все буферы заняты, ожидается завершение одной из операций.
+         *
+         * @param data Данные
+         * @param size Размер данных, байт
+         * @param sync Выполнить fdatasync после завершения записи
+         * @return true если данные отправлены на запись или false в случае ошибок
+         */
+        bool write(const char *data, std::size_t size, bool sync = false);
+
+        /**
+         * @brief Асинхронная синхронизация (fdatasync) файла
+         * @remark Выполняется после завершения всех ранее отправленных операций записи.
+         *
+         * @return true если операция отправлена или false в случае ошибок
+         */
+        bool sync();
+
+        /**
+         * @brief Ожидание завершения всех отправленных операций
+         */
+        void drain();
+
+        /**
+         * @brief Логический размер файла с учётом отправленных, но ещё не завершённых
+         * операций записи
+         */
+        std::int64_t offset() const;
+
+    private:
+        struct Ring;
+
+        void prepareSync();
+        void submitPending();
+        void reap(unsigned minComplete);
+        int freeBuffer();
+
+        Ring *m_ring;               ///< Состояние io_uring (nullptr - не инициализирован)
+        int m_fd;                   ///< Дескриптор файла журнала
+        std::int64_t m_offset;      ///< Смещение следующей записи
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERURING_H
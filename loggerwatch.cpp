@@ -0,0 +1,164 @@
+#include "loggerwatch.h"
+#include "loggerthread.h"
+
+#include <QFileInfo>
+
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+#include <sys/inotify.h>
+#endif
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+namespace {
+
+#if defined(Q_OS_UNIX)
+    bool set_nonblocking(int fd) {
+        const int flags = fcntl(fd, F_GETFL, 0);
+        return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1
+                && fcntl(fd, F_SETFD, FD_CLOEXEC) != -1;
+    }
+#endif
+
+}
+
+    LoggerConfigWatcher::LoggerConfigWatcher() {}
+
+    LoggerConfigWatcher::~LoggerConfigWatcher() {
+        stop();
+    }
+
+    bool LoggerConfigWatcher::start(const QString &file, std::function<void()> changed,
+                                    const LoggerThreadOptions &options) {
+        stop();
+#if defined(Q_OS_UNIX)
+        const QFileInfo info(file);
+        m_file = info.absoluteFilePath();
+        m_changed = std::move(changed);
+        m_options = options;
+
+        if (pipe(m_wakeFds) != 0 || !set_nonblocking(m_wakeFds[0]) || !set_nonblocking(m_wakeFds[1])) {
+            qWarning("Cannot create the configuration watcher wakeup pipe");
+            stop();
+            return false;
+        }
+#if defined(Q_OS_LINUX)
+        // Отслеживается каталог: при замене файла переименованием наблюдение за
+        // самим файлом было бы потеряно
+        m_notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_notifyFd < 0 || inotify_add_watch(m_notifyFd, info.absolutePath().toLocal8Bit().constData(),
+                                                IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            qWarning("Cannot watch the directory %s: %s, the configuration file will be polled",
+                     qPrintable(info.absolutePath()), std::strerror(errno));
+            if (m_notifyFd >= 0) {
+                ::close(m_notifyFd);
+                m_notifyFd = -1;
+            }
+        }
+#endif
+        modified();
+        m_stop = false;
+        m_thread = std::thread(&LoggerConfigWatcher::run, this);
+        return true;
+#else
+        Q_UNUSED(file);
+        Q_UNUSED(changed);
+        Q_UNUSED(options);
+        qWarning("Configuration file watching is not supported on this platform");
+        return false;
+#endif
+    }
+
+    void LoggerConfigWatcher::stop() {
+#if defined(Q_OS_UNIX)
+        m_stop = true;
+        if (m_thread.joinable()) {
+            const char byte = 1;
+            if (::write(m_wakeFds[1], &byte, 1) < 0) {
+                // Канал заполнен - поток уже будет разбужен
+            }
+            m_thread.join();
+        }
+        if (m_notifyFd >= 0) {
+            ::close(m_notifyFd);
+            m_notifyFd = -1;
+        }
+        for (int &fd : m_wakeFds) {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+#endif
+        m_changed = nullptr;
+    }
+
+    bool LoggerConfigWatcher::modified() {
+        const QFileInfo info(m_file);
+        const QDateTime time = info.exists() ? info.lastModified() : QDateTime();
+        const qint64 size = info.exists() ? info.size() : -1;
+        const bool changed = time != m_modified || size != m_size;
+        m_modified = time;
+        m_size = size;
+        return changed;
+    }
+
+    void LoggerConfigWatcher::run() {
+#if defined(Q_OS_UNIX)
+        applyThreadOptions(m_options, "-conf");
+
+        const QByteArray name = QFileInfo(m_file).fileName().toLocal8Bit();
+        // Изменение замечено, обработчик вызывается после паузы DebounceMs
+        bool pending = false;
+
+        while (!m_stop.load(std::memory_order_acquire)) {
+            pollfd fds[2] = { pollfd{m_wakeFds[0], POLLIN, 0}, pollfd{m_notifyFd, POLLIN, 0} };
+            const nfds_t count = m_notifyFd >= 0 ? 2 : 1;
+            const int timeout = pending ? DebounceMs : m_notifyFd >= 0 ? -1 : 1000;
+            const int ready = poll(fds, count, timeout);
+            if (ready < 0 || m_stop.load(std::memory_order_acquire)) {
+                continue;
+            }
+            if (ready == 0) {
+                if (pending) {
+                    pending = false;
+                    modified();
+                    m_changed();
+                } else if (m_notifyFd < 0) {
+                    pending = modified();
+                }
+                continue;
+            }
+            if (fds[0].revents & POLLIN) {
+                char drain[64];
+                while (::read(m_wakeFds[0], drain, sizeof(drain)) > 0) {}
+            }
+#if defined(Q_OS_LINUX)
+            if (count > 1 && (fds[1].revents & POLLIN)) {
+                alignas(inotify_event) char buf[4096];
+                ssize_t n;
+                while ((n = ::read(m_notifyFd, buf, sizeof(buf))) > 0) {
+                    for (ssize_t pos = 0; pos < n; ) {
+                        const inotify_event *ev = reinterpret_cast<const inotify_event *>(buf + pos);
+                        if (ev->len > 0 && std::strcmp(ev->name, name.constData()) == 0) {
+                            pending = true;
+                        }
+                        pos += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+                    }
+                }
+            }
+#endif
+        }
+#endif
+    }
+
+}   // End namespace DIRA_3D_GW
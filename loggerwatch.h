@@ -0,0 +1,82 @@
+#ifndef LOGGERWATCH_H
+#define LOGGERWATCH_H
+
+#include <QtCore/qglobal.h>
+#include <QString>
+#include <QDateTime>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "loggertypes.h"
+
+//! Namespace for Graphical Workstation of the 6G_DIRA_3D project
+namespace DIRA_3D_GW {
+
+/*! \class Отслеживание изменений файла конфигурации
+ *  \brief Служебный поток вызывает обработчик после каждого изменения файла.
+ * На Linux изменения отслеживаются через inotify по каталогу файла, поэтому
+ * замечается и замена файла переименованием (так сохраняют файлы большинство
+ * редакторов). На остальных Unix-платформах раз в секунду сравниваются время
+ * изменения и размер файла.
+ *     Серия изменений, следующих друг за другом чаще DebounceMs, приводит к одному
+ * вызову обработчика после последнего изменения. Поток не использует цикл событий
+ * Qt, поэтому работает в приложениях без QCoreApplication::exec().
+ */
+    class LoggerConfigWatcher {
+    public:
+        static const int DebounceMs = 200;      ///< Пауза после изменения перед вызовом обработчика, мс
+
+        LoggerConfigWatcher();
+
+        /**
+         * @brief Деструктор
+         * @remark Останавливает поток отслеживания.
+         */
+        ~LoggerConfigWatcher();
+
+        LoggerConfigWatcher(const LoggerConfigWatcher &) = delete;
+        LoggerConfigWatcher &operator=(const LoggerConfigWatcher &) = delete;
+
+        /**
+         * @brief Запуск отслеживания
+         *
+         * @param file Путь к файлу конфигурации
+         * @param changed Обработчик изменения (вызывается потоком отслеживания)
+         * @param options Параметры потока отслеживания
+         * @return true если отслеживание запущено или false в случае ошибок
+         */
+        bool start(const QString &file, std::function<void()> changed,
+                   const LoggerThreadOptions &options = LoggerThreadOptions());
+
+        /**
+         * @brief Остановка отслеживания
+         * @remark После возврата обработчик больше не вызывается.
+         */
+        void stop();
+
+        /**
+         * @brief Проверка того, что отслеживание запущено
+         */
+        bool isRunning() const  {   return m_thread.joinable(); }
+
+    private:
+        void run();
+        bool modified();
+
+        QString m_file;                         ///< Абсолютный путь к файлу конфигурации
+        std::function<void()> m_changed;        ///< Обработчик изменения
+        LoggerThreadOptions m_options;          ///< Параметры потока отслеживания
+        QDateTime m_modified;                   ///< Время изменения файла при последней проверке
+        qint64 m_size = -1;                     ///< Размер файла при последней проверке
+        int m_notifyFd = -1;                    ///< Дескриптор inotify (Linux)
+        int m_wakeFds[2] = { -1, -1 };          ///< Канал пробуждения потока
+        std::atomic<bool> m_stop{false};        ///< Флаг завершения потока
+        std::thread m_thread;                   ///< Поток отслеживания
+    };
+
+}   // End namespace DIRA_3D_GW
+
+#endif // LOGGERWATCH_H
@@ -0,0 +1,151 @@
+/*
+ * qt-logger-arena-bench - выделения памяти при регистрации сообщений
+ *
+ * Регистрирует сообщения с длинами из распределения, близкого к реальным журналам
+ * (в основном короткие строки, реже - длинные и с символами не ASCII), и считает
+ * обращения к глобальному operator new в потоке-источнике во время вызова
+ * Logger::info(), а так же записи, выделенные LoggerArena в куче. Сообщения
+ * регистрируются пачками меньше пула и с паузой, за которую поток записи
+ * возвращает ячейки: в установившемся режиме куча используется только для
+ * сообщений, не помещающихся в ячейку наибольшего класса.
+ *     Для сравнения выводится доля сообщений, которые не помещались в ячейку при
+ * оценке размера "3 байта на символ" и одном классе ячеек по LoggerArena::SlotSize
+ * байт. Возвращает 1, если в куче выделены записи, помещающиеся в ячейку.
+ */
+
+#include <QDir>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "logger.h"
+#include "loggerarena.h"
+#include "loggerrecord.h"
+
+using namespace DIRA_3D_GW;
+
+namespace {
+
+    thread_local bool t_counting = false;       ///< Подсчёт выделений в текущем потоке
+    std::atomic<std::uint64_t> g_allocations(0);
+
+    /**
+     * @brief Сообщение с длиной из распределения: 70% - 16..120 символов,
+     * 22% - 120..600, 6% - 600..3000 (пятая часть - кириллица), 2% - 4000..8000
+     */
+    QString makeMessage(std::mt19937 &rng) {
+        const int bucket = static_cast<int>(rng() % 100);
+        int length;
+        bool cyrillic = false;
+        if (bucket < 70) {
+            length = 16 + static_cast<int>(rng() % 105);
+        } else if (bucket < 92) {
+            length = 120 + static_cast<int>(rng() % 481);
+        } else if (bucket < 98) {
+            length = 600 + static_cast<int>(rng() % 2401);
+            cyrillic = rng() % 5 == 0;
+        } else {
+            length = 4000 + static_cast<int>(rng() % 4001);
+        }
+        QString message;
+        message.reserve(length);
+        for (int i = 0; i < length; ++i) {
+            const int letter = static_cast<int>(rng() % 26);
+            message.append(cyrillic ? QChar(0x0430 + letter) : QChar('a' + letter));
+        }
+        return message;
+    }
+
+}
+
+void *operator new(std::size_t size) {
+    if (t_counting) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char *argv[]) {
+    const int messagesCount = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const int burst = 256;
+    const QString source("qt-logger-arena-bench.cpp");
+    const QString dir = QDir::tempPath() + "/qt-logger-arena-bench";
+
+    std::mt19937 rng(2024);
+    std::vector<QString> messages;
+    messages.reserve(static_cast<std::size_t>(messagesCount));
+    int oneClassHeap = 0;
+    int largestClassHeap = 0;
+    const std::size_t largest = LoggerArena::slotSize(LoggerArena::ClassesCount - 1) - sizeof(LoggerRecord);
+    for (int i = 0; i < messagesCount; ++i) {
+        messages.push_back(makeMessage(rng));
+        const std::size_t estimate = 3 * static_cast<std::size_t>(messages.back().size() + source.size())
+                                     + 2 * LoggerRecord::NumericFieldSize;
+        if (estimate > LoggerArena::SlotSize - sizeof(LoggerRecord)) {
+            ++oneClassHeap;
+        }
+        if (LoggerRecord::payloadBound(messages.back(), source, {}, 2) > largest) {
+            ++largestClassHeap;
+        }
+    }
+
+    QDir(dir).mkpath(".");
+    std::uint64_t allocations = 0;
+    std::chrono::nanoseconds elapsed(0);
+    LoggerArenaStats stats;
+    {
+        Logger logger;
+        logger.setOpenMode(LoggerOpenMode::OpenSync);
+        if (!logger.init(dir, "arena-bench.log", LoggerLevel::Info)) {
+            std::fprintf(stderr, "Cannot open the log in %s\n", qPrintable(dir));
+            return 2;
+        }
+        for (int i = 0; i < messagesCount; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            t_counting = true;
+            logger.info(messages[static_cast<std::size_t>(i)], source, i);
+            t_counting = false;
+            elapsed += std::chrono::steady_clock::now() - start;
+            if (i % burst == burst - 1) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+        allocations = g_allocations.load();
+        stats = logger.arenaStats();
+    }
+    QDir(dir).removeRecursively();
+
+    std::printf("messages:                        %d\n", messagesCount);
+    std::printf("arena slots:                     %u (%u bytes in class 0)\n", stats.slots, stats.slotSize);
+    std::printf("heap records, size classes:      %llu (%.2f%%)\n",
+                static_cast<unsigned long long>(stats.heapAllocations),
+                100.0 * static_cast<double>(stats.heapAllocations) / messagesCount);
+    std::printf("  larger than the largest class: %d\n", largestClassHeap);
+    std::printf("heap records, one 256-byte class\n"
+                "  with 3 bytes per character:    %d (%.2f%%)\n",
+                oneClassHeap, 100.0 * oneClassHeap / messagesCount);
+    std::printf("operator new calls per message:  %.4f\n",
+                static_cast<double>(allocations) / messagesCount);
+    std::printf("ns per message:                  %.0f\n",
+                static_cast<double>(elapsed.count()) / messagesCount);
+
+    return stats.heapAllocations > static_cast<std::uint64_t>(largestClassHeap) ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * qt-logger-config-test - чтение и проверка файла конфигурации (LoggerConfig)
+ *
+ * Проверяет:
+ *  - разбор размеров: единицы и дробные значения, значения больше 32 бит,
+ *    переполнение 64-битного значения, отрицательные числа и неизвестные единицы;
+ *  - разбор длительностей с единицей и без неё (в единицах ключа);
+ *  - LoggerConfig::load(): применение корректных значений, сохранение значений по
+ *    умолчанию для ошибочных и сообщения errors() о неверных значениях и
+ *    неизвестных ключах.
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+#include <chrono>
+#include <cstdio>
+
+#include "loggerconfig.h"
+
+using namespace DIRA_3D_GW;
+
+namespace {
+
+    int g_failures = 0;
+
+    void check(bool condition, const QString &what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", qPrintable(what));
+            ++g_failures;
+        }
+    }
+
+    void checkSize(const char *text, bool ok, std::int64_t expected = 0) {
+        std::int64_t bytes = -7;
+        const bool parsed = LoggerConfig::parseSize(text, bytes);
+        if (parsed != ok || (ok && bytes != expected) || (!ok && bytes != -7)) {
+            std::printf("FAIL: size \"%s\": %s %lld, expected %s %lld\n", text,
+                        parsed ? "parsed" : "rejected", static_cast<long long>(bytes),
+                        ok ? "parsed" : "rejected", static_cast<long long>(ok ? expected : -7));
+            ++g_failures;
+        }
+    }
+
+    void checkDuration(const char *text, std::chrono::nanoseconds unit, bool ok,
+                       std::chrono::nanoseconds expected = std::chrono::nanoseconds(0)) {
+        std::chrono::nanoseconds value(-7);
+        const bool parsed = LoggerConfig::parseDuration(text, value, unit);
+        if (parsed != ok || (ok && value != expected) || (!ok && value.count() != -7)) {
+            std::printf("FAIL: duration \"%s\": %s %lld ns, expected %s %lld ns\n", text,
+                        parsed ? "parsed" : "rejected", static_cast<long long>(value.count()),
+                        ok ? "parsed" : "rejected", static_cast<long long>(ok ? expected.count() : -7));
+            ++g_failures;
+        }
+    }
+
+    void testSizes() {
+        checkSize("512", true, 512);
+        checkSize("64Kb", true, 64 * 1024);
+        checkSize(" 64 kb ", true, 64 * 1024);
+        checkSize("0.5K", true, 512);
+        checkSize("3Gb", true, 3LL << 30);
+        checkSize("1.5GiB", true, 3LL << 29);
+        checkSize("5GiB", true, 5LL << 30);
+        checkSize("8TiB", true, 8LL << 40);
+        checkSize("1.5", true, 1);
+        checkSize("9223372036854775807", true, 9223372036854775807LL);
+        checkSize("9223372036854775808", false);
+        checkSize("99999999999999999999", false);
+        checkSize("8388608T", false);
+        checkSize("20000000TiB", false);
+        checkSize("8388607.9999999T", true, (8388607LL << 40) + ((1LL << 40) / 1000000 * 999999)
+                  + (1LL << 40) % 1000000 * 999999 / 1000000);
+        checkSize("-1", false);
+        checkSize("-64Kb", false);
+        checkSize("10XB", false);
+        checkSize("10 Kbps", false);
+        checkSize("Kb", false);
+        checkSize("", false);
+        checkSize(".", false);
+    }
+
+    void testDurations() {
+        using std::chrono::nanoseconds;
+        using std::chrono::microseconds;
+        using std::chrono::milliseconds;
+        using std::chrono::seconds;
+        using std::chrono::minutes;
+        using std::chrono::hours;
+
+        checkDuration("250ms", milliseconds(1), true, milliseconds(250));
+        checkDuration("1.5s", milliseconds(1), true, milliseconds(1500));
+        checkDuration("2min", milliseconds(1), true, minutes(2));
+        checkDuration("1h", milliseconds(1), true, hours(1));
+        checkDuration("1d", milliseconds(1), true, hours(24));
+        checkDuration("750 us", milliseconds(1), true, microseconds(750));
+        checkDuration("10ns", milliseconds(1), true, nanoseconds(10));
+        checkDuration("100", milliseconds(1), true, milliseconds(100));
+        checkDuration("100", microseconds(1), true, microseconds(100));
+        checkDuration("1.5", milliseconds(1), true, microseconds(1500));
+        checkDuration("2", seconds(1), true, seconds(2));
+        checkDuration("100000d", milliseconds(1), true, hours(24) * 100000);
+        checkDuration("200000d", milliseconds(1), false);
+        checkDuration("300000d", milliseconds(1), false);
+        checkDuration("-5ms", milliseconds(1), false);
+        checkDuration("5 parsecs", milliseconds(1), false);
+        checkDuration("ms", milliseconds(1), false);
+    }
+
+    void testLoad(const QString &dir) {
+        const QString file = dir + "/logger.ini";
+        QFile ini(file);
+        if (!ini.open(QIODevice::WriteOnly)) {
+            check(false, "cannot write " + file);
+            return;
+        }
+        ini.write("[Logger]\n"
+                  "LogFolder=");
+        ini.write(dir.toUtf8());
+        ini.write("\n"
+                  "LogFileName=test.log\n"
+                  "MaxLogFileSize=3Gb\n"
+                  "IndexInterval=1.5GiB\n"
+                  "SyncInterval=2s\n"
+                  "SyncIntervalMs=\n"
+                  "WriterBatchWindow=250\n"
+                  "LogLevel=debug\n"
+                  "SampleRateDebug=10\n"
+                  "Durability=Sometimes\n"
+                  "ArchiveWorkers=99\n"
+                  "TailBuffer=12 parsecs\n"
+                  "PreallocateExtent=-1\n"
+                  "FallbackBuffer=99999999999999999999\n"
+                  "Colour=blue\n"
+                  "SampleRateBogus=3\n"
+                  "\n"
+                  "[NoSink]\n"
+                  "MaxLogFileSize=-1\n");
+        ini.close();
+
+        LoggerConfig config;
+        check(config.load(file, "Logger"), "section [Logger] is not loaded");
+        const LoggerSettings &s = config.settings();
+        check(s.folder == dir && s.fileName == "test.log", "LogFolder/LogFileName");
+        check(s.maxFileSize == 3LL << 30, QString("MaxLogFileSize: %1").arg(s.maxFileSize));
+        check(s.indexInterval == 3LL << 29, QString("IndexInterval: %1").arg(s.indexInterval));
+        check(s.syncInterval == std::chrono::milliseconds(2000),
+              QString("SyncInterval: %1 ms").arg(static_cast<qint64>(s.syncInterval.count())));
+        check(s.batchWindow == std::chrono::microseconds(250),
+              QString("WriterBatchWindow: %1 us").arg(static_cast<qint64>(s.batchWindow.count())));
+        check(s.level == LoggerLevel::Debug, "LogLevel");
+        check(s.sampleRate[LoggerLevel::Debug - LoggerLevel::System] == 10, "SampleRateDebug");
+        // Ошибочные значения не меняют значения по умолчанию
+        check(s.durability == LoggerDurability::Flush, "Durability changed by an invalid value");
+        check(s.archiveWorkers == LoggerSettings().archiveWorkers, "ArchiveWorkers changed by an invalid value");
+        check(s.tailBuffer == -1, "TailBuffer changed by an invalid value");
+        check(s.preallocateExtent == -1, "PreallocateExtent changed by an invalid value");
+        check(s.fallbackBuffer == -1, "FallbackBuffer changed by an invalid value");
+
+        const QStringList expected = QStringList()
+                << "Durability: invalid value \"Sometimes\""
+                << "ArchiveWorkers: invalid value \"99\""
+                << "TailBuffer: invalid value \"12 parsecs\""
+                << "PreallocateExtent: invalid value \"-1\""
+                << "FallbackBuffer: invalid value \"99999999999999999999\""
+                << "Colour: unknown key"
+                << "SampleRateBogus: unknown key";
+        for (const QString &error : expected) {
+            check(config.errors().contains(error), "missing error: " + error);
+        }
+        for (const QString &error : config.errors()) {
+            check(expected.contains(error), "unexpected error: " + error);
+        }
+
+        // "-1" размера файла - без ограничения, а не ошибка; секция без приёмника
+        // журнала не загружается
+        check(!config.load(file, "NoSink"), "section without a sink is loaded");
+        check(config.settings().maxFileSize == -1, "MaxLogFileSize=-1");
+        check(config.errors().size() == 1 && config.errors().at(0).startsWith("No LogFolder"),
+              "section without a sink: " + config.errors().join("; "));
+
+        check(!config.load(dir + "/missing.ini", "Logger"), "missing file is loaded");
+        check(config.errors().size() == 1 && config.errors().at(0).contains("not found"),
+              "missing file: " + config.errors().join("; "));
+    }
+
+}
+
+int main() {
+    const QString dir = QDir::tempPath() + "/qt-logger-config-test";
+    QDir(dir).removeRecursively();
+    QDir(dir).mkpath(".");
+
+    testSizes();
+    testDurations();
+    testLoad(dir);
+
+    QDir(dir).removeRecursively();
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
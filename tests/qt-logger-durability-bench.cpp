@@ -0,0 +1,163 @@
+/*
+ * qt-logger-durability-bench - стоимость режимов сохранности журнала
+ *
+ * Для каждого режима (Flush, GroupCommit, CriticalSync, FullSync) несколько
+ * потоков-источников регистрируют сообщения, каждое 200-е - Critical: сначала без
+ * пауз (пачки максимального размера), затем с заданной частотой (короткие пачки,
+ * как в обычной работе). Выводятся: пропускная способность от первого сообщения
+ * до закрытия журнала (все строки записаны и синхронизированы), задержка вызова в
+ * потоке-источнике (p50, p99, максимум) и количество вызовов fdatasync. Вызовы считаются подменой fdatasync
+ * в исполняемом файле, поэтому счётчик показывает только синхронизацию потоком
+ * LoggerSyncer; при AsyncIo синхронизация выполняется через io_uring и не
+ * считается.
+ *
+ * Параметры: [потоков] [сообщений на поток] [интервал синхронизации, мс]
+ *            [сообщений в секунду на поток при нагрузке с паузами] [async]
+ */
+
+#include <QDir>
+#include <QString>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+using namespace DIRA_3D_GW;
+
+namespace {
+
+    std::atomic<std::uint64_t> g_syncs(0);
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Result {
+        double seconds = 0;                 ///< Время от первого сообщения до закрытия журнала
+        std::int64_t p50 = 0;               ///< Задержка вызова, нс
+        std::int64_t p99 = 0;
+        std::int64_t max = 0;
+        std::uint64_t syncs = 0;            ///< Вызовов fdatasync
+    };
+
+    Result run(LoggerDurability mode, int producers, int messages,
+               std::chrono::milliseconds interval, int rate, bool async) {
+        const QString dir = QDir::tempPath() + "/qt-logger-durability-bench";
+        QDir(dir).removeRecursively();
+        QDir(dir).mkpath(".");
+
+        // Тексты сообщений готовятся заранее, чтобы измерялась только регистрация
+        std::vector<QString> texts;
+        texts.reserve(static_cast<std::size_t>(messages));
+        for (int n = 0; n < messages; ++n) {
+            texts.push_back(QString("durability benchmark message %1 with a typical payload size").arg(n));
+        }
+        const QString source("qt-logger-durability-bench.cpp");
+
+        std::vector<std::vector<std::int64_t>> latencies(static_cast<std::size_t>(producers));
+        Result result;
+        Clock::time_point start;
+        {
+            Logger logger;
+            logger.setOpenMode(LoggerOpenMode::OpenSync);
+            logger.setDurability(mode, interval);
+            logger.setAsyncIo(async);
+            if (!logger.init(dir, "durability.log", LoggerLevel::Info)) {
+                std::fprintf(stderr, "Cannot open the log in %s\n", qPrintable(dir));
+                std::exit(2);
+            }
+            g_syncs.store(0);
+
+            start = Clock::now();
+            std::vector<std::thread> threads;
+            for (int t = 0; t < producers; ++t) {
+                threads.emplace_back([&, t]() {
+                    std::vector<std::int64_t> &lat = latencies[static_cast<std::size_t>(t)];
+                    lat.reserve(static_cast<std::size_t>(messages));
+                    for (int n = 0; n < messages; ++n) {
+                        if (rate > 0) {
+                            std::this_thread::sleep_until(start + std::chrono::microseconds(
+                                    static_cast<std::int64_t>(n) * 1000000 / rate));
+                        }
+                        const Clock::time_point begin = Clock::now();
+                        if (n % 200 == 199) {
+                            logger.critical(texts[static_cast<std::size_t>(n)], source, n);
+                        } else {
+                            logger.info(texts[static_cast<std::size_t>(n)], source, n);
+                        }
+                        lat.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.syncs = g_syncs.load();
+
+        std::vector<std::int64_t> all;
+        for (const auto &lat : latencies) {
+            all.insert(all.end(), lat.begin(), lat.end());
+        }
+        std::sort(all.begin(), all.end());
+        result.p50 = all[all.size() / 2];
+        result.p99 = all[all.size() * 99 / 100];
+        result.max = all.back();
+
+        QDir(dir).removeRecursively();
+        return result;
+    }
+
+}
+
+extern "C" int fdatasync(int fd) {
+    g_syncs.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<int>(syscall(SYS_fdatasync, fd));
+}
+
+int main(int argc, char *argv[]) {
+    const int producers = argc > 1 ? std::atoi(argv[1]) : 4;
+    const int messages = argc > 2 ? std::atoi(argv[2]) : 50000;
+    const std::chrono::milliseconds interval(argc > 3 ? std::atoi(argv[3]) : 100);
+    const int rate = argc > 4 ? std::atoi(argv[4]) : 5000;
+    const bool async = argc > 5 && std::strcmp(argv[5], "async") == 0;
+
+    struct Mode {
+        LoggerDurability mode;
+        const char *name;
+    };
+    const Mode modes[] = {
+        {LoggerDurability::Flush, "Flush"},
+        {LoggerDurability::GroupCommit, "GroupCommit"},
+        {LoggerDurability::CriticalSync, "CriticalSync"},
+        {LoggerDurability::FullSync, "FullSync"},
+    };
+
+    std::printf("%d threads x %d messages, sync interval %lld ms, %s\n", producers, messages,
+                static_cast<long long>(interval.count()), async ? "io_uring" : "sync thread");
+    for (const int pace : {0, rate}) {
+        if (pace == 0) {
+            std::printf("\nno pauses\n");
+        } else {
+            std::printf("\n%d messages per second per thread\n", pace);
+        }
+        std::printf("%-13s %12s %10s %10s %10s %10s\n", "mode", "msg/s", "p50 ns", "p99 ns", "max us", "fdatasync");
+        for (const Mode &mode : modes) {
+            const Result r = run(mode.mode, producers, messages, interval, pace, async);
+            std::printf("%-13s %12.0f %10lld %10lld %10lld %10llu\n", mode.name,
+                        producers * static_cast<double>(messages) / r.seconds,
+                        static_cast<long long>(r.p50), static_cast<long long>(r.p99),
+                        static_cast<long long>(r.max / 1000), static_cast<unsigned long long>(r.syncs));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,271 @@
+/*
+ * qt-logger-queue-stress-test - передача сообщений потоку записи под нагрузкой
+ *
+ * 1. LoggerSignal: потоки-источники увеличивают счётчик заданий и уведомляют
+ * ожидающий поток, который засыпает с таймаутом 10 с. Потерянное уведомление
+ * проявилось бы задержкой обработки порядка таймаута, поэтому проверяется, что ни
+ * одно задание не ждало дольше границы задержки.
+ * 2. Logger: потоки-источники пачками с паузами (каждая пауза опустошает очередь,
+ * и следующее сообщение будит поток записи) регистрируют пронумерованные
+ * сообщения. Отдельный поток регистрирует метки и ждёт их появления в файле
+ * журнала - время ожидания должно быть меньше границы задержки. После завершения
+ * каждое сообщение должно встретиться в файле ровно один раз и в порядке
+ * регистрации потоком-источником.
+ *
+ * Параметры: [потоков] [сообщений на поток] [граница задержки, мс]
+ */
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "logger.h"
+#include "loggersignal.h"
+
+using namespace DIRA_3D_GW;
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    std::int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Пауза между пачками сообщений потока-источника
+     */
+    void pause(std::mt19937 &rng) {
+        const int us = static_cast<int>(rng() % 200);
+        if (us < 20) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+        }
+    }
+
+    /**
+     * @brief Проверка LoggerSignal без ограничения сна потока записи
+     * @return Максимальная задержка обработки задания, нс
+     */
+    std::int64_t signalStress(int producers, int jobs) {
+        LoggerSignal signal;
+        std::atomic<std::int64_t> posted(0);
+        std::atomic<std::int64_t> done(0);
+        std::atomic<bool> stop(false);
+        std::vector<std::atomic<std::int64_t>> stamps(static_cast<std::size_t>(producers) * jobs);
+        std::int64_t maxDelay = 0;
+
+        std::thread consumer([&]() {
+            std::int64_t handled = 0;
+            for (;;) {
+                const std::uint32_t seen = signal.value();
+                const std::int64_t total = posted.load(std::memory_order_acquire);
+                if (total != handled) {
+                    const std::int64_t now = nowNs();
+                    for (std::int64_t i = handled; i < total; ++i) {
+                        std::int64_t stamp;
+                        while ((stamp = stamps[static_cast<std::size_t>(i)].load(std::memory_order_acquire)) == 0) {
+                            std::this_thread::yield();
+                        }
+                        maxDelay = std::max(maxDelay, now - stamp);
+                    }
+                    handled = total;
+                    done.store(handled, std::memory_order_release);
+                    continue;
+                }
+                if (stop.load(std::memory_order_acquire)) {
+                    break;
+                }
+                signal.wait(seen, std::chrono::seconds(10));
+            }
+        });
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < producers; ++t) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 rng(static_cast<unsigned>(t + 1));
+                for (int n = 0; n < jobs; ++n) {
+                    // Номер задания резервируется до записи отметки времени, поэтому
+                    // поток-обработчик может увидеть задание раньше отметки и ждёт её
+                    const std::int64_t slot = posted.fetch_add(1, std::memory_order_acq_rel);
+                    stamps[static_cast<std::size_t>(slot)].store(nowNs(), std::memory_order_release);
+                    signal.notify();
+                    if (n % 16 == 15) {
+                        pause(rng);
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        while (done.load(std::memory_order_acquire) != posted.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        stop.store(true, std::memory_order_release);
+        signal.notify();
+        consumer.join();
+        return maxDelay;
+    }
+
+    /**
+     * @brief Ожидание появления строки в файле журнала
+     * @return false если строка не появилась за timeout
+     */
+    bool waitLine(QFile &file, QByteArray &pending, const QByteArray &marker, std::chrono::milliseconds timeout) {
+        const Clock::time_point deadline = Clock::now() + timeout;
+        for (;;) {
+            pending.append(file.readAll());
+            const int pos = pending.indexOf(marker);
+            if (pos >= 0) {
+                pending.remove(0, pos + marker.size());
+                return true;
+            }
+            // Хвост сохраняется на случай, если метка записана не полностью
+            if (pending.size() > marker.size()) {
+                pending.remove(0, pending.size() - marker.size());
+            }
+            if (Clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    const int producers = argc > 1 ? std::atoi(argv[1]) : 8;
+    const int messages = argc > 2 ? std::atoi(argv[2]) : 25000;
+    const std::int64_t boundMs = argc > 3 ? std::atoll(argv[3]) : 1000;
+    bool ok = true;
+
+    const std::int64_t signalDelay = signalStress(producers, messages);
+    std::printf("LoggerSignal: %d x %d notifications, max delay %.3f ms\n",
+                producers, messages, signalDelay / 1e6);
+    if (signalDelay > boundMs * 1000000) {
+        std::printf("FAIL: notification handled after %.3f ms (bound %lld ms)\n",
+                    signalDelay / 1e6, static_cast<long long>(boundMs));
+        ok = false;
+    }
+
+    const QString dir = QDir::tempPath() + "/qt-logger-queue-stress-test";
+    QDir(dir).removeRecursively();
+    QDir(dir).mkpath(".");
+    const QString fileName("stress.log");
+
+    int probes = 0;
+    int lateProbes = 0;
+    std::int64_t probeDelay = 0;
+    {
+        Logger logger;
+        logger.setOpenMode(LoggerOpenMode::OpenSync);
+        if (!logger.init(dir, fileName, LoggerLevel::Info)) {
+            std::printf("FAIL: cannot open the log in %s\n", qPrintable(dir));
+            return 1;
+        }
+
+        std::atomic<int> running(producers);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < producers; ++t) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 rng(static_cast<unsigned>(t + 100));
+                for (int n = 0; n < messages; ++n) {
+                    logger.info(QString("stress t=%1 n=%2 ;").arg(t).arg(n));
+                    if (n % 64 == 63) {
+                        pause(rng);
+                    }
+                }
+                running.fetch_sub(1);
+            });
+        }
+
+        QFile reader(dir + "/" + fileName);
+        if (!reader.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+            std::printf("FAIL: cannot read %s\n", qPrintable(reader.fileName()));
+            ok = false;
+        } else {
+            QByteArray pending;
+            while (running.load() != 0) {
+                QByteArray marker("probe ");
+                marker.append(QByteArray::number(probes)).append(" ;");
+                const std::int64_t start = nowNs();
+                logger.info(QString::fromLatin1(marker));
+                if (!waitLine(reader, pending, marker, std::chrono::milliseconds(10 * boundMs))) {
+                    ++lateProbes;
+                    break;
+                }
+                const std::int64_t delay = nowNs() - start;
+                probeDelay = std::max(probeDelay, delay);
+                if (delay > boundMs * 1000000) {
+                    ++lateProbes;
+                }
+                ++probes;
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::printf("Logger: %d probes, max delay %.3f ms\n", probes, probeDelay / 1e6);
+    if (lateProbes != 0) {
+        std::printf("FAIL: %d probes written after more than %lld ms\n",
+                    lateProbes, static_cast<long long>(boundMs));
+        ok = false;
+    }
+
+    // Проверка полноты и порядка сообщений каждого потока
+    QFile log(dir + "/" + fileName);
+    if (!log.open(QIODevice::ReadOnly)) {
+        std::printf("FAIL: cannot read %s\n", qPrintable(log.fileName()));
+        return 1;
+    }
+    const QByteArray text = log.readAll();
+    std::vector<int> next(static_cast<std::size_t>(producers), 0);
+    int lines = 0;
+    int errors = 0;
+    for (int pos = text.indexOf("stress t="); pos >= 0; pos = text.indexOf("stress t=", pos)) {
+        pos += 9;
+        const int space = text.indexOf(' ', pos);
+        const int end = text.indexOf(" ;", pos);
+        const int t = text.mid(pos, space - pos).toInt();
+        const int n = text.mid(space + 3, end - space - 3).toInt();
+        if (t < 0 || t >= producers || n != next[static_cast<std::size_t>(t)]) {
+            if (errors++ < 10) {
+                std::printf("FAIL: thread %d message %d, expected %d\n",
+                            t, n, t >= 0 && t < producers ? next[static_cast<std::size_t>(t)] : -1);
+            }
+        } else {
+            ++next[static_cast<std::size_t>(t)];
+        }
+        ++lines;
+    }
+    std::printf("Logger: %d of %d messages written\n", lines, producers * messages);
+    for (int t = 0; t < producers; ++t) {
+        if (next[static_cast<std::size_t>(t)] != messages) {
+            std::printf("FAIL: thread %d: %d of %d messages\n", t, next[static_cast<std::size_t>(t)], messages);
+            ok = false;
+        }
+    }
+    if (errors != 0 || lines != producers * messages) {
+        ok = false;
+    }
+
+    log.close();
+    QDir(dir).removeRecursively();
+    std::printf(ok ? "PASS\n" : "FAIL\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+/*
+ * qt-logger-recovery-test - восстановление активного файла журнала после аварийного
+ * завершения (Logger::setBatchChecksum, LoggerFraming)
+ *
+ * Проверяет:
+ *  - файл, записанный с контрольными суммами, заканчивается трейлером последней
+ *    пачки, и validEnd() находит конец файла;
+ *  - после дописывания недописанной пачки (строки без трейлера, трейлер с неверной
+ *    суммой, обрезанный трейлер и мусор) повторная инициализация усекает файл до
+ *    конца последнего целого трейлера: данные до него не меняются, добавленные
+ *    данные удаляются, а в журнал записывается сообщение System о восстановлении с
+ *    количеством удалённых байт;
+ *  - файл без трейлеров (записанный без контрольных сумм) не изменяется.
+ */
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "logger.h"
+#include "loggerframing.h"
+
+using namespace DIRA_3D_GW;
+
+namespace {
+
+    int g_failures = 0;
+
+    void check(bool condition, const QString &what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", qPrintable(what));
+            ++g_failures;
+        }
+    }
+
+    QByteArray readFile(const QString &path) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QByteArray();
+        }
+        return file.readAll();
+    }
+
+    bool appendFile(const QString &path, const QByteArray &data) {
+        QFile file(path);
+        return file.open(QIODevice::WriteOnly | QIODevice::Append) && file.write(data) == data.size();
+    }
+
+    /**
+     * @brief Запись сообщений журнала с контрольными суммами пачек
+     * @remark Пауза после каждого сообщения разделяет сообщения по пачкам.
+     */
+    bool writeLog(const QString &dir, const QString &fileName, const char *prefix, int messages) {
+        Logger logger;
+        logger.setOpenMode(LoggerOpenMode::OpenSync);
+        logger.setBatchChecksum(true);
+        if (!logger.init(dir, fileName, LoggerLevel::Info)) {
+            return false;
+        }
+        for (int n = 0; n < messages; ++n) {
+            logger.info(QString("%1 message %2").arg(prefix).arg(n));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return true;
+    }
+
+    void testTornBatch(const QString &dir) {
+        const QString fileName("torn.log");
+        const QString path = dir + "/" + fileName;
+        check(writeLog(dir, fileName, "first", 5), "cannot write " + path);
+
+        const QByteArray clean = readFile(path);
+        check(!clean.isEmpty(), "empty log " + path);
+        check(LoggerFraming::validEnd(clean.constData(), clean.size(), 0) == clean.size(),
+              "the clean file does not end with a valid trailer");
+        int trailers = 0;
+        for (int pos = clean.indexOf(LoggerFraming::Magic); pos >= 0;
+             pos = clean.indexOf(LoggerFraming::Magic, pos + 1)) {
+            ++trailers;
+        }
+        check(trailers >= 5, QString("%1 trailers for 5 batches").arg(trailers));
+
+        // Недописанная пачка: строки без трейлера, трейлер правильного вида с
+        // неверной суммой, обрезанный трейлер и мусор без перевода строки
+        QByteArray torn("16.10.2026 12:00:00 [Info]: torn message 1\n"
+                        "16.10.2026 12:00:00 [Info]: torn message 2\n");
+        torn.append(LoggerFraming::Magic);
+        torn.append("00000054 deadbeef\n");
+        torn.append("16.10.2026 12:00:01 [Info]: torn message 3\n");
+        torn.append(LoggerFraming::Magic);
+        torn.append("0000");
+        torn.append("\x01\x02garbage\xff", 11);
+        check(appendFile(path, torn), "cannot append to " + path);
+
+        check(writeLog(dir, fileName, "second", 2), "cannot reopen " + path);
+
+        const QByteArray recovered = readFile(path);
+        check(recovered.startsWith(clean), "data before the last valid trailer is changed");
+        const QByteArray tail = recovered.mid(clean.size());
+        check(!tail.contains("torn message") && !tail.contains("garbage"),
+              "the torn batch is not removed");
+        const QString expected = QString("Log file recovered after an unclean shutdown: "
+                                         "%1 bytes of incomplete data removed").arg(torn.size());
+        check(tail.contains(expected.toLatin1().constData()), "no recovery message \"" + expected + "\"");
+        check(tail.contains("[System]"), "the recovery message is not a System message");
+        check(tail.contains("second message 0") && tail.contains("second message 1"),
+              "messages after recovery are not written");
+        check(LoggerFraming::validEnd(recovered.constData(), recovered.size(), 0) == recovered.size(),
+              "the recovered file does not end with a valid trailer");
+    }
+
+    void testNoTrailers(const QString &dir) {
+        const QString fileName("plain.log");
+        const QString path = dir + "/" + fileName;
+        // Файл, записанный без контрольных сумм, в том числе с недописанной строкой
+        const QByteArray plain("16.10.2026 12:00:00 [Info]: plain message 1\n"
+                               "16.10.2026 12:00:00 [Info]: plain message 2\n"
+                               "16.10.2026 12:00:01 [Info]: plain mess");
+        check(appendFile(path, plain), "cannot write " + path);
+
+        check(writeLog(dir, fileName, "checked", 1), "cannot reopen " + path);
+
+        const QByteArray after = readFile(path);
+        check(after.startsWith(plain), "the file without trailers is changed");
+        check(!after.contains("recovered after an unclean shutdown"),
+              "recovery is reported for the file without trailers");
+        check(after.contains("checked message 0"), "messages are not appended to the file without trailers");
+    }
+
+}
+
+int main() {
+    const QString dir = QDir::tempPath() + "/qt-logger-recovery-test";
+    QDir(dir).removeRecursively();
+    QDir(dir).mkpath(".");
+
+    testTornBatch(dir);
+    testNoTrailers(dir);
+
+    QDir(dir).removeRecursively();
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
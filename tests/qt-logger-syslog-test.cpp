@@ -0,0 +1,323 @@
+/*
+ * qt-logger-syslog-test - передача сообщений в syslog (LoggerSyslog)
+ *
+ * Вместо /dev/log тест создаёт собственный датаграммный Unix-сокет и проверяет:
+ *  - соответствие уровней severity syslog и разбор названий facility;
+ *  - заголовок RFC 5424 каждого сообщения: PRI, версию, время в UTC с
+ *    микросекундами, HOSTNAME, APP-NAME, PROCID и пустые MSGID и STRUCTURED-DATA;
+ *  - передачу пачки сообщений вызовами sendmmsg по LoggerSyslog::MaxBatch
+ *    сообщений (вызовы считаются подменой sendmmsg в исполняемом файле);
+ *  - учёт отброшенных сообщений, когда очередь сокета заполнена или сокет
+ *    отсутствует: переданные и отброшенные сообщения в сумме дают все сообщения, а
+ *    получено ровно столько, сколько передано.
+ */
+
+#include <QByteArray>
+#include <QDir>
+#include <QString>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "loggersyslog.h"
+
+using namespace DIRA_3D_GW;
+
+namespace {
+
+    std::atomic<int> g_sendCalls(0);        ///< Вызовов sendmmsg
+    std::atomic<int> g_maxBatch(0);         ///< Наибольшее количество сообщений в вызове
+
+    int g_failures = 0;
+
+    void check(bool condition, const char *what) {
+        if (!condition) {
+            std::printf("FAIL: %s\n", what);
+            ++g_failures;
+        }
+    }
+
+    /**
+     * @brief Датаграммный сокет, заменяющий /dev/log
+     */
+    class Receiver {
+    public:
+        explicit Receiver(const QString &path) : m_path(path.toLocal8Bit()) {
+            ::unlink(m_path.constData());
+            m_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+            sockaddr_un addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            std::strncpy(addr.sun_path, m_path.constData(), sizeof(addr.sun_path) - 1);
+            if (m_fd < 0 || bind(m_fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+                std::printf("FAIL: cannot bind %s\n", m_path.constData());
+                ++g_failures;
+            }
+            timeval tv = {0, 200000};
+            setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        }
+
+        ~Receiver() {
+            ::close(m_fd);
+            ::unlink(m_path.constData());
+        }
+
+        /**
+         * @brief Получение датаграммы
+         * @return false если датаграмм нет дольше 200 мс
+         */
+        bool receive(QByteArray &datagram) {
+            char buf[LoggerSyslog::MaxMessageSize + 1];
+            const ssize_t n = recv(m_fd, buf, sizeof(buf), 0);
+            if (n < 0) {
+                return false;
+            }
+            datagram = QByteArray(buf, static_cast<int>(n));
+            return true;
+        }
+
+        std::vector<QByteArray> receiveAll() {
+            std::vector<QByteArray> all;
+            QByteArray datagram;
+            while (receive(datagram)) {
+                all.push_back(datagram);
+            }
+            return all;
+        }
+
+    private:
+        QByteArray m_path;
+        int m_fd = -1;
+    };
+
+    /**
+     * @brief Разбор заголовка RFC 5424
+     * @return false если заголовок не соответствует формату
+     */
+    bool parseHeader(const QByteArray &datagram, int &pri, std::int64_t &secs,
+                     QByteArray &host, QByteArray &app, QByteArray &procId, QByteArray &msg) {
+        const QList<QByteArray> parts = datagram.split(' ');
+        if (parts.size() < 8 || !parts[0].startsWith('<') || parts[5] != "-" || parts[6] != "-") {
+            return false;
+        }
+        const int close = parts[0].indexOf('>');
+        bool ok = false;
+        pri = parts[0].mid(1, close - 1).toInt(&ok);
+        if (close < 0 || !ok || parts[0].mid(close + 1) != "1") {
+            return false;
+        }
+
+        // yyyy-MM-ddThh:mm:ss.uuuuuuZ
+        const QByteArray &ts = parts[1];
+        if (ts.size() != 27 || ts[4] != '-' || ts[7] != '-' || ts[10] != 'T' || ts[13] != ':'
+                || ts[16] != ':' || ts[19] != '.' || ts[26] != 'Z') {
+            return false;
+        }
+        for (int i : {0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18, 20, 21, 22, 23, 24, 25}) {
+            if (ts[i] < '0' || ts[i] > '9') {
+                return false;
+            }
+        }
+        tm t;
+        std::memset(&t, 0, sizeof(t));
+        t.tm_year = ts.mid(0, 4).toInt() - 1900;
+        t.tm_mon = ts.mid(5, 2).toInt() - 1;
+        t.tm_mday = ts.mid(8, 2).toInt();
+        t.tm_hour = ts.mid(11, 2).toInt();
+        t.tm_min = ts.mid(14, 2).toInt();
+        t.tm_sec = ts.mid(17, 2).toInt();
+        secs = static_cast<std::int64_t>(timegm(&t));
+
+        host = parts[2];
+        app = parts[3];
+        procId = parts[4];
+        const int headerSize = parts[0].size() + parts[1].size() + parts[2].size() + parts[3].size()
+                               + parts[4].size() + 9;
+        msg = datagram.mid(headerSize);
+        return true;
+    }
+
+    /**
+     * @brief Журнал, передающий сообщения только в syslog. Поток записи успевает
+     * заснуть, а окно накопления собирает следующие сообщения в одну пачку.
+     */
+    void startLogger(Logger &logger, const QString &path) {
+        logger.setSyslog(path, "syslog-test", LoggerSyslog::facilityFromString("local3"));
+        logger.setBatchWindow(std::chrono::milliseconds(50));
+        logger.init(QString(), QString(), LoggerLevel::Developer);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    void testSeverity() {
+        check(LoggerSyslog::severity(LoggerLevel::System) == 5, "System -> Notice (5)");
+        check(LoggerSyslog::severity(LoggerLevel::Critical) == 2, "Critical -> Critical (2)");
+        check(LoggerSyslog::severity(LoggerLevel::Error) == 3, "Error -> Error (3)");
+        check(LoggerSyslog::severity(LoggerLevel::Warning) == 4, "Warning -> Warning (4)");
+        check(LoggerSyslog::severity(LoggerLevel::Info) == 6, "Info -> Informational (6)");
+        check(LoggerSyslog::severity(LoggerLevel::Debug) == 7, "Debug -> Debug (7)");
+        check(LoggerSyslog::severity(LoggerLevel::Developer) == 7, "Developer -> Debug (7)");
+
+        check(LoggerSyslog::facilityFromString("user") == 1, "facility user");
+        check(LoggerSyslog::facilityFromString("Daemon") == 3, "facility daemon");
+        check(LoggerSyslog::facilityFromString("local0") == 16, "facility local0");
+        check(LoggerSyslog::facilityFromString("local7") == 23, "facility local7");
+        check(LoggerSyslog::facilityFromString("20") == 20, "facility number");
+        check(LoggerSyslog::facilityFromString("local8") == LoggerSyslog::FacilityUser, "facility local8");
+        check(LoggerSyslog::facilityFromString("24") == LoggerSyslog::FacilityUser, "facility 24");
+    }
+
+    void testFraming(const QString &path) {
+        Receiver receiver(path);
+        LoggerSyslogStats stats;
+        {
+            Logger logger;
+            startLogger(logger, path);
+            logger.system("framing system");
+            logger.critical("framing critical", "syslog.cpp", 1);
+            logger.error("framing error", "syslog.cpp", 2);
+            logger.warning("framing warning");
+            logger.info("framing info");
+            logger.debug("framing debug");
+            logger.dev("framing dev");
+            // Сообщение длиннее MaxMessageSize обрезается по границе символа UTF-8
+            logger.info(QString(LoggerSyslog::MaxMessageSize, QChar(0x0436)));
+            stats = logger.syslogStats();
+        }
+        const std::vector<QByteArray> datagrams = receiver.receiveAll();
+        check(datagrams.size() == 8, "framing: 8 datagrams received");
+
+        const char *texts[] = {"framing system", "framing critical", "framing error", "framing warning",
+                               "framing info", "framing debug", "framing dev"};
+        const int severities[] = {5, 2, 3, 4, 6, 7, 7};
+        const std::int64_t now = static_cast<std::int64_t>(std::time(nullptr));
+        char host[256] = {};
+        gethostname(host, sizeof(host) - 1);
+        for (std::size_t i = 0; i < datagrams.size() && i < 8; ++i) {
+            int pri = 0;
+            std::int64_t secs = 0;
+            QByteArray hostName, app, procId, msg;
+            if (!parseHeader(datagrams[i], pri, secs, hostName, app, procId, msg)) {
+                std::printf("FAIL: not an RFC 5424 message: %s\n", datagrams[i].left(120).constData());
+                ++g_failures;
+                continue;
+            }
+            check(std::llabs(secs - now) <= 60, "framing: timestamp is the current UTC time");
+            check(hostName == QByteArray(host), "framing: HOSTNAME");
+            check(app == "syslog-test", "framing: APP-NAME");
+            check(procId == QByteArray::number(static_cast<qint64>(getpid())), "framing: PROCID");
+            if (i < 7) {
+                check(pri == 19 * 8 + severities[i], "framing: PRI = facility * 8 + severity");
+                check(msg.contains(texts[i]), "framing: MSG contains the message text");
+            } else {
+                check(datagrams[i].size() <= LoggerSyslog::MaxMessageSize, "framing: long message truncated");
+                check((static_cast<unsigned char>(datagrams[i][datagrams[i].size() - 1]) & 0xC0) != 0xC0,
+                      "framing: truncated on a UTF-8 character boundary");
+            }
+        }
+        check(stats.dropped == 0, "framing: nothing dropped");
+    }
+
+    void testBatching(const QString &path) {
+        const int total = 640;
+        Receiver receiver(path);
+        std::vector<QByteArray> datagrams;
+        std::atomic<bool> stop(false);
+        std::thread reader([&]() {
+            QByteArray datagram;
+            for (;;) {
+                if (receiver.receive(datagram)) {
+                    datagrams.push_back(datagram);
+                } else if (stop.load()) {
+                    break;
+                }
+            }
+        });
+
+        {
+            Logger logger;
+            startLogger(logger, path);
+            g_sendCalls.store(0);
+            g_maxBatch.store(0);
+            for (int i = 0; i < total; ++i) {
+                logger.info(QString("batch %1").arg(i));
+            }
+        }
+        const int calls = g_sendCalls.load();
+        stop.store(true);
+        reader.join();
+
+        std::printf("batching: %d messages, %d sendmmsg calls, up to %d messages per call, %d received\n",
+                    total, calls, g_maxBatch.load(), static_cast<int>(datagrams.size()));
+        check(g_maxBatch.load() == LoggerSyslog::MaxBatch, "batching: full batches of MaxBatch messages");
+        check(calls <= total / 8, "batching: one sendmmsg call per batch, not per message");
+    }
+
+    void testDrops(const QString &path) {
+        const int total = 200;
+        Receiver receiver(path);
+        LoggerSyslogStats stats;
+        {
+            Logger logger;
+            startLogger(logger, path);
+            // Сокет не читается, поэтому его очередь заполняется
+            for (int i = 0; i < total; ++i) {
+                logger.info(QString("drop %1").arg(i));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            stats = logger.syslogStats();
+        }
+        const std::vector<QByteArray> datagrams = receiver.receiveAll();
+        std::printf("drops: %d messages, %llu sent, %llu dropped, %d received\n", total,
+                    static_cast<unsigned long long>(stats.sent), static_cast<unsigned long long>(stats.dropped),
+                    static_cast<int>(datagrams.size()));
+        check(stats.sent + stats.dropped == static_cast<std::uint64_t>(total), "drops: sent + dropped = all messages");
+        check(stats.dropped > 0, "drops: messages dropped when the socket queue is full");
+        check(datagrams.size() == stats.sent, "drops: every sent message received");
+
+        // Сокет отсутствует: все сообщения отбрасываются без ожидания
+        ::unlink(path.toLocal8Bit().constData());
+        {
+            Logger logger;
+            startLogger(logger, path + ".missing");
+            for (int i = 0; i < 10; ++i) {
+                logger.info(QString("missing %1").arg(i));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            stats = logger.syslogStats();
+        }
+        check(stats.sent == 0 && stats.dropped == 10, "drops: all messages dropped without a socket");
+    }
+
+}
+
+extern "C" int sendmmsg(int fd, struct mmsghdr *msgs, unsigned int vlen, int flags) {
+    g_sendCalls.fetch_add(1, std::memory_order_relaxed);
+    int max = g_maxBatch.load(std::memory_order_relaxed);
+    while (static_cast<int>(vlen) > max && !g_maxBatch.compare_exchange_weak(max, static_cast<int>(vlen))) {
+    }
+    return static_cast<int>(syscall(SYS_sendmmsg, fd, msgs, vlen, flags));
+}
+
+int main() {
+    const QString path = QDir::tempPath() + QString("/qt-logger-syslog-test-%1.sock").arg(getpid());
+
+    testSeverity();
+    testFraming(path);
+    testBatching(path);
+    testDrops(path);
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
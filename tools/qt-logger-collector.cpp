@@ -0,0 +1,159 @@
+/*
+ * qt-logger-collector - запись журнала приложения в отдельном процессе
+ *
+ * Читает строки журнала, которые приложение передаёт через кольцевой буфер в
+ * разделяемой памяти (Logger::setSharedMemorySink), и записывает их в файлы журнала с
+ * ротацией, индексом и синхронизацией, настроенными в секции файла конфигурации
+ * (те же параметры, что и у Logger::initFromConfig).
+ *     Строки, попавшие в буфер, сохраняются и при аварийном завершении приложения:
+ * сборщик дочитывает буфер и продолжает ждать новых строк (например от
+ * перезапущенного приложения). Сборщик, запущенный позже приложения, получает
+ * строки, накопленные в буфере до его запуска.
+ * Строка освобождается в буфере после записи в файл, поэтому при аварийном
+ * завершении сборщика незаписанные строки не теряются: перезапущенный сборщик
+ * читает их повторно (строки последней пачки могут повториться в файле).
+ *     Завершение работы - по SIGINT/SIGTERM после записи всех строк буфера.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSettings>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <deque>
+#include <thread>
+
+#include "logger.h"
+
+using namespace DIRA_3D_GW;
+
+namespace {
+
+    volatile std::sig_atomic_t g_stop = 0;
+
+    void on_signal(int) {
+        g_stop = 1;
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("qt-logger-collector");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Write log lines passed by an application through shared memory.");
+    parser.addHelpOption();
+    const QCommandLineOption configOption(QStringList() << "c" << "config",
+            "Configuration <file> with the log file settings.", "file");
+    const QCommandLineOption sectionOption(QStringList() << "s" << "section",
+            "Configuration <section> with the log file settings (default: Logger).", "section", "Logger");
+    const QCommandLineOption shmOption(QStringList() << "m" << "shm",
+            "Shared memory ring <name> (the SharedMemorySink of the application).", "name");
+    const QCommandLineOption sizeOption("size",
+            "Size of the ring if it is created by the collector (default: 4Mb).", "size");
+    const QCommandLineOption removeOption("remove",
+            "Remove the ring on exit if the application is not running.");
+    parser.addOption(configOption);
+    parser.addOption(sectionOption);
+    parser.addOption(shmOption);
+    parser.addOption(sizeOption);
+    parser.addOption(removeOption);
+    parser.process(app);
+
+    const QString config = parser.value(configOption);
+    const QString section = parser.value(sectionOption);
+    const QString name = parser.value(shmOption);
+    if (config.isEmpty() || name.isEmpty()) {
+        parser.showHelp(2);
+    }
+
+    // Секция сборщика описывает файлы журнала; передача строк в разделяемую память
+    // в ней привела бы к записи строк обратно в буфер
+    {
+        QSettings sett(config, QSettings::IniFormat);
+        sett.beginGroup(section);
+        if (!sett.value("SharedMemorySink", "").toString().isEmpty()) {
+            std::fprintf(stderr, "Section [%s] must not set SharedMemorySink\n", qPrintable(section));
+            return 2;
+        }
+    }
+
+    Logger logger;
+    if (!logger.initFromConfig(config, section)) {
+        std::fprintf(stderr, "Cannot initialize the log from [%s] of %s\n", qPrintable(section), qPrintable(config));
+        return 1;
+    }
+
+    std::int64_t size = LoggerShmRing::DefaultCapacity;
+    if (parser.isSet(sizeOption)) {
+        size = Logger::MaxLogFileSize_to_int(parser.value(sizeOption));
+    }
+    LoggerShmRing ring;
+    if (!ring.open(name, size, false)) {
+        return 1;
+    }
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    // Кадры освобождаются только после записи их строк потоком записи журнала:
+    // объём незаписанных строк ограничен буфером, при медленном диске приложение
+    // ждёт места в буфере, а при аварийном завершении сборщика строки остаются в нём
+    struct Mark {
+        std::uint64_t queued;       ///< Строк передано журналу к моменту отметки
+        std::uint64_t position;     ///< Позиция чтения буфера
+    };
+    std::deque<Mark> marks;
+    std::uint64_t queued = 0;
+    std::uint64_t marked = ring.position();
+
+    std::uint64_t dropped = ring.dropped();
+    for (;;) {
+        LoggerShmRing::Frame frame;
+        while (ring.peek(frame)) {
+            if (logger.writeFormatted(frame.level, frame.time, frame.data, frame.size)) {
+                ++queued;
+            }
+            ring.consume();
+        }
+        if (ring.position() != marked) {
+            marked = ring.position();
+            marks.push_back(Mark{queued, marked});
+        }
+        const std::uint64_t written = logger.formattedWritten();
+        while (!marks.empty() && marks.front().queued <= written) {
+            ring.release(marks.front().position);
+            marks.pop_front();
+        }
+        const std::uint64_t nowDropped = ring.dropped();
+        if (nowDropped != dropped) {
+            logger.system(QString("%1 log lines dropped by the application: shared memory ring is full")
+                          .arg(static_cast<qint64>(nowDropped - dropped)));
+            dropped = nowDropped;
+        }
+        // Завершение только после чтения всех строк, записанных до сигнала
+        if (g_stop) {
+            break;
+        }
+        // Пока есть незаписанные строки, буфер опрашивается чаще, чтобы освобождать
+        // место в нём вслед за потоком записи
+        ring.wait(std::chrono::milliseconds(marks.empty() ? 100 : 1));
+    }
+
+    // Перед отключением освобождаются кадры всех записанных строк
+    while (logger.formattedWritten() < queued) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ring.release(ring.position());
+
+    const bool remove = parser.isSet(removeOption) && !ring.producerAlive();
+    ring.close();
+    if (remove) {
+        LoggerShmRing::remove(name);
+    }
+    return 0;
+}
@@ -0,0 +1,582 @@
+/*
+ * qt-logger-query - поиск строк в файлах журнала qt-logger
+ *
+ * Просматривает файл журнала и его копии, созданные при ротации
+ * ("<имя>_ddMMyyyy_hhmmss_zzz.log"), и выводит записи, отобранные по уровню,
+ * интервалу времени, файлу исходного кода, подстроке и регулярному выражению.
+ *     Файлы отображаются в память и обрабатываются параллельно, поиск переводов строк
+ * и подстрок выполняется векторными инструкциями (SSE2). Если рядом с файлом
+ * журнала есть индекс (LoggerIndex), просмотр начинается с ближайшей к началу
+ * интервала времени записи индекса. Результаты выводятся в порядке времени записей.
+ *     Поддерживаются форматы Text, JsonLines и Logfmt.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#include <emmintrin.h>
+#define QUERY_SSE2
+#endif
+
+#include "loggertypes.h"
+#include "loggerformatter.h"
+#include "loggerindex.h"
+#include "loggercompress.h"
+#include "loggerframing.h"
+
+using namespace DIRA_3D_GW;
+
+namespace {
+
+    /**
+     * @brief Условия отбора записей
+     */
+    struct Query {
+        int maxLevel = LoggerLevel::Developer;  ///< Наименее важный выводимый уровень
+        bool hasFrom = false;
+        bool hasTo = false;
+        qint64 fromKey = 0;                     ///< Начало интервала (ключ местного времени)
+        qint64 toKey = 0;                       ///< Конец интервала (ключ местного времени)
+        qint64 fromEpochNs = 0;                 ///< Начало интервала, нс от начала эпохи (для индекса)
+        qint64 toEpochNs = 0;                   ///< Конец интервала, нс от начала эпохи (для индекса)
+        QByteArray source;                      ///< Подстрока имени файла исходного кода
+        QByteArray substring;                   ///< Подстрока записи
+        QString regex;                          ///< Регулярное выражение
+    };
+
+    /**
+     * @brief Найденная запись (указывает в отображённый в память файл)
+     */
+    struct Match {
+        qint64 key;             ///< Ключ местного времени записи
+        const char *begin;      ///< Начало записи
+        qint64 size;            ///< Размер записи, включая перевод строки
+    };
+
+    /**
+     * @brief Просматриваемый файл
+     */
+    struct ScanFile {
+        QString path;
+        std::unique_ptr<QFile> file;
+        const char *data = nullptr;
+        qint64 size = 0;
+        std::vector<Match> matches;
+    };
+
+    //! Наибольшая разница местного времени записи и времени от начала эпохи,
+    //! вычисленного для того же местного времени с другим смещением UTC (смещения
+    //! часовых поясов лежат в пределах -12..+14 ч)
+    const qint64 LocalTimeMarginNs = 26LL * 3600 * 1000000000;
+
+    //! Формат строки записи
+    enum LineFormat { NotHeader, TextLine, JsonLine, LogfmtLine };
+
+    // ------------------------------------------------------------------------
+    // Векторный поиск
+
+    const char *find_byte(const char *p, const char *end, char c) {
+#if defined(QUERY_SSE2)
+        const __m128i needle = _mm_set1_epi8(c);
+        while (end - p >= 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+            if (mask != 0) {
+                return p + __builtin_ctz(static_cast<unsigned>(mask));
+            }
+            p += 16;
+        }
+#endif
+        const void *r = std::memchr(p, c, static_cast<std::size_t>(end - p));
+        return r ? static_cast<const char *>(r) : end;
+    }
+
+    const char *find_substring(const char *p, const char *end, const char *needle, int n) {
+        if (n == 0) {
+            return p;
+        }
+        if (n == 1) {
+            return find_byte(p, end, needle[0]);
+        }
+#if defined(QUERY_SSE2)
+        // Кандидаты отбираются по совпадению первого и последнего символов в 16
+        // позициях сразу, остальные символы сравниваются только для кандидатов
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[n - 1]);
+        while (end - p >= n + 15) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + n - 1));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                        _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+            while (mask != 0) {
+                const int bit = __builtin_ctz(mask);
+                if (std::memcmp(p + bit + 1, needle + 1, static_cast<std::size_t>(n - 2)) == 0) {
+                    return p + bit;
+                }
+                mask &= mask - 1;
+            }
+            p += 16;
+        }
+#endif
+        const char *r = std::search(p, end, needle, needle + n);
+        return r;
+    }
+
+    /**
+     * @brief Поиск последнего вхождения символа (скобки места вызова в конце записи)
+     */
+    const char *rfind_byte(const char *begin, const char *end, char c) {
+        for (const char *p = end; p != begin; ) {
+            if (*--p == c) {
+                return p;
+            }
+        }
+        return nullptr;
+    }
+
+    // ------------------------------------------------------------------------
+    // Разбор заголовков записей
+
+    bool digits(const char *p, int n, int &value) {
+        value = 0;
+        for (int i = 0; i < n; ++i) {
+            if (p[i] < '0' || p[i] > '9') {
+                return false;
+            }
+            value = value * 10 + (p[i] - '0');
+        }
+        return true;
+    }
+
+    /**
+     * @brief Ключ местного времени: yyyyMMddhhmmsszzz в виде целого числа.
+     * Сравнение ключей соответствует сравнению времени записей без разбора часового пояса.
+     */
+    qint64 make_key(int y, int mo, int d, int h, int mi, int s, int ms) {
+        return ((((static_cast<qint64>(y) * 100 + mo) * 100 + d) * 100 + h) * 100 + mi) * 100000
+                + static_cast<qint64>(s) * 1000 + ms;
+    }
+
+    qint64 make_key(const QDateTime &dt) {
+        const QDate d = dt.date();
+        const QTime t = dt.time();
+        return make_key(d.year(), d.month(), d.day(), t.hour(), t.minute(), t.second(), t.msec());
+    }
+
+    int level_from_name(const char *p, const char *end) {
+        for (int l = LoggerLevel::System; l <= LoggerLevel::Developer; ++l) {
+            const char *name = LoggerFormatter::levelName(static_cast<LoggerLevel>(l));
+            const std::size_t len = std::strlen(name);
+            if (static_cast<std::size_t>(end - p) >= len && std::memcmp(p, name, len) == 0
+                    && (static_cast<std::size_t>(end - p) == len || p[len] == ']' || p[len] == '"'
+                        || p[len] == ' ' || p[len] == '\n')) {
+                return l;
+            }
+        }
+        return LoggerLevel::Developer;
+    }
+
+    /**
+     * @brief Разбор "yyyy-MM-ddThh:mm:ss.zzz"
+     */
+    bool parse_iso(const char *p, const char *end, qint64 &key) {
+        int y, mo, d, h, mi, s, ms;
+        if (end - p < 23 || p[4] != '-' || p[7] != '-' || p[10] != 'T' || p[13] != ':'
+                || p[16] != ':' || p[19] != '.') {
+            return false;
+        }
+        if (!digits(p, 4, y) || !digits(p + 5, 2, mo) || !digits(p + 8, 2, d) || !digits(p + 11, 2, h)
+                || !digits(p + 14, 2, mi) || !digits(p + 17, 2, s) || !digits(p + 20, 3, ms)) {
+            return false;
+        }
+        key = make_key(y, mo, d, h, mi, s, ms);
+        return true;
+    }
+
+    /**
+     * @brief Разбор начала строки записи
+     * @return Формат строки или NotHeader, если строка - продолжение многострочного
+     * сообщения
+     */
+    LineFormat parse_header(const char *p, const char *end, qint64 &key, int &level) {
+        // "dd.MM.yyyy hh:mm:ss [Level]..."
+        if (end - p >= 22 && p[2] == '.' && p[5] == '.' && p[10] == ' ' && p[13] == ':'
+                && p[16] == ':' && p[19] == ' ' && p[20] == '[') {
+            int d, mo, y, h, mi, s;
+            if (digits(p, 2, d) && digits(p + 3, 2, mo) && digits(p + 6, 4, y) && digits(p + 11, 2, h)
+                    && digits(p + 14, 2, mi) && digits(p + 17, 2, s)) {
+                key = make_key(y, mo, d, h, mi, s, 0);
+                level = level_from_name(p + 21, end);
+                return TextLine;
+            }
+        }
+        // {"time":"yyyy-MM-ddThh:mm:ss.zzz+hh:mm","level":"Level",...
+        static const char jsonTime[] = "{\"time\":\"";
+        if (end - p > 9 && std::memcmp(p, jsonTime, 9) == 0 && parse_iso(p + 9, end, key)) {
+            static const char jsonLevel[] = "\"level\":\"";
+            const char *l = find_substring(p + 32, end, jsonLevel, 9);
+            level = l != end ? level_from_name(l + 9, end) : LoggerLevel::Developer;
+            return JsonLine;
+        }
+        // time=yyyy-MM-ddThh:mm:ss.zzz+hh:mm level=Level ...
+        if (end - p > 5 && std::memcmp(p, "time=", 5) == 0 && parse_iso(p + 5, end, key)) {
+            const char *l = find_substring(p + 28, end, " level=", 7);
+            level = l != end ? level_from_name(l + 7, end) : LoggerLevel::Developer;
+            return LogfmtLine;
+        }
+        return NotHeader;
+    }
+
+    /**
+     * @brief Проверка имени файла исходного кода записи
+     */
+    bool source_matches(LineFormat format, const char *begin, const char *end, const QByteArray &source) {
+        const char *from = nullptr;
+        const char *to = nullptr;
+        if (format == TextLine) {
+            // Место вызова - группа "[file (line)]" в конце записи
+            while (end > begin && (end[-1] == '\n' || end[-1] == '\r')) {
+                --end;
+            }
+            if (end == begin || end[-1] != ']') {
+                return false;
+            }
+            const char *open = rfind_byte(begin + 21, end, '[');
+            if (!open) {
+                return false;
+            }
+            from = open + 1;
+            to = end;
+        } else {
+            const char *key = format == JsonLine ? "\"file\":\"" : " file=";
+            const int keyLen = format == JsonLine ? 8 : 6;
+            const char *f = find_substring(begin, end, key, keyLen);
+            if (f == end) {
+                return false;
+            }
+            from = f + keyLen;
+            to = find_byte(from, end, format == JsonLine ? '"' : ' ');
+        }
+        return find_substring(from, to, source.constData(), source.size()) != to;
+    }
+
+    // ------------------------------------------------------------------------
+    // Просмотр файла
+
+    void scan(ScanFile &sf, const Query &query) {
+        sf.file.reset(new QFile(sf.path));
+        if (!sf.file->open(QIODevice::ReadOnly) || sf.file->size() == 0) {
+            return;
+        }
+        sf.size = sf.file->size();
+        sf.data = reinterpret_cast<const char *>(sf.file->map(0, sf.size));
+        if (!sf.data) {
+            std::fprintf(stderr, "Cannot map %s\n", qPrintable(sf.path));
+            return;
+        }
+        // Сжатые файлы (Logger::setCompression) просматриваются после распаковки
+        if (LoggerCompressor::frameSize(sf.data, sf.size) > 0) {
+            std::fprintf(stderr, "%s is compressed, decompress it with zcat or zstdcat\n", qPrintable(sf.path));
+            return;
+        }
+
+        // Регулярное выражение у каждого потока своё
+        QRegularExpression re;
+        if (!query.regex.isEmpty()) {
+            re.setPattern(query.regex);
+        }
+
+        const char *p = sf.data;
+        const char *end = sf.data + sf.size;
+        std::vector<LoggerIndex::Entry> entries;
+        if ((query.hasFrom || query.hasTo) && LoggerIndex::read(LoggerIndex::pathFor(sf.path), entries)) {
+            if (query.hasFrom) {
+                const qint64 offset = LoggerIndex::seek(entries, query.fromEpochNs);
+                if (offset > 0 && offset < sf.size) {
+                    p += offset;
+                }
+            }
+            if (query.hasTo) {
+                // Ключи записей - местное время, которое может убывать (переход на
+                // зимнее время, перевод часов назад), поэтому просмотр завершается
+                // только там, где индекс показывает, что все дальнейшие записи позже
+                // конца интервала
+                std::size_t last = entries.size();
+                while (last > 0 && entries[last - 1].time > query.toEpochNs + LocalTimeMarginNs) {
+                    --last;
+                }
+                if (last < entries.size() && entries[last].offset < sf.size) {
+                    end = std::max(p, sf.data + entries[last].offset);
+                }
+            }
+        }
+
+        LineFormat format = NotHeader;
+        const char *recBegin = nullptr;
+        qint64 key = 0;
+        int level = 0;
+
+        auto finish = [&](const char *recEnd) {
+            if (format == NotHeader || level > query.maxLevel
+                    || (query.hasFrom && key < query.fromKey) || (query.hasTo && key > query.toKey)) {
+                return;
+            }
+            if (!query.source.isEmpty() && !source_matches(format, recBegin, recEnd, query.source)) {
+                return;
+            }
+            if (!query.substring.isEmpty()
+                    && find_substring(recBegin, recEnd, query.substring.constData(), query.substring.size()) == recEnd) {
+                return;
+            }
+            if (!query.regex.isEmpty()
+                    && !re.match(QString::fromUtf8(recBegin, static_cast<int>(recEnd - recBegin))).hasMatch()) {
+                return;
+            }
+            sf.matches.push_back(Match{key, recBegin, recEnd - recBegin});
+        };
+
+        while (p < end) {
+            const char *nl = find_byte(p, end, '\n');
+            const char *lineEnd = nl < end ? nl + 1 : end;
+
+            // Трейлер пачки (Logger::setBatchChecksum) завершает запись, но не выводится
+            if (*p == '#' && LoggerFraming::isTrailer(p, lineEnd - p)) {
+                finish(p);
+                format = NotHeader;
+                p = lineEnd;
+                continue;
+            }
+
+            qint64 lineKey;
+            int lineLevel;
+            const LineFormat lineFormat = parse_header(p, lineEnd, lineKey, lineLevel);
+            if (lineFormat != NotHeader) {
+                finish(p);
+                format = lineFormat;
+                recBegin = p;
+                key = lineKey;
+                level = lineLevel;
+            }
+            p = lineEnd;
+        }
+        finish(p);
+
+        // Записи файла упорядочиваются по времени для слияния: ключи местного
+        // времени не убывают только при неизменном смещении UTC
+        const auto byKey = [](const Match &a, const Match &b) { return a.key < b.key; };
+        if (!std::is_sorted(sf.matches.begin(), sf.matches.end(), byKey)) {
+            std::stable_sort(sf.matches.begin(), sf.matches.end(), byKey);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Параметры командной строки
+
+    bool parse_time(const QString &text, bool endOfRange, QDateTime &result) {
+        static const char *formats[] = {
+            "yyyy-MM-dd hh:mm:ss.zzz", "yyyy-MM-dd hh:mm:ss", "yyyy-MM-dd hh:mm",
+            "yyyy-MM-ddThh:mm:ss.zzz", "yyyy-MM-ddThh:mm:ss", "yyyy-MM-ddThh:mm",
+            "dd.MM.yyyy hh:mm:ss", "dd.MM.yyyy hh:mm", "yyyy-MM-dd", "dd.MM.yyyy",
+        };
+        for (const char *f : formats) {
+            QDateTime dt = QDateTime::fromString(text, f);
+            if (dt.isValid()) {
+                const QString fmt(f);
+                if (endOfRange) {
+                    // Конец интервала включает всю указанную минуту/секунду/день
+                    if (!fmt.contains("hh")) {
+                        dt = dt.addMSecs(24 * 3600 * 1000 - 1);
+                    } else if (!fmt.contains("ss")) {
+                        dt = dt.addMSecs(60 * 1000 - 1);
+                    } else if (!fmt.contains("zzz")) {
+                        dt = dt.addMSecs(999);
+                    }
+                }
+                result = dt;
+                return true;
+            }
+        }
+        // Только время - сегодняшний день
+        for (const char *f : { "hh:mm:ss", "hh:mm" }) {
+            const QTime t = QTime::fromString(text, f);
+            if (t.isValid()) {
+                QDateTime dt(QDate::currentDate(), t);
+                if (endOfRange) {
+                    dt = dt.addMSecs(QString(f).contains("ss") ? 999 : 60 * 1000 - 1);
+                }
+                result = dt;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parse_level(const QString &text, int &level) {
+        for (int l = LoggerLevel::System; l <= LoggerLevel::Developer; ++l) {
+            if (text.compare(LoggerFormatter::levelName(static_cast<LoggerLevel>(l)), Qt::CaseInsensitive) == 0) {
+                level = l;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Добавление файла журнала и его копий, созданных при ротации
+     */
+    void collect_files(const QString &path, QStringList &files) {
+        const QFileInfo info(path);
+        if (info.isDir()) {
+            for (const QFileInfo &f : QDir(path).entryInfoList(QStringList() << "*.log", QDir::Files)) {
+                files << f.absoluteFilePath();
+            }
+            return;
+        }
+        if (info.exists()) {
+            files << info.absoluteFilePath();
+        }
+        const QStringList nameFilter = QStringList() << QString("%1_*.log").arg(info.baseName());
+        for (const QFileInfo &f : QDir(info.absolutePath()).entryInfoList(nameFilter, QDir::Files)) {
+            files << f.absoluteFilePath();
+        }
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("qt-logger-query");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Search qt-logger log files and their rotated copies.");
+    parser.addHelpOption();
+    const QCommandLineOption levelOption(QStringList() << "l" << "level",
+            "Show records up to <level> (System, Critical, Error, Warning, Info, Debug, Developer).", "level");
+    const QCommandLineOption fromOption(QStringList() << "f" << "from",
+            "Show records at or after <time> (yyyy-MM-dd hh:mm[:ss], dd.MM.yyyy hh:mm[:ss] or hh:mm[:ss]).", "time");
+    const QCommandLineOption toOption(QStringList() << "t" << "to",
+            "Show records at or before <time>.", "time");
+    const QCommandLineOption sourceOption(QStringList() << "s" << "source",
+            "Show records logged from source files containing <file>.", "file");
+    const QCommandLineOption grepOption(QStringList() << "g" << "grep",
+            "Show records containing <text>.", "text");
+    const QCommandLineOption regexOption(QStringList() << "e" << "regex",
+            "Show records matching the regular expression <pattern>.", "pattern");
+    const QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+            "Scan files with <n> threads (default: number of cores).", "n");
+    parser.addOption(levelOption);
+    parser.addOption(fromOption);
+    parser.addOption(toOption);
+    parser.addOption(sourceOption);
+    parser.addOption(grepOption);
+    parser.addOption(regexOption);
+    parser.addOption(jobsOption);
+    parser.addPositionalArgument("paths", "Log files (rotated copies are included) or directories.", "<paths...>");
+    parser.process(app);
+
+    Query query;
+    if (parser.isSet(levelOption) && !parse_level(parser.value(levelOption), query.maxLevel)) {
+        std::fprintf(stderr, "Unknown level: %s\n", qPrintable(parser.value(levelOption)));
+        return 2;
+    }
+    if (parser.isSet(fromOption)) {
+        QDateTime from;
+        if (!parse_time(parser.value(fromOption), false, from)) {
+            std::fprintf(stderr, "Invalid time: %s\n", qPrintable(parser.value(fromOption)));
+            return 2;
+        }
+        query.hasFrom = true;
+        query.fromKey = make_key(from);
+        query.fromEpochNs = from.toMSecsSinceEpoch() * 1000000;
+    }
+    if (parser.isSet(toOption)) {
+        QDateTime to;
+        if (!parse_time(parser.value(toOption), true, to)) {
+            std::fprintf(stderr, "Invalid time: %s\n", qPrintable(parser.value(toOption)));
+            return 2;
+        }
+        query.hasTo = true;
+        query.toKey = make_key(to);
+        query.toEpochNs = to.toMSecsSinceEpoch() * 1000000 + 999999;
+    }
+    query.source = parser.value(sourceOption).toUtf8();
+    query.substring = parser.value(grepOption).toUtf8();
+    query.regex = parser.value(regexOption);
+    if (!query.regex.isEmpty() && !QRegularExpression(query.regex).isValid()) {
+        std::fprintf(stderr, "Invalid regular expression: %s\n", qPrintable(query.regex));
+        return 2;
+    }
+
+    QStringList paths;
+    for (const QString &arg : parser.positionalArguments()) {
+        collect_files(arg, paths);
+    }
+    paths.removeDuplicates();
+    if (paths.isEmpty()) {
+        parser.showHelp(2);
+    }
+
+    std::vector<ScanFile> files(static_cast<std::size_t>(paths.size()));
+    for (int i = 0; i < paths.size(); ++i) {
+        files[static_cast<std::size_t>(i)].path = paths[i];
+    }
+
+    // Файлы распределяются между потоками по одному
+    int jobs = parser.isSet(jobsOption) ? parser.value(jobsOption).toInt()
+                                        : static_cast<int>(std::thread::hardware_concurrency());
+    jobs = std::max(1, std::min(jobs, static_cast<int>(files.size())));
+    std::atomic<std::size_t> next(0);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < jobs; ++i) {
+        workers.emplace_back([&]() {
+            for (std::size_t n = next++; n < files.size(); n = next++) {
+                scan(files[n], query);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    // Слияние записей файлов в порядке времени; записи одного файла упорядочены в scan()
+    typedef std::pair<qint64, std::pair<std::size_t, std::size_t>> Head;  // ключ, (файл, запись)
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (!files[i].matches.empty()) {
+            heads.push(Head(files[i].matches[0].key, std::make_pair(i, std::size_t(0))));
+        }
+    }
+    std::size_t total = 0;
+    while (!heads.empty()) {
+        const Head head = heads.top();
+        heads.pop();
+        const std::size_t f = head.second.first;
+        const std::size_t m = head.second.second;
+        const Match &match = files[f].matches[m];
+        std::fwrite(match.begin, 1, static_cast<std::size_t>(match.size), stdout);
+        if (match.size > 0 && match.begin[match.size - 1] != '\n') {
+            std::fputc('\n', stdout);
+        }
+        ++total;
+        if (m + 1 < files[f].matches.size()) {
+            heads.push(Head(files[f].matches[m + 1].key, std::make_pair(f, m + 1)));
+        }
+    }
+    std::fflush(stdout);
+    return total > 0 ? 0 : 1;
+}